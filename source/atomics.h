@@ -0,0 +1,184 @@
+/*
+Copyright 2019 Tobii Pro AB
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef ATOMICS_H_
+#define ATOMICS_H_
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Minimal set of atomic operations used to share data between the gaze data callback thread and the
+ * application thread. Loads and stores of aligned machine words are atomic on all supported platforms,
+ * these helpers only add the required ordering. */
+
+#if defined(_WIN32) || defined(_WIN64)
+
+#include <intrin.h>
+
+#define ATOMICS_INLINE __inline
+
+#if defined(_M_ARM64)
+
+/* ARM64 reorders loads and stores in hardware, acquire and release need the ordered instructions and barriers. */
+
+static __inline size_t atomic_load_acquire(volatile size_t* value) {
+    return (size_t)__ldar64((volatile unsigned __int64*)value);
+}
+
+static __inline void atomic_store_release(volatile size_t* value, size_t new_value) {
+    __stlr64((volatile unsigned __int64*)value, (unsigned __int64)new_value);
+}
+
+static __inline void atomic_fence_acquire() {
+    __dmb(_ARM64_BARRIER_ISHLD);
+}
+
+static __inline void atomic_fence_release() {
+    __dmb(_ARM64_BARRIER_ISH);
+}
+
+#elif defined(_M_IX86) || defined(_M_X64)
+
+/* x86 and x64 keep loads in order with other loads and stores in order with other stores, only the compiler has to
+ * be kept from reordering them. */
+
+static __inline size_t atomic_load_acquire(volatile size_t* value) {
+    size_t result = *value;
+    _ReadWriteBarrier();
+    return result;
+}
+
+static __inline void atomic_store_release(volatile size_t* value, size_t new_value) {
+    _ReadWriteBarrier();
+    *value = new_value;
+}
+
+static __inline void atomic_fence_acquire() {
+    _ReadWriteBarrier();
+}
+
+static __inline void atomic_fence_release() {
+    _ReadWriteBarrier();
+}
+
+#else
+#error "atomics.h: unsupported Windows architecture"
+#endif
+
+/* Relaxed operations only guarantee that the value itself is not torn, e.g. for statistics counters. */
+static __inline size_t atomic_load_relaxed(volatile size_t* value) {
+    return *value;
+}
+
+static __inline void atomic_store_relaxed(volatile size_t* value, size_t new_value) {
+    *value = new_value;
+}
+
+static __inline void atomic_add_relaxed(volatile size_t* value, size_t amount) {
+#if defined(_WIN64)
+    _InterlockedExchangeAdd64((volatile __int64*)value, (__int64)amount);
+#else
+    _InterlockedExchangeAdd((volatile long*)value, (long)amount);
+#endif
+}
+
+/* Returns nonzero if value was expected and has been replaced by new_value. Full barrier. */
+static __inline int atomic_compare_exchange(volatile size_t* value, size_t expected, size_t new_value) {
+#if defined(_WIN64)
+    return (size_t)_InterlockedCompareExchange64((volatile __int64*)value, (__int64)new_value, (__int64)expected) ==
+        expected;
+#else
+    return (size_t)_InterlockedCompareExchange((volatile long*)value, (long)new_value, (long)expected) == expected;
+#endif
+}
+
+#else
+
+#define ATOMICS_INLINE inline
+
+static inline size_t atomic_load_acquire(volatile size_t* value) {
+    return __atomic_load_n(value, __ATOMIC_ACQUIRE);
+}
+
+static inline void atomic_store_release(volatile size_t* value, size_t new_value) {
+    __atomic_store_n(value, new_value, __ATOMIC_RELEASE);
+}
+
+static inline size_t atomic_load_relaxed(volatile size_t* value) {
+    return __atomic_load_n(value, __ATOMIC_RELAXED);
+}
+
+static inline void atomic_store_relaxed(volatile size_t* value, size_t new_value) {
+    __atomic_store_n(value, new_value, __ATOMIC_RELAXED);
+}
+
+static inline void atomic_add_relaxed(volatile size_t* value, size_t amount) {
+    __atomic_fetch_add(value, amount, __ATOMIC_RELAXED);
+}
+
+static inline void atomic_fence_acquire() {
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+}
+
+static inline void atomic_fence_release() {
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+static inline int atomic_compare_exchange(volatile size_t* value, size_t expected, size_t new_value) {
+    return __atomic_compare_exchange_n(value, &expected, new_value, 0, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+}
+
+#endif
+
+/* Sequence lock, for one thread to publish a small struct to readers on other threads without ever waiting for
+ * them. The sequence is odd while the struct is written, readers copy the struct and retry if the sequence was odd
+ * or changed meanwhile:
+ *
+ *     do {
+ *         sequence = seqlock_read_begin(&instance->sequence);
+ *         copy = instance->data;
+ *     } while (seqlock_read_retry(&instance->sequence, sequence));
+ */
+
+static ATOMICS_INLINE size_t seqlock_read_begin(volatile size_t* sequence) {
+    size_t value;
+    while ((value = atomic_load_acquire(sequence)) & 1) {
+    }
+    return value;
+}
+
+static ATOMICS_INLINE int seqlock_read_retry(volatile size_t* sequence, size_t value) {
+    atomic_fence_acquire();
+    return atomic_load_relaxed(sequence) != value;
+}
+
+static ATOMICS_INLINE void seqlock_write_begin(volatile size_t* sequence) {
+    atomic_store_relaxed(sequence, atomic_load_relaxed(sequence) + 1);
+    atomic_fence_release();
+}
+
+static ATOMICS_INLINE void seqlock_write_end(volatile size_t* sequence) {
+    atomic_store_release(sequence, atomic_load_relaxed(sequence) + 1);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* ATOMICS_H_ */
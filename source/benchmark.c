@@ -0,0 +1,610 @@
+/*
+Copyright 2019 Tobii Pro AB
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+/* Benchmarks of the addons, run with "make bench". The validator is driven through its public API with
+ * synthetic gaze data from a stand-in for the eye tracker, so no hardware or Tobii Pro SDK library is needed.
+ *
+ * Results are printed as one table with a header line and whitespace separated columns, "-" where a column
+ * does not apply:
+ *   benchmark     Name of the benchmark.
+ *   variant       What is measured or how the validator is configured.
+ *   sample_count  Sample count of the validator.
+ *   points        Number of collected points.
+ *   rate_hz       Gaze data rate.
+ *   ns_per_op     Average time per operation in nanoseconds.
+ *   allocations   Allocations per operation.
+ *   peak_bytes    Peak heap use of the validator, including the operation. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(_WIN32) || defined(_WIN64)
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+#include "point_index.h"
+#include "screen_based_calibration_validation.h"
+#include "tobii_research_eyetracker.h"
+#include "vectormath.h"
+
+/* Repeat each measurement until it has run for at least this long. */
+#define MEASURE_TIME_MIN_NS (200000000LL)
+
+#define FRAME_RATE (60)
+#define CALLBACK_SAMPLE_COUNT (30)
+#define CALLBACK_TIMEOUT (1000)
+#define SAMPLE_COUNT_MAX (3000)
+/* Threads of the parallel compute variants. */
+#define COMPUTE_THREADS (4)
+
+/* Heap use of the addon objects, counted by the malloc wrappers below. */
+static size_t allocations_count;
+static size_t allocated_bytes;
+static size_t allocated_bytes_peak;
+
+#if defined(BENCHMARK_COUNT_ALLOCATIONS)
+
+#include <pthread.h>
+
+/* The addon objects are linked with --wrap, so that their calls to these functions end up here. Each block
+ * is prefixed with its size. The counters are shared with the compute worker threads. */
+#define ALLOCATION_HEADER_SIZE (16)
+
+static pthread_mutex_t allocation_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+extern void* __real_malloc(size_t size);
+extern void* __real_realloc(void* pointer, size_t size);
+extern void __real_free(void* pointer);
+
+void* __wrap_malloc(size_t size) {
+    char* block = __real_malloc(size + ALLOCATION_HEADER_SIZE);
+    *(size_t*)block = size;
+    pthread_mutex_lock(&allocation_mutex);
+    allocations_count++;
+    allocated_bytes += size;
+    if (allocated_bytes > allocated_bytes_peak) {
+        allocated_bytes_peak = allocated_bytes;
+    }
+    pthread_mutex_unlock(&allocation_mutex);
+    return block + ALLOCATION_HEADER_SIZE;
+}
+
+void __wrap_free(void* pointer) {
+    if (pointer) {
+        char* block = (char*)pointer - ALLOCATION_HEADER_SIZE;
+        pthread_mutex_lock(&allocation_mutex);
+        allocated_bytes -= *(size_t*)block;
+        pthread_mutex_unlock(&allocation_mutex);
+        __real_free(block);
+    }
+}
+
+void* __wrap_realloc(void* pointer, size_t size) {
+    if (!pointer) {
+        return __wrap_malloc(size);
+    }
+    char* block = (char*)pointer - ALLOCATION_HEADER_SIZE;
+    size_t old_size = *(size_t*)block;
+    block = __real_realloc(block, size + ALLOCATION_HEADER_SIZE);
+    *(size_t*)block = size;
+    pthread_mutex_lock(&allocation_mutex);
+    allocated_bytes -= old_size;
+    allocations_count++;
+    allocated_bytes += size;
+    if (allocated_bytes > allocated_bytes_peak) {
+        allocated_bytes_peak = allocated_bytes;
+    }
+    pthread_mutex_unlock(&allocation_mutex);
+    return block + ALLOCATION_HEADER_SIZE;
+}
+
+#endif
+
+static void reset_allocation_peak(void) {
+    allocated_bytes_peak = allocated_bytes;
+}
+
+static long long now_ns(void) {
+#if defined(_WIN32) || defined(_WIN64)
+    LARGE_INTEGER frequency;
+    LARGE_INTEGER counter;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+    return (long long)(counter.QuadPart * (1e9 / frequency.QuadPart));
+#else
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return time.tv_sec * 1000000000LL + time.tv_nsec;
+#endif
+}
+
+static void print_header(void) {
+    printf("%-12s %-14s %12s %8s %8s %14s %12s %12s\n", "benchmark", "variant", "sample_count", "points", "rate_hz",
+        "ns_per_op", "allocations", "peak_bytes");
+}
+
+static void print_row(const char* benchmark, const char* variant, size_t sample_count, size_t points, int rate,
+    double ns_per_op, double allocations, size_t peak_bytes) {
+    char sample_count_text[32] = "-";
+    char points_text[32] = "-";
+    char rate_text[32] = "-";
+    char allocations_text[32] = "-";
+    char peak_bytes_text[32] = "-";
+    if (sample_count) {
+        snprintf(sample_count_text, sizeof(sample_count_text), "%zu", sample_count);
+    }
+    if (points) {
+        snprintf(points_text, sizeof(points_text), "%zu", points);
+    }
+    if (rate) {
+        snprintf(rate_text, sizeof(rate_text), "%d", rate);
+    }
+#if defined(BENCHMARK_COUNT_ALLOCATIONS)
+    if (allocations >= 0.0) {
+        snprintf(allocations_text, sizeof(allocations_text), "%.2f", allocations);
+    }
+    if (peak_bytes) {
+        snprintf(peak_bytes_text, sizeof(peak_bytes_text), "%zu", peak_bytes);
+    }
+#endif
+    printf("%-12s %-14s %12s %8s %8s %14.1f %12s %12s\n", benchmark, variant, sample_count_text, points_text,
+        rate_text, ns_per_op, allocations_text, peak_bytes_text);
+    fflush(stdout);
+}
+
+/* Stand-in for the Tobii Pro SDK. Gaze data is delivered by calling the subscribed callback directly. */
+
+static int eyetracker;
+static tobii_research_gaze_data_callback subscribed_callback;
+static void* subscribed_user_data;
+static int64_t current_time_stamp;
+
+TobiiResearchStatus tobii_research_get_eyetracker(const char* address, TobiiResearchEyeTracker** instance) {
+    (void)address;
+    *instance = (TobiiResearchEyeTracker*)&eyetracker;
+    return TOBII_RESEARCH_STATUS_OK;
+}
+
+TobiiResearchStatus tobii_research_subscribe_to_gaze_data(TobiiResearchEyeTracker* instance,
+    tobii_research_gaze_data_callback callback, void* user_data) {
+    (void)instance;
+    subscribed_callback = callback;
+    subscribed_user_data = user_data;
+    return TOBII_RESEARCH_STATUS_OK;
+}
+
+TobiiResearchStatus tobii_research_unsubscribe_from_gaze_data(TobiiResearchEyeTracker* instance,
+    tobii_research_gaze_data_callback callback) {
+    (void)instance;
+    (void)callback;
+    subscribed_callback = NULL;
+    return TOBII_RESEARCH_STATUS_OK;
+}
+
+TobiiResearchStatus tobii_research_get_display_area(TobiiResearchEyeTracker* instance,
+    TobiiResearchDisplayArea* display_area) {
+    (void)instance;
+    /* A 24" 16:9 display in front of the eye tracker. */
+    display_area->width = 531.0f;
+    display_area->height = 299.0f;
+    display_area->top_left.x = -265.5f;
+    display_area->top_left.y = 319.0f;
+    display_area->top_left.z = 20.0f;
+    display_area->top_right = display_area->top_left;
+    display_area->top_right.x = 265.5f;
+    display_area->bottom_left = display_area->top_left;
+    display_area->bottom_left.y = 20.0f;
+    display_area->bottom_right = display_area->bottom_left;
+    display_area->bottom_right.x = 265.5f;
+    return TOBII_RESEARCH_STATUS_OK;
+}
+
+TobiiResearchStatus tobii_research_subscribe_to_display_area(TobiiResearchEyeTracker* instance,
+    tobii_research_display_area_callback callback, void* user_data) {
+    (void)instance;
+    (void)callback;
+    (void)user_data;
+    return TOBII_RESEARCH_STATUS_OK;
+}
+
+TobiiResearchStatus tobii_research_unsubscribe_from_display_area(TobiiResearchEyeTracker* instance,
+    tobii_research_display_area_callback callback) {
+    (void)instance;
+    (void)callback;
+    return TOBII_RESEARCH_STATUS_OK;
+}
+
+TobiiResearchStatus tobii_research_get_system_time_stamp(int64_t* time_stamp) {
+    *time_stamp = current_time_stamp;
+    return TOBII_RESEARCH_STATUS_OK;
+}
+
+/* Synthetic gaze data: fixations on the stimuli point with some noise, every 20th sample invalid. */
+
+static unsigned int random_state = 1;
+
+static float random_noise(void) {
+    random_state = random_state * 1103515245u + 12345u;
+    return ((random_state >> 8) & 0xffff) / 65535.0f - 0.5f;
+}
+
+static void create_gaze_data(TobiiResearchGazeData* gaze_data, const TobiiResearchNormalizedPoint2D* screen_point,
+    int rate, size_t index) {
+    static const float eye_offset = 32.0f;
+    memset(gaze_data, 0, sizeof(*gaze_data));
+    float x = -265.5f + 531.0f * screen_point->x;
+    float y = 319.0f - 299.0f * screen_point->y;
+
+    TobiiResearchEyeData* eyes[] = { &gaze_data->left_eye, &gaze_data->right_eye };
+    for (size_t i = 0; i < 2; ++i) {
+        TobiiResearchPoint3D* origin = &eyes[i]->gaze_origin.position_in_user_coordinates;
+        TobiiResearchPoint3D* point = &eyes[i]->gaze_point.position_in_user_coordinates;
+        origin->x = (i ? eye_offset : -eye_offset) + random_noise();
+        origin->y = 180.0f + random_noise();
+        origin->z = 620.0f + random_noise();
+        point->x = x + 5.0f * random_noise();
+        point->y = y + 5.0f * random_noise();
+        point->z = 20.0f;
+        eyes[i]->gaze_origin.validity = TOBII_RESEARCH_VALIDITY_VALID;
+        eyes[i]->gaze_point.validity = index % 20 ? TOBII_RESEARCH_VALIDITY_VALID : TOBII_RESEARCH_VALIDITY_INVALID;
+        eyes[i]->gaze_point.position_on_display_area.x = screen_point->x;
+        eyes[i]->gaze_point.position_on_display_area.y = screen_point->y;
+    }
+    current_time_stamp += 1000000 / rate;
+    gaze_data->device_time_stamp = current_time_stamp;
+    gaze_data->system_time_stamp = current_time_stamp;
+}
+
+static void create_screen_point(TobiiResearchNormalizedPoint2D* screen_point, size_t index, size_t count) {
+    size_t side = 1;
+    while (side * side < count) {
+        side++;
+    }
+    screen_point->x = (index % side + 0.5f) / side;
+    screen_point->y = (index / side + 0.5f) / side;
+}
+
+/* Collects count points of a grid of grid_count points, starting at the first one, at 600 Hz. */
+static void collect_points(CalibrationValidator* validator, size_t first, size_t count, size_t grid_count) {
+    static size_t index = 0;
+    for (size_t i = first; i < first + count; ++i) {
+        TobiiResearchNormalizedPoint2D screen_point;
+        create_screen_point(&screen_point, i, grid_count);
+        tobii_research_screen_based_calibration_validation_start_collecting_data(validator, &screen_point);
+        do {
+            TobiiResearchGazeData gaze_data;
+            create_gaze_data(&gaze_data, &screen_point, 600, index++);
+            subscribed_callback(&gaze_data, subscribed_user_data);
+        } while (tobii_research_screen_based_calibration_validation_is_collecting_data(validator));
+    }
+}
+
+/* Gaze data callback throughput. A nine point validation with half a second between the points, where the
+ * application checks is_collecting_data once per frame. Reports the time per gaze data callback and the time
+ * spent processing the queued samples per sample. */
+static void benchmark_callback(int rate) {
+    static const size_t points_count = 9;
+    size_t samples_per_frame = rate / FRAME_RATE;
+
+    CalibrationValidator* validator;
+    tobii_research_screen_based_calibration_validation_init("bench", CALLBACK_SAMPLE_COUNT, CALLBACK_TIMEOUT,
+        &validator);
+    tobii_research_screen_based_calibration_validation_enter_validation_mode(validator);
+    reset_allocation_peak();
+
+    long long callback_time = 0;
+    long long process_time = 0;
+    size_t callbacks_count = 0;
+    size_t callback_allocations = 0;
+    size_t process_allocations = 0;
+    long long start_time = now_ns();
+    while (now_ns() - start_time < MEASURE_TIME_MIN_NS) {
+        for (size_t i = 0; i < points_count; ++i) {
+            TobiiResearchNormalizedPoint2D screen_point;
+            create_screen_point(&screen_point, i, points_count);
+            tobii_research_screen_based_calibration_validation_start_collecting_data(validator, &screen_point);
+
+            size_t idle_frames = FRAME_RATE / 2;
+            int collecting = 1;
+            while (collecting || idle_frames-- > 0) {
+                for (size_t k = 0; k < samples_per_frame; ++k) {
+                    TobiiResearchGazeData gaze_data;
+                    create_gaze_data(&gaze_data, &screen_point, rate, callbacks_count);
+                    size_t allocations_before = allocations_count;
+                    long long time = now_ns();
+                    subscribed_callback(&gaze_data, subscribed_user_data);
+                    callback_time += now_ns() - time;
+                    callback_allocations += allocations_count - allocations_before;
+                    callbacks_count++;
+                }
+                size_t allocations_before = allocations_count;
+                long long time = now_ns();
+                collecting = tobii_research_screen_based_calibration_validation_is_collecting_data(validator);
+                process_time += now_ns() - time;
+                process_allocations += allocations_count - allocations_before;
+            }
+        }
+        tobii_research_screen_based_calibration_validation_clear_collected_data(validator);
+    }
+
+    print_row("callback", "callback", CALLBACK_SAMPLE_COUNT, points_count, rate,
+        (double)callback_time / callbacks_count, (double)callback_allocations / callbacks_count, allocated_bytes_peak);
+    print_row("callback", "process", CALLBACK_SAMPLE_COUNT, points_count, rate,
+        (double)process_time / callbacks_count, (double)process_allocations / callbacks_count, allocated_bytes_peak);
+
+    tobii_research_screen_based_calibration_validation_leave_validation_mode(validator);
+    tobii_research_screen_based_calibration_validation_destroy(validator);
+}
+
+/* Compute latency for points_count points with sample_count samples each, on compute_threads threads. Only the
+ * ATAN2 and FAST angle kernels compute the angles of the samples vectorized. */
+static void benchmark_compute(size_t sample_count, size_t points_count, int online_statistics, int robust_statistics,
+    CalibrationValidationAngleKernel angle_kernel, int compute_threads) {
+    CalibrationValidator* validator;
+    tobii_research_screen_based_calibration_validation_init("bench", sample_count, CALLBACK_TIMEOUT, &validator);
+    tobii_research_screen_based_calibration_validation_set_option(validator,
+        CALIBRATION_VALIDATION_OPTION_ONLINE_STATISTICS, online_statistics);
+    tobii_research_screen_based_calibration_validation_set_option(validator,
+        CALIBRATION_VALIDATION_OPTION_ROBUST_STATISTICS, robust_statistics);
+    tobii_research_screen_based_calibration_validation_set_option(validator,
+        CALIBRATION_VALIDATION_OPTION_ANGLE_KERNEL, angle_kernel);
+    tobii_research_screen_based_calibration_validation_set_option(validator,
+        CALIBRATION_VALIDATION_OPTION_COMPUTE_THREADS, compute_threads);
+    tobii_research_screen_based_calibration_validation_enter_validation_mode(validator);
+    reset_allocation_peak();
+
+    /* The validator keeps the computed points until they change, so every point is collected again before
+     * each compute to measure computing all of them. */
+    long long compute_time = 0;
+    size_t computes_count = 0;
+    size_t compute_allocations = 0;
+    while (compute_time < MEASURE_TIME_MIN_NS / 2 || computes_count < 3) {
+        collect_points(validator, 0, points_count, points_count);
+        CalibrationValidationResult* result;
+        size_t allocations_before = allocations_count;
+        long long time = now_ns();
+        tobii_research_screen_based_calibration_validation_compute(validator, &result);
+        tobii_research_screen_based_calibration_validation_destroy_result(result);
+        compute_time += now_ns() - time;
+        compute_allocations += allocations_count - allocations_before;
+        computes_count++;
+        tobii_research_screen_based_calibration_validation_clear_collected_data(validator);
+    }
+
+    static const char* const kernel_suffixes[] = { "", "_normalized", "_atan2", "_fast" };
+    char variant[32];
+    snprintf(variant, sizeof(variant), compute_threads > 1 ? "%s%s_%dt" : "%s%s",
+        online_statistics ? "online" : robust_statistics ? "robust" : "batch", kernel_suffixes[angle_kernel],
+        compute_threads);
+    print_row("compute", variant, sample_count, points_count, 0,
+        (double)compute_time / computes_count, (double)compute_allocations / computes_count, allocated_bytes_peak);
+
+    tobii_research_screen_based_calibration_validation_leave_validation_mode(validator);
+    tobii_research_screen_based_calibration_validation_destroy(validator);
+}
+
+/* A session showing live feedback, computing after each of points_count points is collected. Per point, which
+ * stays constant as long as only the changed points are computed. */
+static void benchmark_session(size_t sample_count, size_t points_count) {
+    CalibrationValidator* validator;
+    tobii_research_screen_based_calibration_validation_init("bench", sample_count, CALLBACK_TIMEOUT, &validator);
+    tobii_research_screen_based_calibration_validation_enter_validation_mode(validator);
+    reset_allocation_peak();
+
+    long long compute_time = 0;
+    size_t computes_count = 0;
+    while (compute_time < MEASURE_TIME_MIN_NS / 2 || computes_count < points_count) {
+        for (size_t i = 0; i < points_count; ++i) {
+            collect_points(validator, i, 1, points_count);
+            CalibrationValidationResult* result;
+            long long time = now_ns();
+            tobii_research_screen_based_calibration_validation_compute(validator, &result);
+            tobii_research_screen_based_calibration_validation_destroy_result(result);
+            compute_time += now_ns() - time;
+            computes_count++;
+        }
+        tobii_research_screen_based_calibration_validation_clear_collected_data(validator);
+    }
+
+    print_row("session", "batch", sample_count, points_count, 0,
+        (double)compute_time / computes_count, -1.0, allocated_bytes_peak);
+
+    tobii_research_screen_based_calibration_validation_leave_validation_mode(validator);
+    tobii_research_screen_based_calibration_validation_destroy(validator);
+}
+
+static int discard_export(const void* data, size_t size, void* user_data) {
+    (void)data;
+    *(size_t*)user_data += size;
+    return 0;
+}
+
+/* Exporting points_count points with their samples to a sink that discards it. The peak bytes stay those of the
+ * collected data, as the export only adds its fixed buffer. */
+static void benchmark_export(size_t sample_count, size_t points_count, CalibrationValidationExportFormat format) {
+    CalibrationValidator* validator;
+    tobii_research_screen_based_calibration_validation_init("bench", sample_count, CALLBACK_TIMEOUT, &validator);
+    tobii_research_screen_based_calibration_validation_enter_validation_mode(validator);
+    collect_points(validator, 0, points_count, points_count);
+    size_t exported_bytes = 0;
+    tobii_research_screen_based_calibration_validation_export(validator, format, 1, discard_export, &exported_bytes);
+    reset_allocation_peak();
+
+    long long export_time = 0;
+    size_t exports_count = 0;
+    size_t export_allocations = 0;
+    while (export_time < MEASURE_TIME_MIN_NS / 2 || exports_count < 3) {
+        size_t allocations_before = allocations_count;
+        long long time = now_ns();
+        tobii_research_screen_based_calibration_validation_export(validator, format, 1, discard_export,
+            &exported_bytes);
+        export_time += now_ns() - time;
+        export_allocations += allocations_count - allocations_before;
+        exports_count++;
+    }
+
+    print_row("export", format == CALIBRATION_VALIDATION_EXPORT_FORMAT_BINARY ? "binary" : "json", sample_count,
+        points_count, 0, (double)export_time / exports_count, (double)export_allocations / exports_count,
+        allocated_bytes_peak);
+
+    tobii_research_screen_based_calibration_validation_leave_validation_mode(validator);
+    tobii_research_screen_based_calibration_validation_destroy(validator);
+}
+
+/* Angle kernel throughput on the gaze directions of a 3000 sample point, the batch as used for precision. */
+static void benchmark_angle(Vector3AngleKernel kernel, const char* variant) {
+    static const size_t count = SAMPLE_COUNT_MAX;
+    float* data = malloc(7 * count * sizeof(*data));
+    Point3Arrays first;
+    Point3Arrays second;
+    point3_arrays_init(&first, data, count);
+    point3_arrays_init(&second, data + 3 * count, count);
+    float* angles = data + 6 * count;
+
+    TobiiResearchNormalizedPoint2D screen_point = { 0.5f, 0.5f };
+    for (size_t i = 0; i < count; ++i) {
+        TobiiResearchGazeData gaze_data;
+        create_gaze_data(&gaze_data, &screen_point, 600, i + 1);
+        TobiiResearchVector3D direction;
+        vector3_create_from_points(&direction, &gaze_data.left_eye.gaze_origin.position_in_user_coordinates,
+            &gaze_data.left_eye.gaze_point.position_in_user_coordinates);
+        vector3_normalize(&direction);
+        point3_arrays_set(&first, i, &direction);
+        vector3_create_from_points(&direction, &gaze_data.right_eye.gaze_origin.position_in_user_coordinates,
+            &gaze_data.right_eye.gaze_point.position_in_user_coordinates);
+        vector3_normalize(&direction);
+        point3_arrays_set(&second, i, &direction);
+    }
+
+    size_t batches = 0;
+    long long start_time = now_ns();
+    while (now_ns() - start_time < MEASURE_TIME_MIN_NS) {
+        vector3_angle_batch_with(kernel, angles, &first, &second, count);
+        batches++;
+    }
+    double ns_per_op = (double)(now_ns() - start_time) / (batches * count);
+
+    print_row("angle", variant, count, 0, 0, ns_per_op, -1.0, 0);
+
+    free(data);
+}
+
+/* The linear scan and shifting removal that the point index replaced, as reference. */
+static size_t point_list_find(const TobiiResearchNormalizedPoint2D* points, size_t count,
+    const TobiiResearchNormalizedPoint2D* point) {
+    for (size_t i = 0; i < count; ++i) {
+        if (point2_equal(point, &points[i])) {
+            return i;
+        }
+    }
+    return POINT_INDEX_NOT_FOUND;
+}
+
+/* Collect every point of a grid, collect every point again, then discard them in collection order. Three
+ * lookups and one insert or removal per point. */
+static void benchmark_point_index(size_t points_count, int indexed) {
+    TobiiResearchNormalizedPoint2D* grid = malloc(points_count * sizeof(*grid));
+    TobiiResearchNormalizedPoint2D* list = malloc(points_count * sizeof(*list));
+    for (size_t i = 0; i < points_count; ++i) {
+        create_screen_point(&grid[i], i, points_count);
+    }
+    PointIndex* index = point_index_init(points_count);
+
+    size_t sessions = 0;
+    long long start_time = now_ns();
+    while (now_ns() - start_time < MEASURE_TIME_MIN_NS) {
+        size_t count = 0;
+        for (int pass = 0; pass < 2; ++pass) {
+            for (size_t i = 0; i < points_count; ++i) {
+                if (indexed) {
+                    if (point_index_find(index, &grid[i]) == POINT_INDEX_NOT_FOUND) {
+                        point_index_insert(index, &grid[i], count++);
+                    }
+                } else if (point_list_find(list, count, &grid[i]) == POINT_INDEX_NOT_FOUND) {
+                    list[count++] = grid[i];
+                }
+            }
+        }
+        for (size_t i = 0; i < points_count; ++i) {
+            if (indexed) {
+                point_index_remove(index, &grid[i]);
+            } else {
+                size_t idx = point_list_find(list, count, &grid[i]);
+                for (size_t k = idx + 1; k < count; ++k) {
+                    list[k - 1] = list[k];
+                }
+                count--;
+            }
+        }
+        sessions++;
+    }
+    double ns_per_op = (double)(now_ns() - start_time) / (sessions * 3.0 * points_count);
+
+    print_row("point_index", indexed ? "indexed" : "linear", 0, points_count, 0, ns_per_op, -1.0, 0);
+
+    point_index_destroy(index);
+    free(list);
+    free(grid);
+}
+
+int main(int argc, char *argv[]) {
+    static const int rates[] = { 60, 300, 600, 1200 };
+    static const size_t sample_counts[] = { 10, 30, 300, 3000 };
+    static const size_t points_counts[] = { 1, 10, 100, 1000 };
+    static const size_t grid_points_counts[] = { 25, 100, 400, 1600 };
+    (void)argc;
+    (void)argv;
+
+    print_header();
+    for (size_t i = 0; i < sizeof(rates) / sizeof(rates[0]); ++i) {
+        benchmark_callback(rates[i]);
+    }
+    for (size_t i = 0; i < sizeof(sample_counts) / sizeof(sample_counts[0]); ++i) {
+        for (size_t k = 0; k < sizeof(points_counts) / sizeof(points_counts[0]); ++k) {
+            size_t sample_count = sample_counts[i];
+            size_t points_count = points_counts[k];
+            benchmark_compute(sample_count, points_count, 0, 0, CALIBRATION_VALIDATION_ANGLE_KERNEL_REFERENCE, 1);
+            benchmark_compute(sample_count, points_count, 0, 0, CALIBRATION_VALIDATION_ANGLE_KERNEL_ATAN2, 1);
+            benchmark_compute(sample_count, points_count, 0, 0, CALIBRATION_VALIDATION_ANGLE_KERNEL_FAST, 1);
+            benchmark_compute(sample_count, points_count, 1, 0, CALIBRATION_VALIDATION_ANGLE_KERNEL_REFERENCE, 1);
+            benchmark_compute(sample_count, points_count, 0, 1, CALIBRATION_VALIDATION_ANGLE_KERNEL_REFERENCE, 1);
+            benchmark_compute(sample_count, points_count, 0, 1, CALIBRATION_VALIDATION_ANGLE_KERNEL_ATAN2, 1);
+            if (points_count > 1) {
+                benchmark_compute(sample_count, points_count, 0, 0, CALIBRATION_VALIDATION_ANGLE_KERNEL_REFERENCE,
+                    COMPUTE_THREADS);
+            }
+        }
+    }
+    for (size_t k = 0; k < sizeof(points_counts) / sizeof(points_counts[0]); ++k) {
+        benchmark_session(CALLBACK_SAMPLE_COUNT, points_counts[k]);
+    }
+    for (size_t k = 0; k < sizeof(points_counts) / sizeof(points_counts[0]); ++k) {
+        benchmark_export(CALLBACK_SAMPLE_COUNT, points_counts[k], CALIBRATION_VALIDATION_EXPORT_FORMAT_BINARY);
+        benchmark_export(CALLBACK_SAMPLE_COUNT, points_counts[k], CALIBRATION_VALIDATION_EXPORT_FORMAT_JSON);
+    }
+    benchmark_angle(VECTOR3_ANGLE_KERNEL_REFERENCE, "reference");
+    benchmark_angle(VECTOR3_ANGLE_KERNEL_NORMALIZED, "normalized");
+    benchmark_angle(VECTOR3_ANGLE_KERNEL_ATAN2, "atan2");
+    benchmark_angle(VECTOR3_ANGLE_KERNEL_FAST, "fast");
+    for (size_t i = 0; i < sizeof(grid_points_counts) / sizeof(grid_points_counts[0]); ++i) {
+        benchmark_point_index(grid_points_counts[i], 0);
+        benchmark_point_index(grid_points_counts[i], 1);
+    }
+    return 0;
+}
@@ -0,0 +1,210 @@
+/*
+Copyright 2019 Tobii Pro AB
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "drift_monitor.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "atomics.h"
+#include "eye_statistics.h"
+
+typedef struct {
+    TobiiResearchNormalizedPoint2D screen_point;
+    TobiiResearchPoint3D target;
+    Vector3AngleKernel kernel;
+    /* Changes with every target set, zero when stopped. */
+    size_t id;
+} MonitorTarget;
+
+typedef struct {
+    TobiiResearchPoint3D gaze_origin;
+    TobiiResearchPoint3D gaze_point;
+    /* Sample-to-sample angle from the previous sample in the window. */
+    float angle;
+} MonitorEyeSample;
+
+typedef struct {
+    MonitorEyeSample left;
+    MonitorEyeSample right;
+} MonitorSample;
+
+struct DriftMonitor {
+    /* Written by the application thread. */
+    volatile size_t target_sequence;
+    MonitorTarget target;
+    size_t last_target_id;
+
+    /* Only used by the gaze data callback. The window is a ring of capacity samples starting at first. */
+    MonitorTarget callback_target;
+    MonitorSample* samples;
+    size_t capacity;
+    size_t first;
+    size_t count;
+    EyeStatistics left_eye_statistics;
+    EyeStatistics right_eye_statistics;
+    /* Adding and removing samples accumulates rounding errors, which would grow without bound over a long
+     * recording. The samples are also added to these, which replace the statistics above once they hold a whole
+     * window, so the errors never build up over more than two windows at a constant cost per sample. */
+    EyeStatistics next_left_eye_statistics;
+    EyeStatistics next_right_eye_statistics;
+
+    /* Written by the gaze data callback. */
+    volatile size_t result_sequence;
+    CalibrationValidationMonitorResult result;
+};
+
+static void clear_result(CalibrationValidationMonitorResult* result, const TobiiResearchNormalizedPoint2D* point) {
+    result->screen_point = *point;
+    result->sample_count = 0;
+    result->system_time_stamp = 0;
+    result->accuracy_left_eye = NAN;
+    result->accuracy_right_eye = NAN;
+    result->precision_left_eye = NAN;
+    result->precision_right_eye = NAN;
+    result->precision_rms_left_eye = NAN;
+    result->precision_rms_right_eye = NAN;
+}
+
+static void reset_statistics(DriftMonitor* instance) {
+    eye_statistics_reset(&instance->left_eye_statistics);
+    eye_statistics_reset(&instance->right_eye_statistics);
+    eye_statistics_reset(&instance->next_left_eye_statistics);
+    eye_statistics_reset(&instance->next_right_eye_statistics);
+}
+
+static void remove_first_sample(DriftMonitor* instance) {
+    const MonitorSample* sample = &instance->samples[instance->first];
+    const MonitorSample* next = &instance->samples[(instance->first + 1) % instance->capacity];
+    eye_statistics_remove_first(&instance->left_eye_statistics, &sample->left.gaze_origin, &sample->left.gaze_point,
+        next->left.angle);
+    eye_statistics_remove_first(&instance->right_eye_statistics, &sample->right.gaze_origin,
+        &sample->right.gaze_point, next->right.angle);
+    instance->first = (instance->first + 1) % instance->capacity;
+    instance->count--;
+}
+
+static void publish_result(DriftMonitor* instance, int64_t system_time_stamp) {
+    const EyeStatistics* left = &instance->left_eye_statistics;
+    const EyeStatistics* right = &instance->right_eye_statistics;
+    const MonitorTarget* target = &instance->callback_target;
+
+    /* Computed before locking, to keep readers retrying as briefly as possible. */
+    CalibrationValidationMonitorResult result;
+    result.screen_point = target->screen_point;
+    result.sample_count = instance->count;
+    result.system_time_stamp = system_time_stamp;
+    result.accuracy_left_eye = eye_statistics_accuracy(left, &target->target, target->kernel);
+    result.accuracy_right_eye = eye_statistics_accuracy(right, &target->target, target->kernel);
+    result.precision_left_eye = eye_statistics_precision(left);
+    result.precision_right_eye = eye_statistics_precision(right);
+    result.precision_rms_left_eye = instance->count > 1 ? eye_statistics_precision_rms(left) : NAN;
+    result.precision_rms_right_eye = instance->count > 1 ? eye_statistics_precision_rms(right) : NAN;
+
+    seqlock_write_begin(&instance->result_sequence);
+    instance->result = result;
+    seqlock_write_end(&instance->result_sequence);
+}
+
+DriftMonitor* drift_monitor_init(size_t window_size) {
+    DriftMonitor* instance = malloc(sizeof(*instance));
+    memset(instance, 0, sizeof(*instance));
+    instance->capacity = window_size;
+    instance->samples = malloc(window_size * sizeof(*instance->samples));
+    TobiiResearchNormalizedPoint2D no_point = { NAN, NAN };
+    clear_result(&instance->result, &no_point);
+    return instance;
+}
+
+void drift_monitor_destroy(DriftMonitor* instance) {
+    if (instance) {
+        free(instance->samples);
+        free(instance);
+    }
+}
+
+void drift_monitor_set_target(DriftMonitor* instance, const TobiiResearchNormalizedPoint2D* screen_point,
+    const TobiiResearchPoint3D* target, Vector3AngleKernel kernel) {
+    MonitorTarget new_target;
+    memset(&new_target, 0, sizeof(new_target));
+    if (screen_point) {
+        new_target.screen_point = *screen_point;
+        new_target.target = *target;
+        new_target.kernel = kernel;
+        new_target.id = ++instance->last_target_id;
+    }
+
+    seqlock_write_begin(&instance->target_sequence);
+    instance->target = new_target;
+    seqlock_write_end(&instance->target_sequence);
+}
+
+void drift_monitor_add(DriftMonitor* instance, const TobiiResearchGazeData* gaze_data) {
+    MonitorTarget target;
+    size_t sequence;
+    do {
+        sequence = seqlock_read_begin(&instance->target_sequence);
+        target = instance->target;
+    } while (seqlock_read_retry(&instance->target_sequence, sequence));
+
+    if (!target.id) {
+        return;
+    }
+    if (target.id != instance->callback_target.id) {
+        /* New target, start over. */
+        instance->callback_target = target;
+        instance->first = 0;
+        instance->count = 0;
+        reset_statistics(instance);
+    }
+
+    if (instance->count == instance->capacity) {
+        remove_first_sample(instance);
+    }
+    MonitorSample* sample = &instance->samples[(instance->first + instance->count) % instance->capacity];
+    sample->left.gaze_origin = gaze_data->left_eye.gaze_origin.position_in_user_coordinates;
+    sample->left.gaze_point = gaze_data->left_eye.gaze_point.position_in_user_coordinates;
+    sample->right.gaze_origin = gaze_data->right_eye.gaze_origin.position_in_user_coordinates;
+    sample->right.gaze_point = gaze_data->right_eye.gaze_point.position_in_user_coordinates;
+    instance->count++;
+
+    sample->left.angle = eye_statistics_add(&instance->left_eye_statistics, &sample->left.gaze_origin,
+        &sample->left.gaze_point, target.kernel);
+    sample->right.angle = eye_statistics_add(&instance->right_eye_statistics, &sample->right.gaze_origin,
+        &sample->right.gaze_point, target.kernel);
+    eye_statistics_add(&instance->next_left_eye_statistics, &sample->left.gaze_origin, &sample->left.gaze_point,
+        target.kernel);
+    eye_statistics_add(&instance->next_right_eye_statistics, &sample->right.gaze_origin, &sample->right.gaze_point,
+        target.kernel);
+    if (instance->next_left_eye_statistics.count == instance->capacity) {
+        /* The window is full and exactly the samples added since the last replacement. */
+        instance->left_eye_statistics = instance->next_left_eye_statistics;
+        instance->right_eye_statistics = instance->next_right_eye_statistics;
+        eye_statistics_reset(&instance->next_left_eye_statistics);
+        eye_statistics_reset(&instance->next_right_eye_statistics);
+    }
+
+    publish_result(instance, gaze_data->system_time_stamp);
+}
+
+void drift_monitor_result(DriftMonitor* instance, CalibrationValidationMonitorResult* result) {
+    size_t sequence;
+    do {
+        sequence = seqlock_read_begin(&instance->result_sequence);
+        *result = instance->result;
+    } while (seqlock_read_retry(&instance->result_sequence, sequence));
+}
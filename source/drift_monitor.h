@@ -0,0 +1,53 @@
+/*
+Copyright 2019 Tobii Pro AB
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef DRIFT_MONITOR_H_
+#define DRIFT_MONITOR_H_
+
+#include <stddef.h>
+
+#include "screen_based_calibration_validation.h"
+#include "vectormath.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Accuracy and precision over a sliding window of the most recent valid samples for a target point.
+ *
+ * The application thread sets the target and the gaze data callback adds samples, which updates the statistics of
+ * the window in constant time and publishes a new result. Target and result are passed between the threads
+ * through sequence locks, so neither ever waits for the other and the result can be read from any thread. */
+
+typedef struct DriftMonitor DriftMonitor;
+
+extern DriftMonitor* drift_monitor_init(size_t window_size);
+extern void drift_monitor_destroy(DriftMonitor* instance);
+
+/* Starts over with no samples for the target, or stops adding samples if screen_point is NULL. */
+extern void drift_monitor_set_target(DriftMonitor* instance, const TobiiResearchNormalizedPoint2D* screen_point,
+    const TobiiResearchPoint3D* target, Vector3AngleKernel kernel);
+
+/* Only called by the gaze data callback, for valid samples. */
+extern void drift_monitor_add(DriftMonitor* instance, const TobiiResearchGazeData* gaze_data);
+
+extern void drift_monitor_result(DriftMonitor* instance, CalibrationValidationMonitorResult* result);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* DRIFT_MONITOR_H_ */
@@ -0,0 +1,124 @@
+/*
+Copyright 2019 Tobii Pro AB
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "event.h"
+
+#include <stdlib.h>
+
+#if defined(_WIN32) || defined(_WIN64)
+
+#include <windows.h>
+
+struct Event {
+    HANDLE handle;
+};
+
+Event* event_init() {
+    Event* instance = malloc(sizeof(*instance));
+    instance->handle = CreateEvent(NULL, FALSE, FALSE, NULL);
+    return instance;
+}
+
+void event_destroy(Event* instance) {
+    if (instance) {
+        CloseHandle(instance->handle);
+        free(instance);
+    }
+}
+
+void event_set(Event* instance) {
+    SetEvent(instance->handle);
+}
+
+int event_wait(Event* instance, long timeout) {
+    return WaitForSingleObject(instance->handle, (DWORD)timeout) == WAIT_OBJECT_0;
+}
+
+#else
+
+#include <errno.h>
+#include <pthread.h>
+#include <time.h>
+
+struct Event {
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    int signaled;
+};
+
+Event* event_init() {
+    Event* instance = malloc(sizeof(*instance));
+    pthread_mutex_init(&instance->mutex, NULL);
+#if defined(__APPLE__) || defined(__MACH__)
+    pthread_cond_init(&instance->cond, NULL);
+#else
+    /* Wait on the monotonic clock so that wall clock adjustments do not affect the timeout. */
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&instance->cond, &attr);
+    pthread_condattr_destroy(&attr);
+#endif
+    instance->signaled = 0;
+    return instance;
+}
+
+void event_destroy(Event* instance) {
+    if (instance) {
+        pthread_cond_destroy(&instance->cond);
+        pthread_mutex_destroy(&instance->mutex);
+        free(instance);
+    }
+}
+
+void event_set(Event* instance) {
+    pthread_mutex_lock(&instance->mutex);
+    instance->signaled = 1;
+    pthread_cond_signal(&instance->cond);
+    pthread_mutex_unlock(&instance->mutex);
+}
+
+int event_wait(Event* instance, long timeout) {
+    struct timespec time;
+#if defined(__APPLE__) || defined(__MACH__)
+    time.tv_sec = timeout / 1000;
+    time.tv_nsec = (timeout % 1000) * 1000000;
+#else
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    time.tv_sec += timeout / 1000;
+    time.tv_nsec += (timeout % 1000) * 1000000;
+    if (time.tv_nsec >= 1000000000) {
+        time.tv_sec++;
+        time.tv_nsec -= 1000000000;
+    }
+#endif
+
+    pthread_mutex_lock(&instance->mutex);
+    int error = 0;
+    while (!instance->signaled && error != ETIMEDOUT) {
+#if defined(__APPLE__) || defined(__MACH__)
+        error = pthread_cond_timedwait_relative_np(&instance->cond, &instance->mutex, &time);
+#else
+        error = pthread_cond_timedwait(&instance->cond, &instance->mutex, &time);
+#endif
+    }
+    int signaled = instance->signaled;
+    instance->signaled = 0;
+    pthread_mutex_unlock(&instance->mutex);
+    return signaled;
+}
+
+#endif
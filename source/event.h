@@ -0,0 +1,39 @@
+/*
+Copyright 2019 Tobii Pro AB
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef EVENT_H_
+#define EVENT_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Auto-reset event. Setting the event wakes one waiting thread, or the next thread to wait if none is waiting. */
+
+typedef struct Event Event;
+
+extern Event* event_init();
+extern void event_destroy(Event* instance);
+extern void event_set(Event* instance);
+
+/* Waits at most timeout milliseconds for the event to be set. Returns nonzero if it was set. */
+extern int event_wait(Event* instance, long timeout);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* EVENT_H_ */
@@ -0,0 +1,136 @@
+/*
+Copyright 2019 Tobii Pro AB
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#include "export_writer.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+struct ExportWriter {
+    CalibrationValidationExportSink sink;
+    void* user_data;
+    int failed;
+    size_t size;
+    unsigned char buffer[EXPORT_WRITER_BUFFER_SIZE];
+};
+
+static void flush(ExportWriter* instance) {
+    if (instance->size && !instance->failed) {
+        instance->failed = instance->sink(instance->buffer, instance->size, instance->user_data) != 0;
+    }
+    instance->size = 0;
+}
+
+ExportWriter* export_writer_init(CalibrationValidationExportSink sink, void* user_data) {
+    ExportWriter* instance = malloc(sizeof(*instance));
+    instance->sink = sink;
+    instance->user_data = user_data;
+    instance->failed = 0;
+    instance->size = 0;
+    return instance;
+}
+
+int export_writer_destroy(ExportWriter* instance) {
+    flush(instance);
+    int succeeded = !instance->failed;
+    free(instance);
+    return succeeded;
+}
+
+void export_writer_write(ExportWriter* instance, const void* data, size_t size) {
+    const unsigned char* bytes = (const unsigned char*)data;
+    while (size && !instance->failed) {
+        size_t chunk = EXPORT_WRITER_BUFFER_SIZE - instance->size;
+        if (chunk > size) {
+            chunk = size;
+        }
+        memcpy(instance->buffer + instance->size, bytes, chunk);
+        instance->size += chunk;
+        bytes += chunk;
+        size -= chunk;
+        if (instance->size == EXPORT_WRITER_BUFFER_SIZE) {
+            flush(instance);
+        }
+    }
+}
+
+/* Stores size bytes of value, least significant first. Straight into the buffer unless it is about to fill up. */
+static void write_little_endian(ExportWriter* instance, uint64_t value, size_t size) {
+    unsigned char bytes[8];
+    unsigned char* destination = bytes;
+    int buffered = EXPORT_WRITER_BUFFER_SIZE - instance->size > size;
+    if (buffered) {
+        destination = instance->buffer + instance->size;
+    }
+    for (size_t i = 0; i < size; ++i) {
+        destination[i] = (unsigned char)(value >> (8 * i));
+    }
+    if (buffered) {
+        instance->size += size;
+    } else {
+        export_writer_write(instance, bytes, size);
+    }
+}
+
+void export_writer_u32(ExportWriter* instance, uint32_t value) {
+    write_little_endian(instance, value, 4);
+}
+
+void export_writer_i64(ExportWriter* instance, int64_t value) {
+    write_little_endian(instance, (uint64_t)value, 8);
+}
+
+void export_writer_f32(ExportWriter* instance, float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    write_little_endian(instance, bits, 4);
+}
+
+void export_writer_printf(ExportWriter* instance, const char* format, ...) {
+    if (instance->failed) {
+        return;
+    }
+    /* Format straight into the buffer. If it does not fit, flush and format again into the empty buffer. */
+    for (int attempt = 0; attempt < 2; ++attempt) {
+        size_t available = EXPORT_WRITER_BUFFER_SIZE - instance->size;
+        va_list arguments;
+        va_start(arguments, format);
+        int length = vsnprintf((char*)instance->buffer + instance->size, available, format, arguments);
+        va_end(arguments);
+        if (length < 0) {
+            instance->failed = 1;
+            return;
+        }
+        if ((size_t)length < available) {
+            instance->size += (size_t)length;
+            return;
+        }
+        flush(instance);
+    }
+    instance->failed = 1;
+}
+
+void export_writer_json_f32(ExportWriter* instance, float value) {
+    if (isfinite(value)) {
+        export_writer_printf(instance, "%.9g", value);
+    } else {
+        export_writer_write(instance, "null", 4);
+    }
+}
@@ -0,0 +1,59 @@
+/*
+Copyright 2019 Tobii Pro AB
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#ifndef EXPORT_WRITER_H_
+#define EXPORT_WRITER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "screen_based_calibration_validation.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Buffers what an export writes and hands it to the sink in chunks of at most EXPORT_WRITER_BUFFER_SIZE bytes,
+ * so that an export of any size uses the same memory. Once the sink fails, everything written after is dropped. */
+
+#define EXPORT_WRITER_BUFFER_SIZE (65536)
+
+typedef struct ExportWriter ExportWriter;
+
+extern ExportWriter* export_writer_init(CalibrationValidationExportSink sink, void* user_data);
+
+/* Hands what is left in the buffer to the sink. Returns 0 if the sink failed at any point. */
+extern int export_writer_destroy(ExportWriter* instance);
+
+extern void export_writer_write(ExportWriter* instance, const void* data, size_t size);
+
+/* Binary values are written little-endian, regardless of the byte order of the machine. */
+extern void export_writer_u32(ExportWriter* instance, uint32_t value);
+extern void export_writer_i64(ExportWriter* instance, int64_t value);
+extern void export_writer_f32(ExportWriter* instance, float value);
+
+/* Formatted text, at most EXPORT_WRITER_BUFFER_SIZE bytes at a time. */
+extern void export_writer_printf(ExportWriter* instance, const char* format, ...);
+
+/* A JSON number with enough digits to read back the same float, or null for NaN and infinities. */
+extern void export_writer_json_f32(ExportWriter* instance, float value);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* EXPORT_WRITER_H_ */
@@ -0,0 +1,170 @@
+/*
+Copyright 2019 Tobii Pro AB
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <math.h>
+#include <string.h>
+
+#include "eye_statistics.h"
+
+static void mean_to_point3(TobiiResearchPoint3D* point, const double* mean) {
+    point->x = (float)mean[0];
+    point->y = (float)mean[1];
+    point->z = (float)mean[2];
+}
+
+void eye_statistics_reset(EyeStatistics* statistics) {
+    memset(statistics, 0, sizeof(*statistics));
+}
+
+float eye_statistics_add(EyeStatistics* statistics,
+    const TobiiResearchPoint3D* gaze_origin, const TobiiResearchPoint3D* gaze_point, Vector3AngleKernel kernel) {
+    double origin[3] = { gaze_origin->x, gaze_origin->y, gaze_origin->z };
+    double point[3] = { gaze_point->x, gaze_point->y, gaze_point->z };
+    double delta[3];
+    double delta_new[3];
+
+    statistics->count++;
+    for (int i = 0; i < 3; ++i) {
+        statistics->gaze_origin_mean[i] += (origin[i] - statistics->gaze_origin_mean[i]) / statistics->count;
+        delta[i] = point[i] - statistics->gaze_point_mean[i];
+        statistics->gaze_point_mean[i] += delta[i] / statistics->count;
+        delta_new[i] = point[i] - statistics->gaze_point_mean[i];
+    }
+    statistics->gaze_point_m2[0] += delta[0] * delta_new[0];
+    statistics->gaze_point_m2[1] += delta[0] * delta_new[1];
+    statistics->gaze_point_m2[2] += delta[0] * delta_new[2];
+    statistics->gaze_point_m2[3] += delta[1] * delta_new[1];
+    statistics->gaze_point_m2[4] += delta[1] * delta_new[2];
+    statistics->gaze_point_m2[5] += delta[2] * delta_new[2];
+
+    TobiiResearchVector3D direction;
+    vector3_create_from_points(&direction, gaze_origin, gaze_point);
+    vector3_normalize(&direction);
+    float angle = 0.0f;
+    if (statistics->count == 1) {
+        statistics->first_direction = direction;
+    } else {
+        angle = vector3_angle_with(kernel, &statistics->last_direction, &direction);
+        statistics->sample_to_sample_sum += angle * angle;
+    }
+    statistics->last_direction = direction;
+    return angle;
+}
+
+void eye_statistics_remove_first(EyeStatistics* statistics,
+    const TobiiResearchPoint3D* gaze_origin, const TobiiResearchPoint3D* gaze_point, float next_angle) {
+    double origin[3] = { gaze_origin->x, gaze_origin->y, gaze_origin->z };
+    double point[3] = { gaze_point->x, gaze_point->y, gaze_point->z };
+    double delta[3];
+    double delta_new[3];
+
+    /* eye_statistics_add in reverse, delta is relative to the mean with the sample and delta_new without it. */
+    statistics->count--;
+    for (int i = 0; i < 3; ++i) {
+        statistics->gaze_origin_mean[i] += (statistics->gaze_origin_mean[i] - origin[i]) / statistics->count;
+        delta_new[i] = point[i] - statistics->gaze_point_mean[i];
+        statistics->gaze_point_mean[i] += (statistics->gaze_point_mean[i] - point[i]) / statistics->count;
+        delta[i] = point[i] - statistics->gaze_point_mean[i];
+    }
+    statistics->gaze_point_m2[0] -= delta[0] * delta_new[0];
+    statistics->gaze_point_m2[1] -= delta[0] * delta_new[1];
+    statistics->gaze_point_m2[2] -= delta[0] * delta_new[2];
+    statistics->gaze_point_m2[3] -= delta[1] * delta_new[1];
+    statistics->gaze_point_m2[4] -= delta[1] * delta_new[2];
+    statistics->gaze_point_m2[5] -= delta[2] * delta_new[2];
+
+    statistics->sample_to_sample_sum -= next_angle * next_angle;
+    if (statistics->sample_to_sample_sum < 0.0) {
+        statistics->sample_to_sample_sum = 0.0;
+    }
+}
+
+void eye_statistics_merge(EyeStatistics* to, const EyeStatistics* from, Vector3AngleKernel kernel) {
+    if (from->count == 0) {
+        return;
+    }
+    if (to->count == 0) {
+        *to = *from;
+        return;
+    }
+
+    /* Pairwise combination of means and squared deviations (Chan et al.). */
+    double count = (double)(to->count + from->count);
+    double from_weight = from->count / count;
+    double delta[3];
+    for (int i = 0; i < 3; ++i) {
+        to->gaze_origin_mean[i] += (from->gaze_origin_mean[i] - to->gaze_origin_mean[i]) * from_weight;
+        delta[i] = from->gaze_point_mean[i] - to->gaze_point_mean[i];
+        to->gaze_point_mean[i] += delta[i] * from_weight;
+    }
+    double factor = (double)to->count * from->count / count;
+    to->gaze_point_m2[0] += from->gaze_point_m2[0] + delta[0] * delta[0] * factor;
+    to->gaze_point_m2[1] += from->gaze_point_m2[1] + delta[0] * delta[1] * factor;
+    to->gaze_point_m2[2] += from->gaze_point_m2[2] + delta[0] * delta[2] * factor;
+    to->gaze_point_m2[3] += from->gaze_point_m2[3] + delta[1] * delta[1] * factor;
+    to->gaze_point_m2[4] += from->gaze_point_m2[4] + delta[1] * delta[2] * factor;
+    to->gaze_point_m2[5] += from->gaze_point_m2[5] + delta[2] * delta[2] * factor;
+
+    /* The samples are consecutive, so the step between the two sets counts as a sample-to-sample angle. */
+    float angle = vector3_angle_with(kernel, &to->last_direction, &from->first_direction);
+    to->sample_to_sample_sum += from->sample_to_sample_sum + angle * angle;
+    to->last_direction = from->last_direction;
+    to->count += from->count;
+}
+
+float eye_statistics_accuracy(const EyeStatistics* statistics, const TobiiResearchPoint3D* stimuli_point,
+    Vector3AngleKernel kernel) {
+    TobiiResearchPoint3D gaze_origin_mean;
+    TobiiResearchPoint3D gaze_point_mean;
+    TobiiResearchVector3D direction_gaze_point;
+    TobiiResearchVector3D direction_target;
+
+    mean_to_point3(&gaze_origin_mean, statistics->gaze_origin_mean);
+    mean_to_point3(&gaze_point_mean, statistics->gaze_point_mean);
+    vector3_create_from_points(&direction_gaze_point, &gaze_origin_mean, &gaze_point_mean);
+    vector3_normalize(&direction_gaze_point);
+    vector3_create_from_points(&direction_target, &gaze_origin_mean, stimuli_point);
+    vector3_normalize(&direction_target);
+    return vector3_angle_with(kernel, &direction_gaze_point, &direction_target);
+}
+
+float eye_statistics_precision(const EyeStatistics* statistics) {
+    /* The angular spread about the mean gaze direction is the spread of the gaze points perpendicular to
+     * that direction, seen from the mean gaze origin. Differs from the per-sample calculation by the
+     * movement of the gaze origin during the collection, which is negligible for a fixating eye. */
+    double axis[3];
+    double distance = 0.0;
+    for (int i = 0; i < 3; ++i) {
+        axis[i] = statistics->gaze_point_mean[i] - statistics->gaze_origin_mean[i];
+        distance += axis[i] * axis[i];
+    }
+    distance = sqrt(distance);
+    for (int i = 0; i < 3; ++i) {
+        axis[i] /= distance;
+    }
+
+    const double* m2 = statistics->gaze_point_m2;
+    double total = m2[0] + m2[3] + m2[5];
+    double along_axis = axis[0] * axis[0] * m2[0] + axis[1] * axis[1] * m2[3] + axis[2] * axis[2] * m2[5] +
+        2.0 * (axis[0] * axis[1] * m2[1] + axis[0] * axis[2] * m2[2] + axis[1] * axis[2] * m2[4]);
+    double variance = (total - along_axis) / statistics->count;
+    double angle = atan2(sqrt(fmax(variance, 0.0)), distance);
+    return (float)(angle * 180 / M_PI);
+}
+
+float eye_statistics_precision_rms(const EyeStatistics* statistics) {
+    return (float)sqrt(statistics->sample_to_sample_sum / (statistics->count - 1));
+}
@@ -0,0 +1,61 @@
+/*
+Copyright 2019 Tobii Pro AB
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef EYE_STATISTICS_H_
+#define EYE_STATISTICS_H_
+
+#include "vectormath.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Running statistics for one eye, updated one sample at a time (Welford) so that accuracy and precision can be
+ * read out in constant time. */
+typedef struct {
+    size_t count;
+    double gaze_origin_mean[3];
+    double gaze_point_mean[3];
+    /* Sum of squared deviations from the mean gaze point: xx, xy, xz, yy, yz, zz. */
+    double gaze_point_m2[6];
+    /* Sum of squared sample-to-sample angles in degrees, and the directions needed to extend it. */
+    double sample_to_sample_sum;
+    TobiiResearchVector3D first_direction;
+    TobiiResearchVector3D last_direction;
+} EyeStatistics;
+
+extern void eye_statistics_reset(EyeStatistics* statistics);
+/* Angles are computed with kernel, which should be the same for all samples of the statistics. Returns the
+ * sample-to-sample angle from the previous sample, or zero for the first sample. */
+extern float eye_statistics_add(EyeStatistics* statistics,
+    const TobiiResearchPoint3D* gaze_origin, const TobiiResearchPoint3D* gaze_point, Vector3AngleKernel kernel);
+/* Removes the first of at least two samples, for sliding windows. next_angle is the sample-to-sample angle from it to
+ * the second sample, as returned when the second sample was added. Statistics that samples have been removed from
+ * cannot be merged into others. */
+extern void eye_statistics_remove_first(EyeStatistics* statistics,
+    const TobiiResearchPoint3D* gaze_origin, const TobiiResearchPoint3D* gaze_point, float next_angle);
+extern void eye_statistics_merge(EyeStatistics* to, const EyeStatistics* from, Vector3AngleKernel kernel);
+
+extern float eye_statistics_accuracy(const EyeStatistics* statistics, const TobiiResearchPoint3D* stimuli_point,
+    Vector3AngleKernel kernel);
+extern float eye_statistics_precision(const EyeStatistics* statistics);
+extern float eye_statistics_precision_rms(const EyeStatistics* statistics);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* EYE_STATISTICS_H_ */
@@ -0,0 +1,85 @@
+/*
+Copyright 2019 Tobii Pro AB
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "gaze_data_ring.h"
+
+#include <stdlib.h>
+
+#include "atomics.h"
+
+#define CACHE_LINE_SIZE (64)
+
+struct GazeDataRing {
+    GazeDataRingEntry* entries;
+    size_t mask;
+
+    /* Producer and consumer indices live on separate cache lines. Both increase monotonically and are
+     * wrapped with the mask when indexing. */
+    char padding0[CACHE_LINE_SIZE];
+    volatile size_t head;
+    char padding1[CACHE_LINE_SIZE];
+    volatile size_t tail;
+    char padding2[CACHE_LINE_SIZE];
+};
+
+GazeDataRing* gaze_data_ring_init(size_t capacity) {
+    size_t rounded_capacity = 1;
+    while (rounded_capacity < capacity) {
+        rounded_capacity <<= 1;
+    }
+
+    GazeDataRing* instance = malloc(sizeof(*instance));
+    instance->entries = malloc(rounded_capacity * sizeof(*instance->entries));
+    instance->mask = rounded_capacity - 1;
+    instance->head = 0;
+    instance->tail = 0;
+    return instance;
+}
+
+void gaze_data_ring_destroy(GazeDataRing* instance) {
+    if (instance) {
+        free(instance->entries);
+        free(instance);
+    }
+}
+
+int gaze_data_ring_full(GazeDataRing* instance) {
+    return atomic_load_acquire(&instance->head) - atomic_load_acquire(&instance->tail) > instance->mask;
+}
+
+int gaze_data_ring_push(GazeDataRing* instance, const TobiiResearchGazeData* gaze_data, size_t collection_id) {
+    size_t head = instance->head;
+    if (head - atomic_load_acquire(&instance->tail) > instance->mask) {
+        return 0;
+    }
+    GazeDataRingEntry* entry = &instance->entries[head & instance->mask];
+    entry->gaze_data = *gaze_data;
+    entry->collection_id = collection_id;
+    atomic_store_release(&instance->head, head + 1);
+    return 1;
+}
+
+const GazeDataRingEntry* gaze_data_ring_front(GazeDataRing* instance) {
+    size_t tail = instance->tail;
+    if (tail == atomic_load_acquire(&instance->head)) {
+        return NULL;
+    }
+    return &instance->entries[tail & instance->mask];
+}
+
+void gaze_data_ring_pop(GazeDataRing* instance) {
+    atomic_store_release(&instance->tail, instance->tail + 1);
+}
@@ -0,0 +1,52 @@
+/*
+Copyright 2019 Tobii Pro AB
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef GAZE_DATA_RING_H_
+#define GAZE_DATA_RING_H_
+
+#include "tobii_research_streams.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Fixed capacity, lock-free ring buffer of gaze data samples with exactly one producer thread (the gaze data
+ * callback) and one consumer thread. Each sample is tagged with the data collection it belongs to. */
+
+typedef struct {
+    TobiiResearchGazeData gaze_data;
+    size_t collection_id;
+} GazeDataRingEntry;
+
+typedef struct GazeDataRing GazeDataRing;
+
+extern GazeDataRing* gaze_data_ring_init(size_t capacity);
+extern void gaze_data_ring_destroy(GazeDataRing* instance);
+/* Either side. A full ring stays full until the consumer pops an entry. */
+extern int gaze_data_ring_full(GazeDataRing* instance);
+
+/* Producer side. Returns zero if the ring is full and the sample was dropped. */
+extern int gaze_data_ring_push(GazeDataRing* instance, const TobiiResearchGazeData* gaze_data, size_t collection_id);
+
+/* Consumer side. Returns the oldest entry or NULL if empty. The entry is valid until gaze_data_ring_pop. */
+extern const GazeDataRingEntry* gaze_data_ring_front(GazeDataRing* instance);
+extern void gaze_data_ring_pop(GazeDataRing* instance);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* GAZE_DATA_RING_H_ */
@@ -0,0 +1,420 @@
+/*
+Copyright 2019 Tobii Pro AB
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "gaze_recording.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "atomics.h"
+#include "event.h"
+
+#if defined(_WIN32) || defined(_WIN64)
+
+#include <windows.h>
+
+typedef HANDLE Thread;
+
+#else
+
+#include <pthread.h>
+
+typedef pthread_t Thread;
+
+#endif
+
+#define GAZE_RECORDING_MAGIC "TGZR"
+#define GAZE_RECORDING_VERSION (1)
+/* Records start at this offset, which keeps them aligned in a mapped file. */
+#define GAZE_RECORDING_DATA_OFFSET (128)
+/* Records of the gaze data callback buffered for the writer thread, almost seven seconds of gaze data at 1200 Hz.
+ * Records that do not fit are dropped. */
+#define GAZE_RECORDER_CAPACITY (8192)
+/* Stimuli of the application thread buffered for the writer thread. */
+#define GAZE_RECORDER_STIMULI_CAPACITY (64)
+/* How often the writer thread writes the buffered records, in milliseconds. */
+#define GAZE_RECORDER_WRITE_INTERVAL (10)
+#define CACHE_LINE_SIZE (64)
+
+typedef struct {
+    char magic[4];
+    uint32_t version;
+    /* Size of the structs, so that recordings from another architecture are rejected. */
+    uint32_t record_size;
+    uint32_t gaze_data_size;
+    TobiiResearchDisplayArea display_area;
+} GazeRecordingHeader;
+
+typedef struct {
+    GazeRecord record;
+    /* For stimuli of the application thread, the number of records the gaze data callback had added before. */
+    size_t position;
+} RecorderEntry;
+
+/* Lock-free ring with one thread adding records and the writer thread taking them, like GazeDataRing. */
+typedef struct {
+    RecorderEntry* entries;
+    size_t mask;
+    char padding0[CACHE_LINE_SIZE];
+    volatile size_t head;
+    char padding1[CACHE_LINE_SIZE];
+    volatile size_t tail;
+    char padding2[CACHE_LINE_SIZE];
+} RecorderRing;
+
+/* The gaze data callback and the application thread each add records to a ring of their own, so that neither
+ * waits for the other or for the file. The writer thread merges them in the order they were added. */
+struct GazeRecorder {
+    FILE* file;
+    Thread writer;
+    /* Set when the recorder is destroyed. */
+    Event* wake_event;
+    volatile size_t stopping;
+
+    RecorderRing callback_records;
+    RecorderRing stimuli;
+    /* Records dropped since a ring was full, only counted by the thread adding them. */
+    size_t callback_dropped_count;
+    size_t stimuli_dropped_count;
+
+    /* Only used by the writer thread. Set if a record could not be written. */
+    size_t written_callback_count;
+    int failed;
+};
+
+static void ring_init(RecorderRing* ring, size_t capacity) {
+    /* The capacity is a power of two. */
+    ring->entries = malloc(capacity * sizeof(*ring->entries));
+    ring->mask = capacity - 1;
+    ring->head = 0;
+    ring->tail = 0;
+}
+
+static int ring_push(RecorderRing* ring, const GazeRecord* record, size_t position) {
+    size_t head = ring->head;
+    if (head - atomic_load_acquire(&ring->tail) > ring->mask) {
+        return 0;
+    }
+    RecorderEntry* entry = &ring->entries[head & ring->mask];
+    entry->record = *record;
+    entry->position = position;
+    atomic_store_release(&ring->head, head + 1);
+    return 1;
+}
+
+static const RecorderEntry* ring_front(RecorderRing* ring) {
+    size_t tail = ring->tail;
+    if (tail == atomic_load_acquire(&ring->head)) {
+        return NULL;
+    }
+    return &ring->entries[tail & ring->mask];
+}
+
+static void ring_pop(RecorderRing* ring) {
+    atomic_store_release(&ring->tail, ring->tail + 1);
+}
+
+static void write_record(GazeRecorder* instance, const GazeRecord* record) {
+    if (!instance->failed && fwrite(record, sizeof(*record), 1, instance->file) != 1) {
+        /* Later records are not written either, the recording ends with the last one written. */
+        instance->failed = 1;
+    }
+}
+
+static void write_records(GazeRecorder* instance) {
+    for (;;) {
+        /* A stimulus added before any record of the gaze data callback that is available by now is available as
+         * well, so it is read after them. */
+        size_t available = atomic_load_acquire(&instance->callback_records.head);
+        const RecorderEntry* stimulus = ring_front(&instance->stimuli);
+        size_t end = stimulus && stimulus->position < available ? stimulus->position : available;
+        while (instance->written_callback_count < end) {
+            write_record(instance, &ring_front(&instance->callback_records)->record);
+            ring_pop(&instance->callback_records);
+            instance->written_callback_count++;
+        }
+        if (!stimulus || instance->written_callback_count < stimulus->position) {
+            return;
+        }
+        write_record(instance, &stimulus->record);
+        ring_pop(&instance->stimuli);
+    }
+}
+
+static void run_writer(GazeRecorder* instance) {
+    for (;;) {
+        /* Everything added before the recorder is destroyed is written. */
+        size_t stopping = atomic_load_acquire(&instance->stopping);
+        write_records(instance);
+        if (stopping) {
+            break;
+        }
+        event_wait(instance->wake_event, GAZE_RECORDER_WRITE_INTERVAL);
+    }
+}
+
+#if defined(_WIN32) || defined(_WIN64)
+
+static DWORD WINAPI writer_thread(LPVOID argument) {
+    run_writer((GazeRecorder*)argument);
+    return 0;
+}
+
+static int start_thread(Thread* thread, GazeRecorder* instance) {
+    *thread = CreateThread(NULL, 0, writer_thread, instance, 0, NULL);
+    return *thread != NULL;
+}
+
+static void join_thread(Thread thread) {
+    WaitForSingleObject(thread, INFINITE);
+    CloseHandle(thread);
+}
+
+#else
+
+static void* writer_thread(void* argument) {
+    run_writer((GazeRecorder*)argument);
+    return NULL;
+}
+
+static int start_thread(Thread* thread, GazeRecorder* instance) {
+    return pthread_create(thread, NULL, writer_thread, instance) == 0;
+}
+
+static void join_thread(Thread thread) {
+    pthread_join(thread, NULL);
+}
+
+#endif
+
+static void free_recorder(GazeRecorder* instance) {
+    event_destroy(instance->wake_event);
+    free(instance->callback_records.entries);
+    free(instance->stimuli.entries);
+    free(instance);
+}
+
+GazeRecorder* gaze_recorder_init(const char* path, const TobiiResearchDisplayArea* display_area) {
+    FILE* file = fopen(path, "wb");
+    if (!file) {
+        return NULL;
+    }
+
+    char data[GAZE_RECORDING_DATA_OFFSET];
+    GazeRecordingHeader header;
+    memset(data, 0, sizeof(data));
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, GAZE_RECORDING_MAGIC, sizeof(header.magic));
+    header.version = GAZE_RECORDING_VERSION;
+    header.record_size = sizeof(GazeRecord);
+    header.gaze_data_size = sizeof(TobiiResearchGazeData);
+    header.display_area = *display_area;
+    memcpy(data, &header, sizeof(header));
+    if (fwrite(data, sizeof(data), 1, file) != 1) {
+        fclose(file);
+        return NULL;
+    }
+
+    GazeRecorder* instance = malloc(sizeof(*instance));
+    instance->file = file;
+    instance->wake_event = event_init();
+    instance->stopping = 0;
+    ring_init(&instance->callback_records, GAZE_RECORDER_CAPACITY);
+    ring_init(&instance->stimuli, GAZE_RECORDER_STIMULI_CAPACITY);
+    instance->callback_dropped_count = 0;
+    instance->stimuli_dropped_count = 0;
+    instance->written_callback_count = 0;
+    instance->failed = 0;
+    if (!start_thread(&instance->writer, instance)) {
+        fclose(file);
+        free_recorder(instance);
+        return NULL;
+    }
+    return instance;
+}
+
+int gaze_recorder_destroy(GazeRecorder* instance) {
+    if (!instance) {
+        return 1;
+    }
+    atomic_store_release(&instance->stopping, 1);
+    event_set(instance->wake_event);
+    join_thread(instance->writer);
+
+    int succeeded = !instance->failed && instance->callback_dropped_count == 0 &&
+        instance->stimuli_dropped_count == 0;
+    if (fclose(instance->file) != 0) {
+        succeeded = 0;
+    }
+    free_recorder(instance);
+    return succeeded;
+}
+
+static void add_callback_record(GazeRecorder* instance, const GazeRecord* record) {
+    if (!ring_push(&instance->callback_records, record, 0)) {
+        instance->callback_dropped_count++;
+    }
+}
+
+void gaze_recorder_add_gaze_data(GazeRecorder* instance, const TobiiResearchGazeData* gaze_data) {
+    GazeRecord record;
+    memset(&record, 0, sizeof(record));
+    record.type = GAZE_RECORD_GAZE_DATA;
+    record.data.gaze_data = *gaze_data;
+    add_callback_record(instance, &record);
+}
+
+void gaze_recorder_add_callback_stimulus(GazeRecorder* instance, const TobiiResearchNormalizedPoint2D* screen_point,
+    int64_t system_time_stamp) {
+    GazeRecord record;
+    memset(&record, 0, sizeof(record));
+    record.type = GAZE_RECORD_STIMULUS;
+    record.data.stimulus.screen_point = *screen_point;
+    record.data.stimulus.system_time_stamp = system_time_stamp;
+    add_callback_record(instance, &record);
+}
+
+void gaze_recorder_add_stimulus(GazeRecorder* instance, const TobiiResearchNormalizedPoint2D* screen_point,
+    int64_t system_time_stamp) {
+    GazeRecord record;
+    memset(&record, 0, sizeof(record));
+    record.type = GAZE_RECORD_STIMULUS;
+    record.data.stimulus.screen_point = *screen_point;
+    record.data.stimulus.system_time_stamp = system_time_stamp;
+    /* Written after every record the gaze data callback has added so far. */
+    if (!ring_push(&instance->stimuli, &record, atomic_load_acquire(&instance->callback_records.head))) {
+        instance->stimuli_dropped_count++;
+    }
+}
+
+#if defined(_WIN32) || defined(_WIN64)
+
+struct GazeRecording {
+    HANDLE file;
+    HANDLE mapping;
+    const char* data;
+    size_t size;
+};
+
+static int map_file(GazeRecording* instance, const char* path) {
+    instance->file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL,
+        NULL);
+    if (instance->file == INVALID_HANDLE_VALUE) {
+        return 0;
+    }
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(instance->file, &size) || size.QuadPart < GAZE_RECORDING_DATA_OFFSET) {
+        CloseHandle(instance->file);
+        return 0;
+    }
+    instance->size = (size_t)size.QuadPart;
+    instance->mapping = CreateFileMappingA(instance->file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (!instance->mapping) {
+        CloseHandle(instance->file);
+        return 0;
+    }
+    instance->data = MapViewOfFile(instance->mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!instance->data) {
+        CloseHandle(instance->mapping);
+        CloseHandle(instance->file);
+        return 0;
+    }
+    return 1;
+}
+
+static void unmap_file(GazeRecording* instance) {
+    UnmapViewOfFile(instance->data);
+    CloseHandle(instance->mapping);
+    CloseHandle(instance->file);
+}
+
+#else
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+struct GazeRecording {
+    const char* data;
+    size_t size;
+};
+
+static int map_file(GazeRecording* instance, const char* path) {
+    int file = open(path, O_RDONLY);
+    if (file < 0) {
+        return 0;
+    }
+    struct stat status;
+    if (fstat(file, &status) != 0 || status.st_size < GAZE_RECORDING_DATA_OFFSET) {
+        close(file);
+        return 0;
+    }
+    instance->size = (size_t)status.st_size;
+    void* data = mmap(NULL, instance->size, PROT_READ, MAP_PRIVATE, file, 0);
+    /* The mapping stays valid after closing the file. */
+    close(file);
+    if (data == MAP_FAILED) {
+        return 0;
+    }
+    instance->data = data;
+    return 1;
+}
+
+static void unmap_file(GazeRecording* instance) {
+    munmap((void*)instance->data, instance->size);
+}
+
+#endif
+
+GazeRecording* gaze_recording_open(const char* path) {
+    GazeRecording* instance = malloc(sizeof(*instance));
+    if (!map_file(instance, path)) {
+        free(instance);
+        return NULL;
+    }
+
+    const GazeRecordingHeader* header = (const GazeRecordingHeader*)instance->data;
+    if (memcmp(header->magic, GAZE_RECORDING_MAGIC, sizeof(header->magic)) != 0 ||
+        header->version != GAZE_RECORDING_VERSION ||
+        header->record_size != sizeof(GazeRecord) ||
+        header->gaze_data_size != sizeof(TobiiResearchGazeData)) {
+        gaze_recording_close(instance);
+        return NULL;
+    }
+    return instance;
+}
+
+void gaze_recording_close(GazeRecording* instance) {
+    if (instance) {
+        unmap_file(instance);
+        free(instance);
+    }
+}
+
+const TobiiResearchDisplayArea* gaze_recording_display_area(const GazeRecording* instance) {
+    return &((const GazeRecordingHeader*)instance->data)->display_area;
+}
+
+const GazeRecord* gaze_recording_records(const GazeRecording* instance) {
+    return (const GazeRecord*)(instance->data + GAZE_RECORDING_DATA_OFFSET);
+}
+
+size_t gaze_recording_count(const GazeRecording* instance) {
+    /* A partially written last record, e.g. after a crash, is ignored. */
+    return (instance->size - GAZE_RECORDING_DATA_OFFSET) / sizeof(GazeRecord);
+}
@@ -0,0 +1,88 @@
+/*
+Copyright 2019 Tobii Pro AB
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef GAZE_RECORDING_H_
+#define GAZE_RECORDING_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "tobii_research.h"
+#include "tobii_research_eyetracker.h"
+#include "tobii_research_streams.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Binary recording of the gaze data stream and the stimulus points of a validation session. The file starts
+ * with a header holding the display area, followed by fixed size records in the order they happened. The
+ * structs are stored as is, so a recording can be memory mapped and used in place on a machine with the same
+ * architecture. */
+
+typedef enum {
+    GAZE_RECORD_GAZE_DATA,
+    GAZE_RECORD_STIMULUS,
+} GazeRecordType;
+
+typedef struct {
+    uint32_t type;
+    uint32_t reserved;
+    union {
+        TobiiResearchGazeData gaze_data;
+        struct {
+            TobiiResearchNormalizedPoint2D screen_point;
+            int64_t system_time_stamp;
+        } stimulus;
+    } data;
+} GazeRecord;
+
+/* Writing. The gaze data callback and the application thread may each add records, which are written in the
+ * order they were added. Adding a record only copies it to a preallocated lock-free buffer, a writer thread owned
+ * by the recorder writes it to the file, so that the gaze data callback never waits for a lock, an allocation or
+ * the file. Records that do not fit since the writer thread has fallen behind are dropped. Destroying the recorder
+ * writes the remaining records. */
+
+typedef struct GazeRecorder GazeRecorder;
+
+/* Returns NULL if the file cannot be created or the writer thread cannot be started. */
+extern GazeRecorder* gaze_recorder_init(const char* path, const TobiiResearchDisplayArea* display_area);
+/* Returns 0 if a record was dropped or could not be written, 1 otherwise. */
+extern int gaze_recorder_destroy(GazeRecorder* instance);
+/* Only called by the gaze data callback. */
+extern void gaze_recorder_add_gaze_data(GazeRecorder* instance, const TobiiResearchGazeData* gaze_data);
+extern void gaze_recorder_add_callback_stimulus(GazeRecorder* instance,
+    const TobiiResearchNormalizedPoint2D* screen_point, int64_t system_time_stamp);
+/* Only called by the application thread. */
+extern void gaze_recorder_add_stimulus(GazeRecorder* instance, const TobiiResearchNormalizedPoint2D* screen_point,
+    int64_t system_time_stamp);
+
+/* Reading. */
+
+typedef struct GazeRecording GazeRecording;
+
+/* Returns NULL if the file cannot be read or is not a recording made on this architecture. */
+extern GazeRecording* gaze_recording_open(const char* path);
+extern void gaze_recording_close(GazeRecording* instance);
+extern const TobiiResearchDisplayArea* gaze_recording_display_area(const GazeRecording* instance);
+extern const GazeRecord* gaze_recording_records(const GazeRecording* instance);
+extern size_t gaze_recording_count(const GazeRecording* instance);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* GAZE_RECORDING_H_ */
@@ -0,0 +1,347 @@
+/*
+Copyright 2019 Tobii Pro AB
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+/* Stand-in for the Tobii Pro SDK library, libtobii_research, for building and running the addons without an
+ * eye tracker. Build with "make mock", or "make MOCK=1" to link the addons and the sample against it.
+ *
+ * Any address gives an eye tracker, each address its own. Every eye tracker with gaze data subscribers
+ * delivers gaze data from its own thread. The gaze data is configured with environment variables:
+ *   TOBII_MOCK_RATE     Gaze data rate in Hz, default 600.
+ *   TOBII_MOCK_JITTER   Maximum delivery jitter in microseconds, default 0. Time stamps stay on the nominal
+ *                       sampling times.
+ *   TOBII_MOCK_NOISE    Maximum gaze point noise in millimeters, default 2.
+ *   TOBII_MOCK_INVALID  Percentage of samples with invalid gaze points, default 0.
+ *   TOBII_MOCK_SCRIPT   Gaze trajectory file. Each line "<duration_ms> <x> <y>" fixates the normalized display
+ *                       point (x, y) for the duration, the script is repeated. Lines starting with # are
+ *                       ignored. By default the gaze stays at the center of the display.
+ *
+ * Only the functions used by the addons are implemented. Callbacks must not unsubscribe themselves. */
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "tobii_research.h"
+#include "tobii_research_eyetracker.h"
+#include "tobii_research_streams.h"
+
+#define MAX_SUBSCRIPTIONS (64)
+#define MAX_SCRIPT_STEPS (1024)
+#define EYE_DISTANCE (600.0f)
+#define EYE_OFFSET (32.0f)
+
+typedef struct {
+    tobii_research_gaze_data_callback callback;
+    void* user_data;
+} Subscription;
+
+typedef struct {
+    int64_t duration;
+    TobiiResearchNormalizedPoint2D point;
+} ScriptStep;
+
+struct TobiiResearchEyeTracker {
+    TobiiResearchEyeTracker* next;
+    char* address;
+
+    pthread_mutex_t mutex;
+    Subscription subscriptions[MAX_SUBSCRIPTIONS];
+    size_t subscriptions_count;
+    pthread_t thread;
+    int running;
+    unsigned int random_state;
+};
+
+static struct {
+    int rate;
+    int jitter;
+    float noise;
+    int invalid;
+    ScriptStep script[MAX_SCRIPT_STEPS];
+    size_t script_count;
+    int64_t script_duration;
+} config;
+
+static pthread_once_t config_once = PTHREAD_ONCE_INIT;
+static pthread_mutex_t eyetrackers_mutex = PTHREAD_MUTEX_INITIALIZER;
+static TobiiResearchEyeTracker* eyetrackers;
+
+static int get_config_value(const char* name, int default_value) {
+    const char* value = getenv(name);
+    return value ? atoi(value) : default_value;
+}
+
+static void read_config(void) {
+    config.rate = get_config_value("TOBII_MOCK_RATE", 600);
+    if (config.rate <= 0) {
+        config.rate = 600;
+    }
+    config.jitter = get_config_value("TOBII_MOCK_JITTER", 0);
+    config.noise = (float)get_config_value("TOBII_MOCK_NOISE", 2);
+    config.invalid = get_config_value("TOBII_MOCK_INVALID", 0);
+
+    config.script_count = 0;
+    config.script_duration = 0;
+    const char* path = getenv("TOBII_MOCK_SCRIPT");
+    FILE* file = path ? fopen(path, "r") : NULL;
+    if (file) {
+        char line[256];
+        while (config.script_count < MAX_SCRIPT_STEPS && fgets(line, sizeof(line), file)) {
+            ScriptStep* step = &config.script[config.script_count];
+            long duration;
+            if (line[0] != '#' && sscanf(line, "%ld %f %f", &duration, &step->point.x, &step->point.y) == 3 &&
+                duration > 0) {
+                step->duration = duration * 1000;
+                config.script_duration += step->duration;
+                config.script_count++;
+            }
+        }
+        fclose(file);
+    }
+    if (config.script_count == 0) {
+        config.script[0].duration = 1000000;
+        config.script[0].point.x = 0.5f;
+        config.script[0].point.y = 0.5f;
+        config.script_count = 1;
+        config.script_duration = config.script[0].duration;
+    }
+}
+
+static int64_t now_us(void) {
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return time.tv_sec * 1000000LL + time.tv_nsec / 1000;
+}
+
+static void sleep_until_us(int64_t time) {
+    int64_t duration = time - now_us();
+    if (duration > 0) {
+        struct timespec sleep_time;
+        sleep_time.tv_sec = duration / 1000000;
+        sleep_time.tv_nsec = (duration % 1000000) * 1000;
+        nanosleep(&sleep_time, NULL);
+    }
+}
+
+static float random_uniform(TobiiResearchEyeTracker* eyetracker) {
+    eyetracker->random_state = eyetracker->random_state * 1103515245u + 12345u;
+    return ((eyetracker->random_state >> 8) & 0xffff) / 65535.0f;
+}
+
+static const TobiiResearchNormalizedPoint2D* get_script_point(int64_t time) {
+    time %= config.script_duration;
+    for (size_t i = 0; i < config.script_count; ++i) {
+        if (time < config.script[i].duration) {
+            return &config.script[i].point;
+        }
+        time -= config.script[i].duration;
+    }
+    return &config.script[config.script_count - 1].point;
+}
+
+static void create_gaze_data(TobiiResearchEyeTracker* eyetracker, TobiiResearchGazeData* gaze_data,
+    int64_t time, int64_t start_time) {
+    TobiiResearchDisplayArea display_area;
+    tobii_research_get_display_area(eyetracker, &display_area);
+    const TobiiResearchNormalizedPoint2D* target = get_script_point(time - start_time);
+
+    memset(gaze_data, 0, sizeof(*gaze_data));
+    gaze_data->system_time_stamp = time;
+    gaze_data->device_time_stamp = time - start_time;
+
+    int valid = random_uniform(eyetracker) * 100.0f >= config.invalid;
+    TobiiResearchEyeData* eyes[] = { &gaze_data->left_eye, &gaze_data->right_eye };
+    for (size_t i = 0; i < 2; ++i) {
+        TobiiResearchEyeData* eye = eyes[i];
+        eye->gaze_origin.position_in_user_coordinates.x = i ? EYE_OFFSET : -EYE_OFFSET;
+        eye->gaze_origin.position_in_user_coordinates.y = display_area.bottom_left.y + display_area.height / 2.0f;
+        eye->gaze_origin.position_in_user_coordinates.z = EYE_DISTANCE;
+        eye->gaze_origin.position_in_track_box_coordinates.x = 0.5f;
+        eye->gaze_origin.position_in_track_box_coordinates.y = 0.5f;
+        eye->gaze_origin.position_in_track_box_coordinates.z = 0.5f;
+        eye->gaze_origin.validity = TOBII_RESEARCH_VALIDITY_VALID;
+        eye->pupil_data.diameter = 3.0f;
+        eye->pupil_data.validity = TOBII_RESEARCH_VALIDITY_VALID;
+
+        TobiiResearchNormalizedPoint2D point = *target;
+        point.x += config.noise * (2.0f * random_uniform(eyetracker) - 1.0f) / display_area.width;
+        point.y += config.noise * (2.0f * random_uniform(eyetracker) - 1.0f) / display_area.height;
+        TobiiResearchPoint3D* position = &eye->gaze_point.position_in_user_coordinates;
+        position->x = display_area.top_left.x + point.x * (display_area.top_right.x - display_area.top_left.x) +
+            point.y * (display_area.bottom_left.x - display_area.top_left.x);
+        position->y = display_area.top_left.y + point.x * (display_area.top_right.y - display_area.top_left.y) +
+            point.y * (display_area.bottom_left.y - display_area.top_left.y);
+        position->z = display_area.top_left.z + point.x * (display_area.top_right.z - display_area.top_left.z) +
+            point.y * (display_area.bottom_left.z - display_area.top_left.z);
+        eye->gaze_point.position_on_display_area = point;
+        eye->gaze_point.validity = valid ? TOBII_RESEARCH_VALIDITY_VALID : TOBII_RESEARCH_VALIDITY_INVALID;
+    }
+}
+
+static void* gaze_data_thread(void* argument) {
+    TobiiResearchEyeTracker* eyetracker = (TobiiResearchEyeTracker*)argument;
+    int64_t period = 1000000 / config.rate;
+    int64_t start_time = now_us();
+    int64_t time = start_time;
+
+    for (;;) {
+        time += period;
+        int64_t jitter = config.jitter > 0 ? (int64_t)(random_uniform(eyetracker) * config.jitter) : 0;
+        sleep_until_us(time + jitter);
+
+        TobiiResearchGazeData gaze_data;
+        create_gaze_data(eyetracker, &gaze_data, time, start_time);
+
+        pthread_mutex_lock(&eyetracker->mutex);
+        if (!eyetracker->running) {
+            pthread_mutex_unlock(&eyetracker->mutex);
+            break;
+        }
+        for (size_t i = 0; i < eyetracker->subscriptions_count; ++i) {
+            /* Each subscriber gets its own copy, like from the SDK. */
+            TobiiResearchGazeData copy = gaze_data;
+            eyetracker->subscriptions[i].callback(&copy, eyetracker->subscriptions[i].user_data);
+        }
+        pthread_mutex_unlock(&eyetracker->mutex);
+    }
+    return NULL;
+}
+
+TobiiResearchStatus tobii_research_get_eyetracker(const char* address, TobiiResearchEyeTracker** eyetracker) {
+    pthread_once(&config_once, read_config);
+    if (!address || !eyetracker) {
+        return TOBII_RESEARCH_STATUS_SE_INTERNAL;
+    }
+
+    pthread_mutex_lock(&eyetrackers_mutex);
+    TobiiResearchEyeTracker* instance = eyetrackers;
+    while (instance && strcmp(instance->address, address) != 0) {
+        instance = instance->next;
+    }
+    if (!instance) {
+        instance = malloc(sizeof(*instance));
+        instance->address = malloc(strlen(address) + 1);
+        strcpy(instance->address, address);
+        pthread_mutex_init(&instance->mutex, NULL);
+        instance->subscriptions_count = 0;
+        instance->running = 0;
+        instance->random_state = 1;
+        for (const char* c = address; *c; ++c) {
+            instance->random_state = instance->random_state * 31 + (unsigned char)*c;
+        }
+        instance->next = eyetrackers;
+        eyetrackers = instance;
+    }
+    pthread_mutex_unlock(&eyetrackers_mutex);
+
+    *eyetracker = instance;
+    return TOBII_RESEARCH_STATUS_OK;
+}
+
+TobiiResearchStatus tobii_research_get_system_time_stamp(int64_t* time_stamp_us) {
+    *time_stamp_us = now_us();
+    return TOBII_RESEARCH_STATUS_OK;
+}
+
+TobiiResearchStatus tobii_research_get_display_area(TobiiResearchEyeTracker* eyetracker,
+    TobiiResearchDisplayArea* display_area) {
+    (void)eyetracker;
+    /* A 24" 16:9 display right above the eye tracker. */
+    display_area->width = 531.0f;
+    display_area->height = 299.0f;
+    display_area->top_left.x = -265.5f;
+    display_area->top_left.y = 319.0f;
+    display_area->top_left.z = 20.0f;
+    display_area->top_right = display_area->top_left;
+    display_area->top_right.x = 265.5f;
+    display_area->bottom_left = display_area->top_left;
+    display_area->bottom_left.y = 20.0f;
+    display_area->bottom_right = display_area->bottom_left;
+    display_area->bottom_right.x = 265.5f;
+    return TOBII_RESEARCH_STATUS_OK;
+}
+
+TobiiResearchStatus tobii_research_subscribe_to_display_area(TobiiResearchEyeTracker* eyetracker,
+    tobii_research_display_area_callback callback, void* user_data) {
+    (void)user_data;
+    /* The display area never changes, so there is nothing to notify. */
+    if (!eyetracker || !callback) {
+        return TOBII_RESEARCH_STATUS_SE_INTERNAL;
+    }
+    return TOBII_RESEARCH_STATUS_OK;
+}
+
+TobiiResearchStatus tobii_research_unsubscribe_from_display_area(TobiiResearchEyeTracker* eyetracker,
+    tobii_research_display_area_callback callback) {
+    (void)callback;
+    if (!eyetracker) {
+        return TOBII_RESEARCH_STATUS_SE_INTERNAL;
+    }
+    return TOBII_RESEARCH_STATUS_OK;
+}
+
+TobiiResearchStatus tobii_research_subscribe_to_gaze_data(TobiiResearchEyeTracker* eyetracker,
+    tobii_research_gaze_data_callback callback, void* user_data) {
+    if (!eyetracker || !callback) {
+        return TOBII_RESEARCH_STATUS_SE_INTERNAL;
+    }
+
+    TobiiResearchStatus status = TOBII_RESEARCH_STATUS_OK;
+    pthread_mutex_lock(&eyetracker->mutex);
+    if (eyetracker->subscriptions_count < MAX_SUBSCRIPTIONS) {
+        Subscription* subscription = &eyetracker->subscriptions[eyetracker->subscriptions_count++];
+        subscription->callback = callback;
+        subscription->user_data = user_data;
+        if (!eyetracker->running) {
+            eyetracker->running = 1;
+            pthread_create(&eyetracker->thread, NULL, gaze_data_thread, eyetracker);
+        }
+    } else {
+        status = TOBII_RESEARCH_STATUS_SE_INTERNAL;
+    }
+    pthread_mutex_unlock(&eyetracker->mutex);
+    return status;
+}
+
+TobiiResearchStatus tobii_research_unsubscribe_from_gaze_data(TobiiResearchEyeTracker* eyetracker,
+    tobii_research_gaze_data_callback callback) {
+    if (!eyetracker) {
+        return TOBII_RESEARCH_STATUS_SE_INTERNAL;
+    }
+
+    /* Holding the mutex also waits for a callback in progress to return. */
+    int stop = 0;
+    pthread_mutex_lock(&eyetracker->mutex);
+    size_t count = 0;
+    for (size_t i = 0; i < eyetracker->subscriptions_count; ++i) {
+        if (eyetracker->subscriptions[i].callback != callback) {
+            eyetracker->subscriptions[count++] = eyetracker->subscriptions[i];
+        }
+    }
+    eyetracker->subscriptions_count = count;
+    if (count == 0 && eyetracker->running) {
+        eyetracker->running = 0;
+        stop = 1;
+    }
+    pthread_mutex_unlock(&eyetracker->mutex);
+
+    if (stop) {
+        pthread_join(eyetracker->thread, NULL);
+    }
+    return TOBII_RESEARCH_STATUS_OK;
+}
@@ -0,0 +1,153 @@
+/*
+Copyright 2019 Tobii Pro AB
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "order_statistics.h"
+
+#include <math.h>
+#include <stdlib.h>
+
+/* Scales the median absolute deviation of normally distributed values to their standard deviation. */
+#define MAD_NORMAL_SCALE (1.4826f)
+
+/* Below this size the remaining range is simply insertion sorted. */
+#define SELECT_SORT_THRESHOLD (16)
+
+static void swap(float* a, float* b) {
+    float tmp = *a;
+    *a = *b;
+    *b = tmp;
+}
+
+static int compare_floats(const void* a, const void* b) {
+    float x = *(const float*)a;
+    float y = *(const float*)b;
+    return (x > y) - (x < y);
+}
+
+static void insertion_sort(float* values, size_t count) {
+    for (size_t i = 1; i < count; ++i) {
+        float value = values[i];
+        size_t j = i;
+        for (; j > 0 && values[j - 1] > value; --j) {
+            values[j] = values[j - 1];
+        }
+        values[j] = value;
+    }
+}
+
+static float max_of(const float* values, size_t count) {
+    float max = values[0];
+    for (size_t i = 1; i < count; ++i) {
+        if (values[i] > max) {
+            max = values[i];
+        }
+    }
+    return max;
+}
+
+float order_statistics_select(float* values, size_t count, size_t k) {
+    /* Introselect: quickselect with a median of three pivot, which falls back to sorting the remaining range if
+     * the partitions keep being unbalanced. */
+    size_t first = 0;
+    size_t last = count - 1;
+    int depth_limit = 0;
+    for (size_t n = count; n > 1; n >>= 1) {
+        depth_limit += 2;
+    }
+
+    while (last - first + 1 > SELECT_SORT_THRESHOLD) {
+        if (depth_limit-- == 0) {
+            qsort(values + first, last - first + 1, sizeof(*values), compare_floats);
+            return values[k];
+        }
+
+        /* Order first, middle and last, the median ends up as pivot at last - 1 and the other two as sentinels. */
+        size_t middle = first + (last - first) / 2;
+        if (values[middle] < values[first]) {
+            swap(&values[middle], &values[first]);
+        }
+        if (values[last] < values[first]) {
+            swap(&values[last], &values[first]);
+        }
+        if (values[last] < values[middle]) {
+            swap(&values[last], &values[middle]);
+        }
+        swap(&values[middle], &values[last - 1]);
+        float pivot = values[last - 1];
+
+        size_t i = first;
+        size_t j = last - 1;
+        for (;;) {
+            while (values[++i] < pivot) {
+            }
+            while (pivot < values[--j]) {
+            }
+            if (i >= j) {
+                break;
+            }
+            swap(&values[i], &values[j]);
+        }
+        swap(&values[i], &values[last - 1]);
+
+        /* The pivot is in place at i. */
+        if (k == i) {
+            return values[k];
+        } else if (k < i) {
+            last = i - 1;
+        } else {
+            first = i + 1;
+        }
+    }
+
+    insertion_sort(values + first, last - first + 1);
+    return values[k];
+}
+
+float order_statistics_median(float* values, size_t count) {
+    float upper = order_statistics_select(values, count, count / 2);
+    if (count % 2) {
+        return upper;
+    }
+    /* The lower middle value is the largest one before the upper. */
+    return 0.5f * (max_of(values, count / 2) + upper);
+}
+
+float order_statistics_mad(float* values, size_t count) {
+    float median = order_statistics_median(values, count);
+    for (size_t i = 0; i < count; ++i) {
+        values[i] = fabsf(values[i] - median);
+    }
+    return MAD_NORMAL_SCALE * order_statistics_median(values, count);
+}
+
+float order_statistics_trimmed_mean(float* values, size_t count, float trim) {
+    size_t trimmed = (size_t)(trim * count);
+    if (2 * trimmed >= count) {
+        return order_statistics_median(values, count);
+    }
+
+    /* After the two selections the kept values are exactly those from index trimmed to count - trimmed - 1. */
+    size_t last = count - trimmed - 1;
+    if (trimmed > 0) {
+        order_statistics_select(values, count, trimmed);
+        order_statistics_select(values + trimmed, count - trimmed, last - trimmed);
+    }
+    double sum = 0.0;
+    for (size_t i = trimmed; i <= last; ++i) {
+        sum += values[i];
+    }
+    return (float)(sum / (last - trimmed + 1));
+}
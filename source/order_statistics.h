@@ -0,0 +1,46 @@
+/*
+Copyright 2019 Tobii Pro AB
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef ORDER_STATISTICS_H_
+#define ORDER_STATISTICS_H_
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Robust statistics of an array of values, found by selection instead of sorting. They take linear time on
+ * average, and O(n log n) in the worst case. All of them reorder the values, of which there must be at least one. */
+
+/* Reorders the values so that the k:th smallest is at index k, with no larger values before it and no smaller
+ * values after it, and returns it. */
+extern float order_statistics_select(float* values, size_t count, size_t k);
+
+extern float order_statistics_median(float* values, size_t count);
+
+/* Median absolute deviation from the median, scaled to estimate the standard deviation of normally distributed
+ * values. */
+extern float order_statistics_mad(float* values, size_t count);
+
+/* Mean of the values left after removing the fraction trim, at most 0.5, of the values at each end. */
+extern float order_statistics_trimmed_mean(float* values, size_t count, float trim);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* ORDER_STATISTICS_H_ */
@@ -0,0 +1,127 @@
+/*
+Copyright 2019 Tobii Pro AB
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "point_index.h"
+
+#include <stdlib.h>
+
+#include "vectormath.h"
+
+/* Open addressing with linear probing. The table is kept at most half full and removal shifts the following
+ * entries back instead of leaving tombstones, so probe sequences stay short however many points come and go. */
+
+typedef struct {
+    TobiiResearchNormalizedPoint2D point;
+    /* POINT_INDEX_NOT_FOUND for an empty slot. */
+    size_t index;
+} PointIndexEntry;
+
+struct PointIndex {
+    PointIndexEntry* entries;
+    size_t mask;
+    size_t count;
+};
+
+static PointIndexEntry* allocate_entries(size_t slots) {
+    PointIndexEntry* entries = malloc(slots * sizeof(*entries));
+    for (size_t i = 0; i < slots; ++i) {
+        entries[i].index = POINT_INDEX_NOT_FOUND;
+    }
+    return entries;
+}
+
+static size_t find_slot(const PointIndex* instance, const TobiiResearchNormalizedPoint2D* point) {
+    size_t slot = point2_hash(point) & instance->mask;
+    while (instance->entries[slot].index != POINT_INDEX_NOT_FOUND &&
+           !point2_equal(&instance->entries[slot].point, point)) {
+        slot = (slot + 1) & instance->mask;
+    }
+    return slot;
+}
+
+PointIndex* point_index_init(size_t capacity) {
+    PointIndex* instance = malloc(sizeof(*instance));
+    instance->entries = NULL;
+    instance->mask = 0;
+    instance->count = 0;
+    point_index_reserve(instance, capacity);
+    return instance;
+}
+
+void point_index_destroy(PointIndex* instance) {
+    if (instance) {
+        free(instance->entries);
+        free(instance);
+    }
+}
+
+void point_index_reserve(PointIndex* instance, size_t count) {
+    size_t slots = 8;
+    while (slots < 2 * count) {
+        slots <<= 1;
+    }
+    if (instance->entries && slots <= instance->mask + 1) {
+        return;
+    }
+
+    PointIndex grown;
+    grown.entries = allocate_entries(slots);
+    grown.mask = slots - 1;
+    grown.count = instance->count;
+    for (size_t i = 0; instance->entries && i <= instance->mask; ++i) {
+        if (instance->entries[i].index != POINT_INDEX_NOT_FOUND) {
+            grown.entries[find_slot(&grown, &instance->entries[i].point)] = instance->entries[i];
+        }
+    }
+    free(instance->entries);
+    *instance = grown;
+}
+
+size_t point_index_find(const PointIndex* instance, const TobiiResearchNormalizedPoint2D* point) {
+    return instance->entries[find_slot(instance, point)].index;
+}
+
+void point_index_insert(PointIndex* instance, const TobiiResearchNormalizedPoint2D* point, size_t index) {
+    PointIndexEntry* entry = &instance->entries[find_slot(instance, point)];
+    if (entry->index == POINT_INDEX_NOT_FOUND) {
+        if (2 * (instance->count + 1) > instance->mask + 1) {
+            point_index_reserve(instance, instance->count + 1);
+            entry = &instance->entries[find_slot(instance, point)];
+        }
+        entry->point = *point;
+        instance->count++;
+    }
+    entry->index = index;
+}
+
+void point_index_remove(PointIndex* instance, const TobiiResearchNormalizedPoint2D* point) {
+    size_t hole = find_slot(instance, point);
+    if (instance->entries[hole].index == POINT_INDEX_NOT_FOUND) {
+        return;
+    }
+
+    /* Move back every following entry of the cluster whose home slot is not between the hole and itself. */
+    for (size_t slot = (hole + 1) & instance->mask; instance->entries[slot].index != POINT_INDEX_NOT_FOUND;
+         slot = (slot + 1) & instance->mask) {
+        size_t home = point2_hash(&instance->entries[slot].point) & instance->mask;
+        if (((slot - home) & instance->mask) >= ((slot - hole) & instance->mask)) {
+            instance->entries[hole] = instance->entries[slot];
+            hole = slot;
+        }
+    }
+    instance->entries[hole].index = POINT_INDEX_NOT_FOUND;
+    instance->count--;
+}
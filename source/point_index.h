@@ -0,0 +1,52 @@
+/*
+Copyright 2019 Tobii Pro AB
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef POINT_INDEX_H_
+#define POINT_INDEX_H_
+
+#include <stddef.h>
+
+#include "tobii_research.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Hash map from screen points to array indices, using point2_equal to compare points. Lookup, insertion and
+ * removal take constant time on average. */
+
+#define POINT_INDEX_NOT_FOUND ((size_t)-1)
+
+typedef struct PointIndex PointIndex;
+
+extern PointIndex* point_index_init(size_t capacity);
+extern void point_index_destroy(PointIndex* instance);
+
+/* Makes room for count points, so that inserting up to that many points will not allocate. */
+extern void point_index_reserve(PointIndex* instance, size_t count);
+
+/* Returns the index stored for the point or POINT_INDEX_NOT_FOUND. */
+extern size_t point_index_find(const PointIndex* instance, const TobiiResearchNormalizedPoint2D* point);
+
+/* Stores the index for the point, replacing any index already stored for it. */
+extern void point_index_insert(PointIndex* instance, const TobiiResearchNormalizedPoint2D* point, size_t index);
+extern void point_index_remove(PointIndex* instance, const TobiiResearchNormalizedPoint2D* point);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* POINT_INDEX_H_ */
@@ -3,18 +3,6 @@
 
 #include "screen_based_calibration_validation.h"
 
-#if defined(_WIN32) || defined(_WIN64)
-#include <windows.h>
-static void sleep_ms(int time) {
-    Sleep(time);
-}
-#else
-#include <unistd.h>
-static void sleep_ms(int time) {
-    usleep(time * 1000);
-}
-#endif
-
 int main(int argc, char *argv[]) {
     if (argc != 2) {
         printf("Usage: sample <eyetracker address>\n");
@@ -72,9 +60,16 @@ int main(int argc, char *argv[]) {
             exit(1);
         }
 
-        /* Wait until enough gaze data is collected. */
-        while (tobii_research_screen_based_calibration_validation_is_collecting_data(validator)) {
-            sleep_ms(100);
+        /* Wait until enough gaze data is collected, or the data collection times out. */
+        CalibrationValidationCollectionResult collection_result;
+        status = tobii_research_screen_based_calibration_validation_wait_for_data_collection(
+            validator, -1, &collection_result);
+        if (status != CALIBRATION_VALIDATION_STATUS_OK) {
+            printf("Unknown error!\n");
+            exit(1);
+        }
+        if (collection_result == CALIBRATION_VALIDATION_COLLECTION_RESULT_TIMED_OUT) {
+            printf("Timed out before enough gaze data was collected.\n");
         }
     }
 
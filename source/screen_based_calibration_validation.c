@@ -14,14 +14,42 @@ See the License for the specific language governing permissions and
 limitations under the License.
 */
 
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <math.h>
 
+#if defined(_WIN32) || defined(_WIN64)
+#include <windows.h>
+static void sleep_ms(long time) {
+    Sleep((DWORD)time);
+}
+#else
+#include <time.h>
+static void sleep_ms(long time) {
+    struct timespec duration;
+    duration.tv_sec = time / 1000;
+    duration.tv_nsec = (time % 1000) * 1000000;
+    nanosleep(&duration, NULL);
+}
+#endif
+
 #include "screen_based_calibration_validation.h"
 #include "vectormath.h"
+#include "eye_statistics.h"
 #include "stopwatch.h"
+#include "gaze_data_ring.h"
+#include "point_index.h"
+#include "event.h"
+#include "gaze_recording.h"
+#include "atomics.h"
+#include "worker_pool.h"
+#include "validation_stats.h"
+#include "trace.h"
+#include "order_statistics.h"
+#include "drift_monitor.h"
+#include "export_writer.h"
 
 #define SAMPLE_COUNT_MIN (10)
 #define SAMPLE_COUNT_DEFAULT (30)
@@ -29,6 +57,20 @@ limitations under the License.
 #define TIMEOUT_MIN (100)
 #define TIMEOUT_DEFAULT (1000)
 #define TIMEOUT_MAX (3000)
+#define COMPUTE_THREADS_MAX (64)
+#define TRIM_PERCENTAGE_DEFAULT (10)
+#define TRIM_PERCENTAGE_MAX (49)
+#define MONITOR_WINDOW_DEFAULT (600)
+#define EXPORT_MAGIC "TVEX"
+#define EXPORT_VERSION (1)
+/* How long after the timeout the application thread ends a data collection itself, in case the gaze data callback
+ * does not since no gaze data sample is received after the timeout. Covers the delay before gaze data is received
+ * and the time between samples. */
+#define TIMEOUT_MARGIN (100)
+
+/* Enough to hold every sample of a single data collection with the longest timeout at 1200 Hz. The gaze data
+ * callback waits at the current point of a plan while the ring is full, see handle_gaze_data. */
+#define GAZE_DATA_RING_CAPACITY (4096)
 
 typedef enum {
     CALIBRATION_VALIDATION_STATE_IDLE,
@@ -36,46 +78,282 @@ typedef enum {
     CALIBRATION_VALIDATION_STATE_COLLECTING_DATA,
 } CalibrationValidationState;
 
+/* Gaze samples are stored in blocks of sample_count samples. A collected point owns a chain of blocks, one per
+ * data collection for its stimuli point. Blocks are recycled through a per-validator free list so that
+ * processing gaze data never has to allocate.
+ *
+ * Only the fields needed by the metrics are kept, as separate contiguous arrays. Complete gaze data samples
+ * are kept as well if CALIBRATION_VALIDATION_OPTION_RETAIN_GAZE_DATA is enabled. */
+typedef struct SampleBlock SampleBlock;
+struct SampleBlock {
+    SampleBlock* next;
+    size_t count;
+    size_t capacity;
+    Point3Arrays gaze_origin_left;
+    Point3Arrays gaze_point_left;
+    Point3Arrays gaze_origin_right;
+    Point3Arrays gaze_point_right;
+    int64_t* device_time_stamp;
+    int64_t* system_time_stamp;
+    /* NULL unless gaze data is retained. */
+    TobiiResearchGazeData* gaze_data;
+};
+
+/* Keep the arrays following the block header suitably aligned. */
+#define SAMPLE_BLOCK_HEADER_SIZE ((sizeof(SampleBlock) + 15) & ~(size_t)15)
+#define SAMPLE_BLOCK_STRIDE(sample_count) (((sample_count) + 7) & ~(size_t)7)
+
 typedef struct {
     TobiiResearchNormalizedPoint2D screen_point;
-    TobiiResearchGazeData** gaze_data;
+    SampleBlock* first_block;
+    SampleBlock* last_block;
     size_t gaze_data_count;
+    /* Set when discarded, the slot is reclaimed by compact_collected_data. */
+    int discarded;
+
+    /* Only updated when online statistics are enabled. */
+    EyeStatistics left_eye_statistics;
+    EyeStatistics right_eye_statistics;
+
+    /* The stimuli point in user coordinates, calculated when the data collection starts from the display area as
+     * of display_area_sequence. */
+    TobiiResearchPoint3D stimuli_point;
+    size_t display_area_sequence;
+
+    /* Statistics of the point as of the last compute, without gaze data. Set when samples have been added since,
+     * so that compute only has to calculate the points that changed. */
+    CalibrationValidationPoint computed_point;
+    int dirty;
 } CollectedDataPoint;
 
+/* Memory calculate_point_statistics works in. Grown to the most samples of a point computed so far and kept, so
+ * that computing does not allocate once it has been used for points of that size. */
+typedef struct {
+    float* values;
+    size_t capacity;
+} ComputeScratch;
+
+/* Shared by the jobs computing the dirty points of a result. Each job computes a contiguous share of them with
+ * scratch memory of its own. */
+typedef struct {
+    CalibrationValidator* validator;
+    const size_t* dirty_indices;
+    size_t dirty_count;
+    size_t job_count;
+} ComputeContext;
+
+/* What compute hands out is a single block: the result, its points and, when gaze data is copied, the gaze data
+ * of all points in point order. Destroying it is a single free. */
+#define RESULT_ALIGN(size) (((size) + 15) & ~(size_t)15)
+#define RESULT_POINTS_OFFSET RESULT_ALIGN(sizeof(CalibrationValidationResult))
+
+/* A point of the plan as read by the gaze data callback. */
+typedef struct {
+    size_t index;
+    CalibrationValidationPlanPoint point;
+    /* The point after it, if there is one. */
+    int has_next;
+    CalibrationValidationPlanPoint next_point;
+    int64_t plan_start_time_stamp;
+} CallbackPlanPoint;
+
+/* The gaze data callback pushes samples into gaze_data_ring and ends the data collection by clearing
+ * active_collection_id once it has seen enough valid samples or the timeout has passed. Apart from the callback_
+ * fields, everything else is owned by the application thread, which processes the queued samples in
+ * process_gaze_data. */
 struct CalibrationValidator {
     TobiiResearchEyeTracker* eyetracker;
     CalibrationValidationState state;
+    /* Cached while in validation mode so that no request to the eye tracker is needed for it, kept up to date by
+     * display_area_callback. The sequence changes with every update. */
+    volatile size_t display_area_sequence;
+    TobiiResearchDisplayArea display_area;
     size_t sample_count;
     int timeout;
+    int online_statistics;
+    int retain_gaze_data;
+    CalibrationValidationResultGazeData result_gaze_data;
+    /* Same order as CalibrationValidationAngleKernel. */
+    Vector3AngleKernel angle_kernel;
+    int compute_threads;
+    /* Computes the points of a result if compute_threads is more than one, otherwise NULL. */
+    WorkerPool* compute_worker_pool;
+    /* One for each of compute_threads. */
+    ComputeScratch* compute_scratch;
+    CalibrationValidationTiming timing;
+    int robust_statistics;
+    int trim_percentage;
+
+    /* Samples queued by the gaze data callback, tagged with the data collection they were received for. */
+    GazeDataRing* gaze_data_ring;
+    /* Id of the ongoing data collection or zero if not collecting. */
+    volatile size_t active_collection_id;
+    size_t last_collection_id;
+
+    /* Stimulus plan of the ongoing data collection, a single data collection is a plan of one point. Point i of
+     * the plan is collected with collection id plan_first_collection_id + i, the gaze data callback moves on to
+     * the next point by itself. Written under plan_sequence before the first collection id is published and not
+     * changed during data collection, the gaze data callback reads it with read_plan_point. */
+    volatile size_t plan_sequence;
+    CalibrationValidationPlanPoint* plan_points;
+    size_t plan_points_count;
+    size_t plan_points_capacity;
+    size_t plan_first_collection_id;
+    /* System time stamp data collection for the first point of the plan starts at, after its settle time. */
+    int64_t plan_start_time_stamp;
+    /* plan_points only grows while in validation mode. A gaze data callback late for a data collection that already
+     * ended may still read the arrays it outgrew, they are freed once the callback queues a sample for the new plan
+     * or no more gaze data is received. */
+    CalibrationValidationPlanPoint** retired_plan_points;
+    size_t retired_plan_points_count;
+    /* Collection id of the point collected into new_point and of the last point to collect, which is an earlier
+     * one if the plan is stopped. */
+    size_t collection_id;
+    size_t plan_last_collection_id;
+    /* Collection id of the point timed by stopwatch, in case no gaze data arrives to end it, and whether gaze data
+     * was received for it when the stopwatch was started. */
+    size_t timed_collection_id;
+    int timed_collection_received;
+
+    /* Start of the trace span of the ongoing data collection. */
+    int64_t collection_trace_start;
+
+    /* Progress of the data collection as seen by the gaze data callback. callback_collection_id is set when the
+     * first sample is received for a data collection, the application thread reads it to tell whether any was. */
+    volatile size_t callback_collection_id;
+    size_t callback_sample_count;
+    Stopwatch* callback_stopwatch;
+    /* System time stamp data collection for the current point starts at if it is not the first of the plan, set
+     * by the gaze data callback when it moves on to the point. */
+    int64_t callback_start_time_stamp;
+
+    /* Notified when a data collection ends. The callback is only changed when not collecting data. */
+    CalibrationValidationCollectionCallback collection_callback;
+    void* collection_callback_user_data;
+    /* Notified when a plan moves on to a point, only changed when not collecting data. */
+    CalibrationValidationTargetCallback target_callback;
+    void* target_callback_user_data;
+    Event* collection_event;
+    /* How the last data collection ended, ONGOING if there was none. */
+    CalibrationValidationCollectionResult collection_result;
 
     /* Temporary data for current data collection */
-    CollectedDataPoint *new_point;
+    CollectedDataPoint new_point;
 
-    /* Stored data for successfully collected data points */
-    CollectedDataPoint **collected_points;
+    /* Stored data for successfully collected data points, in collection order. Discarded points are only
+     * marked as such, so that discarding does not have to move the following points. */
+    CollectedDataPoint *collected_points;
     size_t collected_points_count;
     size_t collected_points_capacity;
+    size_t discarded_points_count;
+    /* Maps the screen point of each collected point that is not discarded to its index in collected_points. */
+    PointIndex* collected_points_index;
+
+    /* Unused sample blocks, ready to be handed out to new data points */
+    SampleBlock* free_blocks;
+
+    /* Set while recording, every sample received by the gaze data callback is added. */
+    GazeRecorder* recorder;
+    /* Set for validators replaying a recording instead of subscribing to gaze data from an eye tracker. */
+    GazeRecording* replay_recording;
+
+    /* Fed by the gaze data callback while monitoring, its result can be read from any thread. */
+    DriftMonitor* monitor;
+    size_t monitor_window;
+
+    /* Updated by both the gaze data callback and the application thread. */
+    ValidationStats* stats;
+    /* Whether the durations of the gaze data callback and of compute are measured for the histograms. */
+    int duration_histograms;
+    /* Times a single gaze data callback, only used by the callback. */
+    Stopwatch* callback_duration_stopwatch;
 
     Stopwatch* stopwatch;
+    Stopwatch* wait_stopwatch;
+    Stopwatch* compute_stopwatch;
 };
 
 
-static void gaze_data_callback(TobiiResearchGazeData* gaze_data, void* user_data);
+static void init_validator(CalibrationValidator* validator, size_t sample_count, int timeout);
+static TobiiResearchStatus get_display_area(CalibrationValidator* validator, TobiiResearchDisplayArea* display_area);
+static size_t read_display_area(CalibrationValidator* validator, TobiiResearchDisplayArea* display_area);
+static void end_replayed_data_collection(CalibrationValidator* validator);
+static int is_timed_by_time_stamps(const CalibrationValidator* validator);
+static int64_t collection_timeout(const CalibrationValidator* validator);
+static CalibrationValidationStatus start_collecting_data(CalibrationValidator* validator,
+    const CalibrationValidationPlanPoint* points, size_t points_count, int is_plan, const int64_t* system_time_stamp);
 
-static CollectedDataPoint* create_data_point(CalibrationValidator* validator,
+static void gaze_data_callback(TobiiResearchGazeData* gaze_data, void* user_data);
+static void display_area_callback(TobiiResearchDisplayArea* display_area, void* user_data);
+static void handle_gaze_data(CalibrationValidator* validator, const TobiiResearchGazeData* gaze_data);
+static int read_plan_point(CalibrationValidator* validator, size_t collection_id, CallbackPlanPoint* plan_point);
+static int is_valid_sample(const TobiiResearchGazeData* gaze_data);
+static int end_data_collection(CalibrationValidator* validator, size_t collection_id,
+    CalibrationValidationCollectionResult result);
+static void end_plan_point(CalibrationValidator* validator, size_t collection_id,
+    const CallbackPlanPoint* plan_point, CalibrationValidationCollectionResult result, int64_t system_time_stamp);
+static void stop_plan(CalibrationValidator* validator, size_t collection_id);
+static void process_gaze_data(CalibrationValidator* validator);
+static void store_plan_point(CalibrationValidator* validator);
+static void next_plan_point(CalibrationValidator* validator);
+static void stop_collecting_data(CalibrationValidator* validator);
+static void retire_plan_points(CalibrationValidator* validator);
+static void destroy_retired_plan_points(CalibrationValidator* validator);
+
+static SampleBlock* allocate_sample_block(CalibrationValidator* validator, size_t capacity);
+static SampleBlock* acquire_sample_block(CalibrationValidator* validator);
+static void release_sample_blocks(CalibrationValidator* validator, SampleBlock* first_block);
+static void destroy_free_sample_blocks(CalibrationValidator* validator);
+
+static void create_data_point(CalibrationValidator* validator, CollectedDataPoint* data_point,
     const TobiiResearchNormalizedPoint2D* screen_point);
-static void destroy_data_point(CollectedDataPoint* data_point);
+static void destroy_data_point(CalibrationValidator* validator, CollectedDataPoint* data_point);
+static void store_data_point_sample(CollectedDataPoint* data_point, const TobiiResearchGazeData* gaze_data);
+static void coalesce_data_point(CalibrationValidator* validator, CollectedDataPoint* data_point);
+static int has_gaze_data(const CollectedDataPoint* data_point);
+static void set_point_gaze_data(CalibrationValidator* validator, CalibrationValidationPoint* point,
+    CollectedDataPoint* data_point, TobiiResearchGazeData** gaze_data_copy);
 
 static void init_collected_data(CalibrationValidator* validator);
-static void extend_collected_data(CalibrationValidator* validator);
+static void reserve_collected_data(CalibrationValidator* validator);
 static void store_collected_data(CalibrationValidator* validator);
+static void compact_collected_data(CalibrationValidator* validator);
 static void destroy_collected_data(CalibrationValidator* validator);
 
-static float calculate_eye_accuracy(TobiiResearchPoint3D* gaze_origin_mean,
-    TobiiResearchPoint3D* gaze_point_mean, TobiiResearchPoint3D* stimuli_point);
-static float calculate_eye_precision(TobiiResearchVector3D* direction_gaze_point_all,
-    TobiiResearchVector3D* direction_gaze_point_mean_all, size_t vector_count);
-static float calculate_eye_precision_rms(TobiiResearchVector3D* direction_gaze_point_all, size_t vector_count);
+static void update_computed_points(CalibrationValidator* validator);
+static void calculate_averages(const CalibrationValidator* validator, CalibrationValidationResult* result);
+static void export_binary(const CalibrationValidator* validator, ExportWriter* writer,
+    const CalibrationValidationResult* averages, int include_samples);
+static void export_json(const CalibrationValidator* validator, ExportWriter* writer,
+    const CalibrationValidationResult* averages, int include_samples);
+static void compute_points(CalibrationValidator* validator, const size_t* dirty_indices, size_t dirty_count,
+    ComputeScratch* scratch);
+static void compute_points_job(void* context, size_t index);
+static void compute_point(const CalibrationValidator* validator, const CollectedDataPoint* collected_data_point,
+    CalibrationValidationPoint* point, ComputeScratch* scratch);
+static ComputeScratch* create_compute_scratch(int count);
+static void destroy_compute_scratch(ComputeScratch* scratch, int count);
+static void calculate_point_statistics(const CollectedDataPoint* collected_data_point,
+    const TobiiResearchPoint3D* stimuli_point, Vector3AngleKernel kernel, int robust_statistics, float trim,
+    ComputeScratch* scratch, CalibrationValidationPoint* point);
+static void clear_point_robust_statistics(CalibrationValidationPoint* point);
+static void calculate_point_statistics_online(const CollectedDataPoint* collected_data_point,
+    const TobiiResearchPoint3D* stimuli_point, Vector3AngleKernel kernel, CalibrationValidationPoint* point);
+static float calculate_eye_accuracy(const TobiiResearchPoint3D* gaze_origin_mean,
+    const TobiiResearchPoint3D* gaze_point_mean, const TobiiResearchPoint3D* stimuli_point, Vector3AngleKernel kernel);
+static void create_directions(Point3Arrays* direction_gaze_point_all, Point3Arrays* direction_gaze_point_mean_all,
+    size_t offset, const Point3Arrays* gaze_origin, const Point3Arrays* gaze_point,
+    const TobiiResearchPoint3D* gaze_point_mean, size_t count);
+static void create_target_directions(Point3Arrays* direction_target_all, size_t offset,
+    const Point3Arrays* gaze_origin, const TobiiResearchPoint3D* stimuli_point, size_t count);
+static float calculate_eye_precision(const Point3Arrays* direction_gaze_point_all,
+    const Point3Arrays* direction_gaze_point_mean_all, size_t vector_count, Vector3AngleKernel kernel, float* angles);
+static float calculate_eye_precision_rms(const Point3Arrays* direction_gaze_point_all, size_t vector_count,
+    Vector3AngleKernel kernel, float* angles);
+static void calculate_eye_accuracy_robust(const Point3Arrays* direction_gaze_point_all,
+    Point3Arrays* direction_target_all, size_t vector_count, Vector3AngleKernel kernel, float trim, float* angles,
+    float* accuracy_median, float* accuracy_trimmed);
+static float calculate_eye_precision_rms_trimmed(size_t vector_count, float trim, float* angles);
 
 
 CalibrationValidationStatus tobii_research_screen_based_calibration_validation_init(
@@ -98,16 +376,29 @@ CalibrationValidationStatus tobii_research_screen_based_calibration_validation_i
         return CALIBRATION_VALIDATION_STATUS_INTERNAL_ERROR;
     }
 
-    (*validator)->sample_count = sample_count;
-    (*validator)->timeout = timeout;
-    (*validator)->state = CALIBRATION_VALIDATION_STATE_IDLE;
+    init_validator(*validator, sample_count, timeout);
+
+    return CALIBRATION_VALIDATION_STATUS_OK;
+}
+
+CalibrationValidationStatus tobii_research_screen_based_calibration_validation_init_replay(
+    const char* path, size_t sample_count, int timeout, CalibrationValidator** validator) {
+    if (!(sample_count >= SAMPLE_COUNT_MIN && sample_count <= SAMPLE_COUNT_MAX)) {
+        return CALIBRATION_VALIDATION_STATUS_INVALID_SAMPLE_COUNT;
+    }
+    if (!(timeout >= TIMEOUT_MIN && timeout <= TIMEOUT_MAX)) {
+        return CALIBRATION_VALIDATION_STATUS_INVALID_TIMEOUT;
+    }
 
-    (*validator)->new_point = NULL;
-    (*validator)->collected_points = NULL;
-    (*validator)->collected_points_capacity = 0;
-    (*validator)->collected_points_count = 0;
+    GazeRecording* recording = gaze_recording_open(path);
+    if (!recording) {
+        return CALIBRATION_VALIDATION_STATUS_INVALID_RECORDING;
+    }
 
-    (*validator)->stopwatch = stopwatch_init();
+    *validator = malloc(sizeof(CalibrationValidator));
+    (*validator)->eyetracker = NULL;
+    init_validator(*validator, sample_count, timeout);
+    (*validator)->replay_recording = recording;
 
     return CALIBRATION_VALIDATION_STATUS_OK;
 }
@@ -120,21 +411,37 @@ CalibrationValidationStatus tobii_research_screen_based_calibration_validation_i
 
 CalibrationValidationStatus tobii_research_screen_based_calibration_validation_destroy(
     CalibrationValidator* validator) {
+    process_gaze_data(validator);
     if (validator->state == CALIBRATION_VALIDATION_STATE_COLLECTING_DATA) {
         return CALIBRATION_VALIDATION_STATUS_OPERATION_NOT_ALLOWED_DURING_DATA_COLLECTION;
     }
 
-    if (validator->state == CALIBRATION_VALIDATION_STATE_CALIBRATION_MODE) {
+    if (validator->state == CALIBRATION_VALIDATION_STATE_CALIBRATION_MODE && !validator->replay_recording) {
         TobiiResearchStatus status = tobii_research_unsubscribe_from_gaze_data(
             validator->eyetracker, gaze_data_callback);
         if (status != TOBII_RESEARCH_STATUS_OK)
             return CALIBRATION_VALIDATION_STATUS_INTERNAL_ERROR;
+        tobii_research_unsubscribe_from_display_area(validator->eyetracker, display_area_callback);
     }
 
-    destroy_data_point(validator->new_point);
-    validator->new_point = NULL;
+    destroy_data_point(validator, &validator->new_point);
     destroy_collected_data(validator);
+    destroy_free_sample_blocks(validator);
+    gaze_data_ring_destroy(validator->gaze_data_ring);
+    event_destroy(validator->collection_event);
+    gaze_recorder_destroy(validator->recorder);
+    gaze_recording_close(validator->replay_recording);
+    worker_pool_destroy(validator->compute_worker_pool);
+    destroy_compute_scratch(validator->compute_scratch, validator->compute_threads);
+    drift_monitor_destroy(validator->monitor);
+    validation_stats_destroy(validator->stats);
+    destroy_retired_plan_points(validator);
+    free(validator->plan_points);
+    free(validator->callback_stopwatch);
+    free(validator->callback_duration_stopwatch);
     free(validator->stopwatch);
+    free(validator->wait_stopwatch);
+    free(validator->compute_stopwatch);
     free(validator);
 
     return CALIBRATION_VALIDATION_STATUS_OK;
@@ -145,76 +452,170 @@ CalibrationValidationStatus tobii_research_screen_based_calibration_validation_e
     if (validator->state != CALIBRATION_VALIDATION_STATE_IDLE) {
         return CALIBRATION_VALIDATION_STATUS_ALREADY_IN_VALIDATION_MODE;
     }
+    int64_t trace_start = TRACE_NOW();
 
-    TobiiResearchStatus status = tobii_research_subscribe_to_gaze_data(
-        validator->eyetracker, gaze_data_callback, validator);
-    if (status != TOBII_RESEARCH_STATUS_OK) {
-        return CALIBRATION_VALIDATION_STATUS_INTERNAL_ERROR;
+    if (validator->replay_recording) {
+        validator->display_area = *gaze_recording_display_area(validator->replay_recording);
+    } else {
+        /* Nothing else writes the cached display area until subscribed. */
+        TobiiResearchStatus status = tobii_research_get_display_area(validator->eyetracker, &validator->display_area);
+        if (status != TOBII_RESEARCH_STATUS_OK) {
+            return CALIBRATION_VALIDATION_STATUS_INTERNAL_ERROR;
+        }
+        status = tobii_research_subscribe_to_display_area(validator->eyetracker, display_area_callback, validator);
+        if (status != TOBII_RESEARCH_STATUS_OK) {
+            return CALIBRATION_VALIDATION_STATUS_INTERNAL_ERROR;
+        }
+        status = tobii_research_subscribe_to_gaze_data(validator->eyetracker, gaze_data_callback, validator);
+        if (status != TOBII_RESEARCH_STATUS_OK) {
+            tobii_research_unsubscribe_from_display_area(validator->eyetracker, display_area_callback);
+            return CALIBRATION_VALIDATION_STATUS_INTERNAL_ERROR;
+        }
     }
 
     init_collected_data(validator);
 
+    /* Have a sample block ready for the first data collection. */
+    release_sample_blocks(validator, acquire_sample_block(validator));
+    validator->collection_result = CALIBRATION_VALIDATION_COLLECTION_RESULT_ONGOING;
+
     validator->state = CALIBRATION_VALIDATION_STATE_CALIBRATION_MODE;
+    TRACE_SPAN("enter_validation_mode", trace_start);
 
     return CALIBRATION_VALIDATION_STATUS_OK;
 }
 
 CalibrationValidationStatus tobii_research_screen_based_calibration_validation_leave_validation_mode(
     CalibrationValidator* validator) {
+    process_gaze_data(validator);
     if (validator->state == CALIBRATION_VALIDATION_STATE_COLLECTING_DATA) {
         return CALIBRATION_VALIDATION_STATUS_OPERATION_NOT_ALLOWED_DURING_DATA_COLLECTION;
     } else if (validator->state == CALIBRATION_VALIDATION_STATE_IDLE) {
         return CALIBRATION_VALIDATION_STATUS_NOT_IN_VALIDATION_MODE;
     }
+    int64_t trace_start = TRACE_NOW();
 
-    TobiiResearchStatus status = tobii_research_unsubscribe_from_gaze_data(
-        validator->eyetracker, gaze_data_callback);
-    if (status != TOBII_RESEARCH_STATUS_OK) {
-        return CALIBRATION_VALIDATION_STATUS_INTERNAL_ERROR;
+    if (!validator->replay_recording) {
+        TobiiResearchStatus status = tobii_research_unsubscribe_from_gaze_data(
+            validator->eyetracker, gaze_data_callback);
+        if (status != TOBII_RESEARCH_STATUS_OK) {
+            return CALIBRATION_VALIDATION_STATUS_INTERNAL_ERROR;
+        }
+        tobii_research_unsubscribe_from_display_area(validator->eyetracker, display_area_callback);
     }
 
-    destroy_data_point(validator->new_point);
-    validator->new_point = NULL;
+    destroy_data_point(validator, &validator->new_point);
     destroy_collected_data(validator);
+    destroy_free_sample_blocks(validator);
+    destroy_retired_plan_points(validator);
+    drift_monitor_set_target(validator->monitor, NULL, NULL, validator->angle_kernel);
 
     validator->state = CALIBRATION_VALIDATION_STATE_IDLE;
+    TRACE_SPAN("leave_validation_mode", trace_start);
 
     return CALIBRATION_VALIDATION_STATUS_OK;
 }
 
 CalibrationValidationStatus tobii_research_screen_based_calibration_validation_start_collecting_data(
     CalibrationValidator* validator, const TobiiResearchNormalizedPoint2D* screen_point) {
+    process_gaze_data(validator);
+    CalibrationValidationPlanPoint point;
+    point.screen_point = *screen_point;
+    point.settle_time = 0;
+    return start_collecting_data(validator, &point, 1, 0, NULL);
+}
+
+CalibrationValidationStatus tobii_research_screen_based_calibration_validation_start_plan(
+    CalibrationValidator* validator, const CalibrationValidationPlanPoint* points, size_t points_count) {
+    process_gaze_data(validator);
+    return start_collecting_data(validator, points, points_count, 1, NULL);
+}
+
+static CalibrationValidationStatus start_collecting_data(CalibrationValidator* validator,
+    const CalibrationValidationPlanPoint* points, size_t points_count, int is_plan, const int64_t* system_time_stamp) {
     if (validator->state == CALIBRATION_VALIDATION_STATE_IDLE) {
         return CALIBRATION_VALIDATION_STATUS_NOT_IN_VALIDATION_MODE;
     } else if (validator->state == CALIBRATION_VALIDATION_STATE_COLLECTING_DATA) {
         return CALIBRATION_VALIDATION_STATUS_OPERATION_NOT_ALLOWED_DURING_DATA_COLLECTION;
     }
 
-    if (!(screen_point->x >= 0.0f && screen_point->x <= 1.0f &&
-          screen_point->y >= 0.0f && screen_point->y <= 1.0f)) {
-        return CALIBRATION_VALIDATION_STATUS_INVALID_SCREEN_POINT;
+    if (points_count == 0) {
+        return CALIBRATION_VALIDATION_STATUS_INVALID_PLAN;
     }
+    for (size_t i = 0; i < points_count; ++i) {
+        const TobiiResearchNormalizedPoint2D* screen_point = &points[i].screen_point;
+        if (!(screen_point->x >= 0.0f && screen_point->x <= 1.0f &&
+              screen_point->y >= 0.0f && screen_point->y <= 1.0f)) {
+            return CALIBRATION_VALIDATION_STATUS_INVALID_SCREEN_POINT;
+        }
+        if (points[i].settle_time < 0 || points[i].settle_time > TIMEOUT_MAX) {
+            return CALIBRATION_VALIDATION_STATUS_INVALID_PLAN;
+        }
+    }
+
+    validator->collection_trace_start = TRACE_NOW();
 
-    destroy_data_point(validator->new_point);
-    validator->new_point = create_data_point(validator, screen_point);
+    int64_t start_time_stamp = 0;
+    if (system_time_stamp) {
+        start_time_stamp = *system_time_stamp;
+    } else if (validator->recorder || validator->timing == CALIBRATION_VALIDATION_TIMING_TIME_STAMPS ||
+        points[0].settle_time > 0) {
+        tobii_research_get_system_time_stamp(&start_time_stamp);
+    }
+    start_time_stamp += points[0].settle_time * (int64_t)1000;
+
+    /* A gaze data callback late for the last data collection may read the plan while it is written. */
+    seqlock_write_begin(&validator->plan_sequence);
+    if (points_count > validator->plan_points_capacity) {
+        retire_plan_points(validator);
+        size_t capacity = validator->plan_points_capacity * 2;
+        if (capacity < points_count) {
+            capacity = points_count;
+        }
+        validator->plan_points = malloc(capacity * sizeof(*validator->plan_points));
+        validator->plan_points_capacity = capacity;
+    }
+    memcpy(validator->plan_points, points, points_count * sizeof(*points));
+    validator->plan_points_count = points_count;
+    validator->plan_first_collection_id = validator->last_collection_id + 1;
+    validator->plan_start_time_stamp = start_time_stamp;
+    seqlock_write_end(&validator->plan_sequence);
+
+    validator->last_collection_id += points_count;
+    validator->collection_id = validator->plan_first_collection_id;
+    validator->plan_last_collection_id = validator->last_collection_id;
+    validator->timed_collection_id = validator->plan_first_collection_id;
+    validator->timed_collection_received = 0;
+
+    /* Make sure that storing the new point will not need to allocate memory while processing gaze data. */
+    reserve_collected_data(validator);
+    destroy_data_point(validator, &validator->new_point);
+    create_data_point(validator, &validator->new_point, &points[0].screen_point);
+    if (validator->recorder) {
+        gaze_recorder_add_stimulus(validator->recorder, &points[0].screen_point, start_time_stamp);
+    }
+    if (is_plan && validator->target_callback) {
+        validator->target_callback(0, &points[0].screen_point, validator->target_callback_user_data);
+    }
     stopwatch_reset(validator->stopwatch);
     stopwatch_start(validator->stopwatch);
 
     validator->state = CALIBRATION_VALIDATION_STATE_COLLECTING_DATA;
+    atomic_store_release(&validator->active_collection_id, validator->plan_first_collection_id);
 
     return CALIBRATION_VALIDATION_STATUS_OK;
 }
 
 CalibrationValidationStatus tobii_research_screen_based_calibration_validation_clear_collected_data(
     CalibrationValidator* validator) {
-    if (validator->state == CALIBRATION_VALIDATION_STATE_COLLECTING_DATA) {
-        return CALIBRATION_VALIDATION_STATUS_OPERATION_NOT_ALLOWED_DURING_DATA_COLLECTION;
-    }
+    process_gaze_data(validator);
 
-    destroy_data_point(validator->new_point);
-    validator->new_point = NULL;
+    /* The point being collected is left to be stored when its data collection ends. */
+    if (validator->state != CALIBRATION_VALIDATION_STATE_COLLECTING_DATA) {
+        destroy_data_point(validator, &validator->new_point);
+    }
     destroy_collected_data(validator);
-    if (validator->state == CALIBRATION_VALIDATION_STATE_CALIBRATION_MODE) {
+    if (validator->state != CALIBRATION_VALIDATION_STATE_IDLE) {
         init_collected_data(validator);
     }
 
@@ -223,31 +624,22 @@ CalibrationValidationStatus tobii_research_screen_based_calibration_validation_c
 
 CalibrationValidationStatus tobii_research_screen_based_calibration_validation_discard_collected_data(
     CalibrationValidator* validator, const TobiiResearchNormalizedPoint2D* screen_point) {
+    process_gaze_data(validator);
     if (validator->state == CALIBRATION_VALIDATION_STATE_IDLE) {
         return CALIBRATION_VALIDATION_STATUS_NOT_IN_VALIDATION_MODE;
     }
-    if (validator->state == CALIBRATION_VALIDATION_STATE_COLLECTING_DATA) {
-        return CALIBRATION_VALIDATION_STATUS_OPERATION_NOT_ALLOWED_DURING_DATA_COLLECTION;
-    }
 
-    /* Check if data for stimuli point already is collected. */
-    CollectedDataPoint* data_point = NULL;
-    size_t idx;
-    for (idx = 0; idx < validator->collected_points_count; ++idx) {
-        if (point2_equal(screen_point, &validator->collected_points[idx]->screen_point)) {
-            data_point = validator->collected_points[idx];
-            break;
-        }
-    }
+    /* Check if data for stimuli point already is collected. The point being collected, if the same, is not
+     * stored yet and is left alone. */
+    size_t idx = point_index_find(validator->collected_points_index, screen_point);
+    if (idx != POINT_INDEX_NOT_FOUND) {
+        CollectedDataPoint* data_point = &validator->collected_points[idx];
+        destroy_data_point(validator, data_point);
 
-    if (data_point) {
         /* Remove data point from collected data. */
-        for (size_t i = idx + 1; i < validator->collected_points_count; ++i) {
-            validator->collected_points[i - 1] = validator->collected_points[i];
-        }
-        validator->collected_points_count--;
-
-        destroy_data_point(data_point);
+        point_index_remove(validator->collected_points_index, screen_point);
+        data_point->discarded = 1;
+        validator->discarded_points_count++;
     }
 
     return CALIBRATION_VALIDATION_STATUS_OK;
@@ -255,208 +647,250 @@ CalibrationValidationStatus tobii_research_screen_based_calibration_validation_d
 
 CalibrationValidationStatus tobii_research_screen_based_calibration_validation_compute(
     CalibrationValidator* validator, CalibrationValidationResult** result) {
-    if (validator->state == CALIBRATION_VALIDATION_STATE_COLLECTING_DATA) {
-        return CALIBRATION_VALIDATION_STATUS_OPERATION_NOT_ALLOWED_DURING_DATA_COLLECTION;
-    }
+    /* During data collection the gaze data callback only queues samples, the points are stored and computed on
+     * this thread. The result thus holds the points stored as of here, without the one being collected. */
+    process_gaze_data(validator);
+    compact_collected_data(validator);
     if (validator->collected_points_count == 0) {
         return CALIBRATION_VALIDATION_STATUS_NO_DATA_COLLECTED;
     }
+    if (validator->duration_histograms) {
+        stopwatch_reset(validator->compute_stopwatch);
+        stopwatch_start(validator->compute_stopwatch);
+    }
+    int64_t trace_start = TRACE_NOW();
+    int64_t trace_phase_start = trace_start;
+
+    update_computed_points(validator);
+    TRACE_SPAN("compute_points", trace_phase_start);
+    trace_phase_start = TRACE_NOW();
+
+    /* Size the block up front from the gaze data to copy. */
+    size_t points_count = validator->collected_points_count;
+    size_t gaze_data_offset = RESULT_ALIGN(RESULT_POINTS_OFFSET + points_count * sizeof(CalibrationValidationPoint));
+    size_t gaze_data_count = 0;
+    for (size_t i = 0; validator->result_gaze_data == CALIBRATION_VALIDATION_RESULT_GAZE_DATA_COPY &&
+        i < points_count; ++i) {
+        if (has_gaze_data(&validator->collected_points[i])) {
+            gaze_data_count += validator->collected_points[i].gaze_data_count;
+        }
+    }
+    size_t size = gaze_data_offset + gaze_data_count * sizeof(TobiiResearchGazeData);
+    char* block = malloc(size);
+    CalibrationValidationResult* result_tmp = (CalibrationValidationResult*)block;
+    CalibrationValidationPoint* points = (CalibrationValidationPoint*)(block + RESULT_POINTS_OFFSET);
+    TobiiResearchGazeData* gaze_data_copy = (TobiiResearchGazeData*)(block + gaze_data_offset);
+    for (size_t i = 0; i < points_count; ++i) {
+        points[i] = validator->collected_points[i].computed_point;
+        set_point_gaze_data(validator, &points[i], &validator->collected_points[i], &gaze_data_copy);
+    }
+    calculate_averages(validator, result_tmp);
+    result_tmp->points = points;
+    result_tmp->points_count = points_count;
+    result_tmp->size = size;
+    *result = result_tmp;
 
-    TobiiResearchDisplayArea display_area;
-    TobiiResearchStatus status = tobii_research_get_display_area(validator->eyetracker, &display_area);
-    if (status != TOBII_RESEARCH_STATUS_OK) {
-        return CALIBRATION_VALIDATION_STATUS_INTERNAL_ERROR;
+    TRACE_SPAN("compute_result", trace_phase_start);
+
+    validation_stats_count(validator->stats, VALIDATION_STATS_COMPUTES);
+    if (validator->duration_histograms) {
+        validation_stats_add_duration(validator->stats, VALIDATION_STATS_COMPUTE_DURATION,
+            stopwatch_elapsed_ns(validator->compute_stopwatch));
     }
+    TRACE_SPAN("compute", trace_start);
 
-    CalibrationValidationPoint* points = malloc(validator->collected_points_count * sizeof(*points));
-    float accuracy_left_eye_average = 0.0f;
-    float accuracy_right_eye_average = 0.0f;
-    float precision_left_eye_average = 0.0f;
-    float precision_right_eye_average = 0.0f;
-    float precision_rms_left_eye_average = 0.0f;
-    float precision_rms_right_eye_average = 0.0f;
+    return CALIBRATION_VALIDATION_STATUS_OK;
+}
 
-    int valid_points_count = 0;
+void tobii_research_screen_based_calibration_validation_destroy_result(
+    CalibrationValidationResult* result) {
+    if (result) {
+        int64_t trace_start = TRACE_NOW();
+        free(result);
+        TRACE_SPAN("destroy_result", trace_start);
+    }
+}
 
-    for (size_t i = 0; i < validator->collected_points_count; ++i) {
-        CollectedDataPoint* collected_data_point = validator->collected_points[i];
-
-        if (collected_data_point->gaze_data_count < validator->sample_count) {
-            /* Timeout before collecting enough valid samples, no calculations to be done. */
-            points[i].accuracy_left_eye = NAN;
-            points[i].accuracy_right_eye = NAN;
-            points[i].precision_left_eye = NAN;
-            points[i].precision_right_eye = NAN;
-            points[i].precision_rms_left_eye = NAN;
-            points[i].precision_rms_right_eye = NAN;
-            points[i].timed_out = 1;
-            points[i].screen_point = collected_data_point->screen_point;
-            points[i].gaze_data = malloc(collected_data_point->gaze_data_count * sizeof(TobiiResearchGazeData));
-            for (size_t j = 0; j < collected_data_point->gaze_data_count; ++j) {
-                memcpy(&points[i].gaze_data[j], collected_data_point->gaze_data[j], sizeof(TobiiResearchGazeData));
-            }
-            points[i].gaze_data_count = collected_data_point->gaze_data_count;
-            continue;
+void tobii_research_screen_based_calibration_validation_relocate_result(
+    CalibrationValidationResult* result) {
+    if (!result) {
+        return;
+    }
+    /* The points still refer into the block copied from, which tells where it was. Gaze data outside of it is a
+     * view into the validator and stays as it is. */
+    uintptr_t from = (uintptr_t)result->points - RESULT_POINTS_OFFSET;
+    char* to = (char*)result;
+    result->points = (CalibrationValidationPoint*)(to + RESULT_POINTS_OFFSET);
+    for (size_t i = 0; i < result->points_count; ++i) {
+        uintptr_t gaze_data = (uintptr_t)result->points[i].gaze_data;
+        if (gaze_data && gaze_data >= from && gaze_data < from + result->size) {
+            result->points[i].gaze_data = (TobiiResearchGazeData*)(to + (gaze_data - from));
         }
+    }
+}
 
-        TobiiResearchPoint3D stimuli_point;
-        calculate_normalized_point2_to_point3(&stimuli_point, &display_area, &collected_data_point->screen_point);
-
-        /* Calculate mean points */
-        TobiiResearchPoint3D gaze_origin_left_mean;
-        point3_set_zero(&gaze_origin_left_mean);
-        TobiiResearchPoint3D gaze_origin_right_mean;
-        point3_set_zero(&gaze_origin_right_mean);
-        TobiiResearchPoint3D gaze_point_left_mean;
-        point3_set_zero(&gaze_point_left_mean);
-        TobiiResearchPoint3D gaze_point_right_mean;
-        point3_set_zero(&gaze_point_right_mean);
-
-        for (size_t j = 0; j < collected_data_point->gaze_data_count; ++j) {
-            TobiiResearchGazeData* gaze_data = collected_data_point->gaze_data[j];
-
-            point3_add(&gaze_origin_left_mean, &gaze_data->left_eye.gaze_origin.position_in_user_coordinates);
-            point3_add(&gaze_origin_right_mean, &gaze_data->right_eye.gaze_origin.position_in_user_coordinates);
-            point3_add(&gaze_point_left_mean, &gaze_data->left_eye.gaze_point.position_in_user_coordinates);
-            point3_add(&gaze_point_right_mean, &gaze_data->right_eye.gaze_point.position_in_user_coordinates);
-        }
-        float denominator_factor = 1.0f / collected_data_point->gaze_data_count;
-        point3_mul(&gaze_origin_left_mean, denominator_factor);
-        point3_mul(&gaze_origin_right_mean, denominator_factor);
-        point3_mul(&gaze_point_left_mean, denominator_factor);
-        point3_mul(&gaze_point_right_mean, denominator_factor);
-
-        /* Calculate gaze vectors needed for validation statistics */
-        TobiiResearchVector3D *direction_gaze_point_left_all = malloc(
-            collected_data_point->gaze_data_count * sizeof(*direction_gaze_point_left_all));
-        vector3_set_zero(direction_gaze_point_left_all);
-        TobiiResearchVector3D *direction_gaze_point_left_mean_all = malloc(
-            collected_data_point->gaze_data_count * sizeof(*direction_gaze_point_left_mean_all));
-        vector3_set_zero(direction_gaze_point_left_mean_all);
-        TobiiResearchVector3D *direction_gaze_point_right_all = malloc(
-            collected_data_point->gaze_data_count * sizeof(*direction_gaze_point_right_all));
-        vector3_set_zero(direction_gaze_point_right_all);
-        TobiiResearchVector3D *direction_gaze_point_right_mean_all = malloc(
-            collected_data_point->gaze_data_count * sizeof(*direction_gaze_point_right_mean_all));
-        vector3_set_zero(direction_gaze_point_right_mean_all);
-
-        for (size_t j = 0; j < collected_data_point->gaze_data_count; ++j) {
-            TobiiResearchGazeData* gaze_data = collected_data_point->gaze_data[j];
-
-            vector3_create_from_points(&direction_gaze_point_left_all[j],
-                &gaze_data->left_eye.gaze_origin.position_in_user_coordinates,
-                &gaze_data->left_eye.gaze_point.position_in_user_coordinates);
-            vector3_normalize(&direction_gaze_point_left_all[j]);
-
-            vector3_create_from_points(&direction_gaze_point_left_mean_all[j],
-                &gaze_data->left_eye.gaze_origin.position_in_user_coordinates,
-                &gaze_point_left_mean);
-            vector3_normalize(&direction_gaze_point_left_mean_all[j]);
-
-            vector3_create_from_points(&direction_gaze_point_right_all[j],
-                &gaze_data->right_eye.gaze_origin.position_in_user_coordinates,
-                &gaze_data->right_eye.gaze_point.position_in_user_coordinates);
-            vector3_normalize(&direction_gaze_point_right_all[j]);
-
-            vector3_create_from_points(&direction_gaze_point_right_mean_all[j],
-                &gaze_data->right_eye.gaze_origin.position_in_user_coordinates,
-                &gaze_point_right_mean);
-            vector3_normalize(&direction_gaze_point_right_mean_all[j]);
-        }
-
-        /* Accuracy calculations */
-        float accuracy_left_eye = calculate_eye_accuracy(
-            &gaze_origin_left_mean, &gaze_point_left_mean, &stimuli_point);
-        float accuracy_right_eye = calculate_eye_accuracy(
-            &gaze_origin_right_mean, &gaze_point_right_mean, &stimuli_point);
-
-        /* Precision calculations */
-        float precision_left_eye = calculate_eye_precision(
-            direction_gaze_point_left_all, direction_gaze_point_left_mean_all,
-            collected_data_point->gaze_data_count);
-        float precision_right_eye = calculate_eye_precision(
-            direction_gaze_point_right_all, direction_gaze_point_right_mean_all,
-            collected_data_point->gaze_data_count);
-
-        /* RMS precision calculations */
-        float precision_rms_left_eye = calculate_eye_precision_rms(
-            direction_gaze_point_left_all, collected_data_point->gaze_data_count);
-        float precision_rms_right_eye = calculate_eye_precision_rms(
-            direction_gaze_point_right_all, collected_data_point->gaze_data_count);
-
-        free(direction_gaze_point_left_all);
-        free(direction_gaze_point_left_mean_all);
-        free(direction_gaze_point_right_all);
-        free(direction_gaze_point_right_mean_all);
-
-        /* Prepare calibration validation point */
-        points[i].accuracy_left_eye = accuracy_left_eye;
-        points[i].accuracy_right_eye = accuracy_right_eye;
-        points[i].precision_left_eye = precision_left_eye;
-        points[i].precision_right_eye = precision_right_eye;
-        points[i].precision_rms_left_eye = precision_rms_left_eye;
-        points[i].precision_rms_right_eye = precision_rms_right_eye;
-        points[i].timed_out = 0;
-        points[i].screen_point = collected_data_point->screen_point;
-        points[i].gaze_data = malloc(collected_data_point->gaze_data_count * sizeof(TobiiResearchGazeData));
-        for (size_t j = 0; j < collected_data_point->gaze_data_count; ++j) {
-            memcpy(&points[i].gaze_data[j], collected_data_point->gaze_data[j], sizeof(TobiiResearchGazeData));
-        }
-        points[i].gaze_data_count = collected_data_point->gaze_data_count;
+CalibrationValidationStatus tobii_research_screen_based_calibration_validation_export(
+    CalibrationValidator* validator, CalibrationValidationExportFormat format, int include_samples,
+    CalibrationValidationExportSink sink, void* user_data) {
+    process_gaze_data(validator);
+    if ((format != CALIBRATION_VALIDATION_EXPORT_FORMAT_BINARY &&
+        format != CALIBRATION_VALIDATION_EXPORT_FORMAT_JSON) || !sink) {
+        return CALIBRATION_VALIDATION_STATUS_INVALID_EXPORT;
+    }
+    compact_collected_data(validator);
+    if (validator->collected_points_count == 0) {
+        return CALIBRATION_VALIDATION_STATUS_NO_DATA_COLLECTED;
+    }
+    int64_t trace_start = TRACE_NOW();
 
-        /* Ackumulate values for average calculation */
-        accuracy_left_eye_average += accuracy_left_eye;
-        accuracy_right_eye_average += accuracy_right_eye;
-        precision_left_eye_average += precision_left_eye;
-        precision_right_eye_average += precision_right_eye;
-        precision_rms_left_eye_average += precision_rms_left_eye;
-        precision_rms_right_eye_average += precision_rms_right_eye;
+    update_computed_points(validator);
+    CalibrationValidationResult averages;
+    calculate_averages(validator, &averages);
 
-        valid_points_count++;
+    ExportWriter* writer = export_writer_init(sink, user_data);
+    if (format == CALIBRATION_VALIDATION_EXPORT_FORMAT_BINARY) {
+        export_binary(validator, writer, &averages, include_samples);
+    } else {
+        export_json(validator, writer, &averages, include_samples);
     }
+    int succeeded = export_writer_destroy(writer);
+    TRACE_SPAN("export", trace_start);
 
-    if (valid_points_count > 0) {
-        accuracy_left_eye_average /= valid_points_count;
-        accuracy_right_eye_average /= valid_points_count;
-        precision_left_eye_average /= valid_points_count;
-        precision_right_eye_average /= valid_points_count;
-        precision_rms_left_eye_average /= valid_points_count;
-        precision_rms_right_eye_average /= valid_points_count;
-    } else {
-        accuracy_left_eye_average = NAN;
-        accuracy_right_eye_average = NAN;
-        precision_left_eye_average = NAN;
-        precision_right_eye_average = NAN;
-        precision_rms_left_eye_average = NAN;
-        precision_rms_right_eye_average = NAN;
+    return succeeded ? CALIBRATION_VALIDATION_STATUS_OK : CALIBRATION_VALIDATION_STATUS_INVALID_EXPORT;
+}
+
+CalibrationValidationStatus tobii_research_screen_based_calibration_validation_set_option(
+    CalibrationValidator* validator, CalibrationValidationOption option, int value) {
+    if (validator->state != CALIBRATION_VALIDATION_STATE_IDLE) {
+        return CALIBRATION_VALIDATION_STATUS_ALREADY_IN_VALIDATION_MODE;
     }
 
-    CalibrationValidationResult* result_tmp = malloc(sizeof(*result_tmp));
-    result_tmp->average_accuracy_left = accuracy_left_eye_average;
-    result_tmp->average_accuracy_right = accuracy_right_eye_average;
-    result_tmp->average_precision_left = precision_left_eye_average;
-    result_tmp->average_precision_right = precision_right_eye_average;
-    result_tmp->average_precision_rms_left = precision_rms_left_eye_average;
-    result_tmp->average_precision_rms_right = precision_rms_right_eye_average;
-    result_tmp->points = points;
-    result_tmp->points_count = validator->collected_points_count;
-    *result = result_tmp;
+    switch (option) {
+        case CALIBRATION_VALIDATION_OPTION_ONLINE_STATISTICS:
+            validator->online_statistics = value != 0;
+            return CALIBRATION_VALIDATION_STATUS_OK;
 
-    return CALIBRATION_VALIDATION_STATUS_OK;
-}
+        case CALIBRATION_VALIDATION_OPTION_RETAIN_GAZE_DATA:
+            validator->retain_gaze_data = value != 0;
+            return CALIBRATION_VALIDATION_STATUS_OK;
 
-void tobii_research_screen_based_calibration_validation_destroy_result(
-    CalibrationValidationResult* result) {
-    if (result) {
-        if (result->points_count) {
-            for (size_t i = 0; i < result->points_count; ++i) {
-                if (result->points[i].gaze_data_count) {
-                    free(result->points[i].gaze_data);
-                }
+        case CALIBRATION_VALIDATION_OPTION_RESULT_GAZE_DATA:
+            if (value != CALIBRATION_VALIDATION_RESULT_GAZE_DATA_COPY &&
+                value != CALIBRATION_VALIDATION_RESULT_GAZE_DATA_NONE &&
+                value != CALIBRATION_VALIDATION_RESULT_GAZE_DATA_VIEW) {
+                return CALIBRATION_VALIDATION_STATUS_INVALID_OPTION;
             }
-            free(result->points);
-        }
-        free(result);
+            validator->result_gaze_data = (CalibrationValidationResultGazeData)value;
+            return CALIBRATION_VALIDATION_STATUS_OK;
+
+        case CALIBRATION_VALIDATION_OPTION_COMPUTE_THREADS:
+            if (value < 1 || value > COMPUTE_THREADS_MAX) {
+                return CALIBRATION_VALIDATION_STATUS_INVALID_OPTION;
+            }
+            if (value != validator->compute_threads) {
+                worker_pool_destroy(validator->compute_worker_pool);
+                validator->compute_worker_pool = value > 1 ? worker_pool_init((size_t)value) : NULL;
+                destroy_compute_scratch(validator->compute_scratch, validator->compute_threads);
+                validator->compute_scratch = create_compute_scratch(value);
+                validator->compute_threads = value;
+            }
+            return CALIBRATION_VALIDATION_STATUS_OK;
+
+        case CALIBRATION_VALIDATION_OPTION_ANGLE_KERNEL:
+            if (value != CALIBRATION_VALIDATION_ANGLE_KERNEL_REFERENCE &&
+                value != CALIBRATION_VALIDATION_ANGLE_KERNEL_NORMALIZED &&
+                value != CALIBRATION_VALIDATION_ANGLE_KERNEL_ATAN2 &&
+                value != CALIBRATION_VALIDATION_ANGLE_KERNEL_FAST) {
+                return CALIBRATION_VALIDATION_STATUS_INVALID_OPTION;
+            }
+            validator->angle_kernel = (Vector3AngleKernel)value;
+            return CALIBRATION_VALIDATION_STATUS_OK;
+
+        case CALIBRATION_VALIDATION_OPTION_DURATION_HISTOGRAMS:
+            validator->duration_histograms = value != 0;
+            return CALIBRATION_VALIDATION_STATUS_OK;
+
+        case CALIBRATION_VALIDATION_OPTION_TIMING:
+            if (value != CALIBRATION_VALIDATION_TIMING_STOPWATCH &&
+                value != CALIBRATION_VALIDATION_TIMING_TIME_STAMPS) {
+                return CALIBRATION_VALIDATION_STATUS_INVALID_OPTION;
+            }
+            validator->timing = (CalibrationValidationTiming)value;
+            return CALIBRATION_VALIDATION_STATUS_OK;
+
+        case CALIBRATION_VALIDATION_OPTION_ROBUST_STATISTICS:
+            validator->robust_statistics = value != 0;
+            return CALIBRATION_VALIDATION_STATUS_OK;
+
+        case CALIBRATION_VALIDATION_OPTION_TRIM_PERCENTAGE:
+            if (value < 0 || value > TRIM_PERCENTAGE_MAX) {
+                return CALIBRATION_VALIDATION_STATUS_INVALID_OPTION;
+            }
+            validator->trim_percentage = value;
+            return CALIBRATION_VALIDATION_STATUS_OK;
+
+        case CALIBRATION_VALIDATION_OPTION_MONITOR_WINDOW:
+            if (value < SAMPLE_COUNT_MIN || value > SAMPLE_COUNT_MAX) {
+                return CALIBRATION_VALIDATION_STATUS_INVALID_OPTION;
+            }
+            if ((size_t)value != validator->monitor_window) {
+                /* Not subscribed to gaze data when idle, so the callback cannot be using the monitor. */
+                drift_monitor_destroy(validator->monitor);
+                validator->monitor = drift_monitor_init((size_t)value);
+                validator->monitor_window = (size_t)value;
+            }
+            return CALIBRATION_VALIDATION_STATUS_OK;
+
+        default:
+            return CALIBRATION_VALIDATION_STATUS_INVALID_OPTION;
+    }
+}
+
+CalibrationValidationStatus tobii_research_screen_based_calibration_validation_get_option(
+    CalibrationValidator* validator, CalibrationValidationOption option, int* value) {
+    switch (option) {
+        case CALIBRATION_VALIDATION_OPTION_ONLINE_STATISTICS:
+            *value = validator->online_statistics;
+            return CALIBRATION_VALIDATION_STATUS_OK;
+
+        case CALIBRATION_VALIDATION_OPTION_RETAIN_GAZE_DATA:
+            *value = validator->retain_gaze_data;
+            return CALIBRATION_VALIDATION_STATUS_OK;
+
+        case CALIBRATION_VALIDATION_OPTION_RESULT_GAZE_DATA:
+            *value = validator->result_gaze_data;
+            return CALIBRATION_VALIDATION_STATUS_OK;
+
+        case CALIBRATION_VALIDATION_OPTION_COMPUTE_THREADS:
+            *value = validator->compute_threads;
+            return CALIBRATION_VALIDATION_STATUS_OK;
+
+        case CALIBRATION_VALIDATION_OPTION_ANGLE_KERNEL:
+            *value = validator->angle_kernel;
+            return CALIBRATION_VALIDATION_STATUS_OK;
+
+        case CALIBRATION_VALIDATION_OPTION_DURATION_HISTOGRAMS:
+            *value = validator->duration_histograms;
+            return CALIBRATION_VALIDATION_STATUS_OK;
+
+        case CALIBRATION_VALIDATION_OPTION_TIMING:
+            *value = validator->timing;
+            return CALIBRATION_VALIDATION_STATUS_OK;
+
+        case CALIBRATION_VALIDATION_OPTION_ROBUST_STATISTICS:
+            *value = validator->robust_statistics;
+            return CALIBRATION_VALIDATION_STATUS_OK;
+
+        case CALIBRATION_VALIDATION_OPTION_TRIM_PERCENTAGE:
+            *value = validator->trim_percentage;
+            return CALIBRATION_VALIDATION_STATUS_OK;
+
+        case CALIBRATION_VALIDATION_OPTION_MONITOR_WINDOW:
+            *value = (int)validator->monitor_window;
+            return CALIBRATION_VALIDATION_STATUS_OK;
+
+        default:
+            return CALIBRATION_VALIDATION_STATUS_INVALID_OPTION;
     }
 }
 
@@ -467,153 +901,1431 @@ int tobii_research_screen_based_calibration_validation_is_validation_mode(
 
 int tobii_research_screen_based_calibration_validation_is_collecting_data(
     CalibrationValidator* validator) {
+    process_gaze_data(validator);
     return validator->state == CALIBRATION_VALIDATION_STATE_COLLECTING_DATA;
 }
 
-static void gaze_data_callback(TobiiResearchGazeData* gaze_data, void* user_data) {
-    CalibrationValidator* validator = (CalibrationValidator*)user_data;
-
-    switch (validator->state) {
-        case CALIBRATION_VALIDATION_STATE_IDLE:
-        case CALIBRATION_VALIDATION_STATE_CALIBRATION_MODE:
-            /* Do nothing */
-            break;
+CalibrationValidationStatus tobii_research_screen_based_calibration_validation_wait_for_data_collection(
+    CalibrationValidator* validator, int timeout, CalibrationValidationCollectionResult* result) {
+    process_gaze_data(validator);
+    if (validator->state == CALIBRATION_VALIDATION_STATE_IDLE) {
+        return CALIBRATION_VALIDATION_STATUS_NOT_IN_VALIDATION_MODE;
+    }
 
-        case CALIBRATION_VALIDATION_STATE_COLLECTING_DATA:
-            if (stopwatch_elapsed(validator->stopwatch) > validator->timeout) {
-                /* Data collecting stopped on timeout condition. */
-                store_collected_data(validator);
-                validator->state = CALIBRATION_VALIDATION_STATE_CALIBRATION_MODE;
-            } else if (validator->new_point->gaze_data_count < validator->sample_count) {
-                if (gaze_data->left_eye.gaze_point.validity == TOBII_RESEARCH_VALIDITY_VALID &&
-                    gaze_data->right_eye.gaze_point.validity == TOBII_RESEARCH_VALIDITY_VALID) {
-                    /* Store gaze data sample. */
-                    validator->new_point->gaze_data[validator->new_point->gaze_data_count] =
-                        malloc(sizeof(*gaze_data));
-                    memcpy(validator->new_point->gaze_data[validator->new_point->gaze_data_count],
-                        gaze_data, sizeof(*gaze_data));
-                    validator->new_point->gaze_data_count++;
-                }
-            } else {
-                /* Data collecting stopped on sample count condition. */
-                store_collected_data(validator);
-                validator->state = CALIBRATION_VALIDATION_STATE_CALIBRATION_MODE;
+    stopwatch_reset(validator->wait_stopwatch);
+    stopwatch_start(validator->wait_stopwatch);
+    while (validator->state == CALIBRATION_VALIDATION_STATE_COLLECTING_DATA) {
+        /* Wake up when the data collection times out, in case no gaze data is received to end it. */
+        long wait_time =
+            (long)((collection_timeout(validator) - stopwatch_elapsed_us(validator->stopwatch)) / 1000) + 1;
+        if (timeout >= 0) {
+            long remaining_time = timeout - stopwatch_elapsed(validator->wait_stopwatch);
+            if (remaining_time <= 0) {
+                *result = CALIBRATION_VALIDATION_COLLECTION_RESULT_ONGOING;
+                return CALIBRATION_VALIDATION_STATUS_OK;
             }
-            break;
+            if (remaining_time < wait_time) {
+                wait_time = remaining_time;
+            }
+        }
+        if (wait_time > 0) {
+            event_wait(validator->collection_event, wait_time);
+        }
+        process_gaze_data(validator);
+    }
 
-        default:
-            /* Should not happen */
-            break;
+    if (validator->collection_result == CALIBRATION_VALIDATION_COLLECTION_RESULT_ONGOING) {
+        return CALIBRATION_VALIDATION_STATUS_NO_DATA_COLLECTED;
     }
+    *result = validator->collection_result;
+    return CALIBRATION_VALIDATION_STATUS_OK;
 }
 
-static CollectedDataPoint* create_data_point(CalibrationValidator* validator,
-    const TobiiResearchNormalizedPoint2D* screen_point) {
-    CollectedDataPoint *data_point = malloc(sizeof(*data_point));
-    data_point->screen_point = *screen_point;
-    data_point->gaze_data = malloc(validator->sample_count * sizeof(*data_point->gaze_data));
-    data_point->gaze_data_count = 0;
-    return data_point;
+CalibrationValidationStatus tobii_research_screen_based_calibration_validation_set_collection_callback(
+    CalibrationValidator* validator, CalibrationValidationCollectionCallback callback, void* user_data) {
+    process_gaze_data(validator);
+    if (validator->state == CALIBRATION_VALIDATION_STATE_COLLECTING_DATA) {
+        return CALIBRATION_VALIDATION_STATUS_OPERATION_NOT_ALLOWED_DURING_DATA_COLLECTION;
+    }
+
+    validator->collection_callback = callback;
+    validator->collection_callback_user_data = user_data;
+
+    return CALIBRATION_VALIDATION_STATUS_OK;
 }
 
-static void destroy_data_point(CollectedDataPoint* data_point) {
-    if (data_point) {
-        for (size_t i = 0; i < data_point->gaze_data_count; ++i) {
-            free(data_point->gaze_data[i]);
-        }
-        free(data_point->gaze_data);
-        free(data_point);
+CalibrationValidationStatus tobii_research_screen_based_calibration_validation_set_target_callback(
+    CalibrationValidator* validator, CalibrationValidationTargetCallback callback, void* user_data) {
+    process_gaze_data(validator);
+    if (validator->state == CALIBRATION_VALIDATION_STATE_COLLECTING_DATA) {
+        return CALIBRATION_VALIDATION_STATUS_OPERATION_NOT_ALLOWED_DURING_DATA_COLLECTION;
     }
-}
 
-static void init_collected_data(CalibrationValidator* validator) {
-    validator->collected_points_capacity = 5;
-    validator->collected_points_count = 0;
-    validator->collected_points = malloc(validator->collected_points_capacity * sizeof(*validator->collected_points));
-}
+    validator->target_callback = callback;
+    validator->target_callback_user_data = user_data;
 
-static void extend_collected_data(CalibrationValidator* validator) {
-    validator->collected_points_capacity *= 2;
-    validator->collected_points = realloc(validator->collected_points,
-        validator->collected_points_capacity * sizeof(*validator->collected_points));
+    return CALIBRATION_VALIDATION_STATUS_OK;
 }
 
-static void store_collected_data(CalibrationValidator* validator) {
-    /* Check if data for stimuli point already is collected. */
-    CollectedDataPoint* data_point = NULL;
-    for (size_t i = 0; i < validator->collected_points_count; ++i) {
-        if (point2_equal(&validator->new_point->screen_point, &validator->collected_points[i]->screen_point)) {
-            data_point = validator->collected_points[i];
-            break;
-        }
+CalibrationValidationStatus tobii_research_screen_based_calibration_validation_start_recording(
+    CalibrationValidator* validator, const char* path) {
+    if (validator->state != CALIBRATION_VALIDATION_STATE_IDLE) {
+        return CALIBRATION_VALIDATION_STATUS_ALREADY_IN_VALIDATION_MODE;
     }
-    if (data_point) {
-        /* Stimuli point already collected, add more data. */
-        data_point->gaze_data = realloc(data_point->gaze_data,
-            (data_point->gaze_data_count + validator->new_point->gaze_data_count) * sizeof(*data_point->gaze_data));
-        for (size_t i = 0; i < validator->new_point->gaze_data_count; ++i) {
-            data_point->gaze_data[data_point->gaze_data_count + i] = validator->new_point->gaze_data[i];
-        }
-        data_point->gaze_data_count += validator->new_point->gaze_data_count;
-        validator->new_point->gaze_data_count = 0;
-        destroy_data_point(validator->new_point);
-        validator->new_point = NULL;
-    } else {
-        /* New stimuli point, store collected data. */
-        if (validator->collected_points_count >= validator->collected_points_capacity) {
-            extend_collected_data(validator);
-        }
-        validator->collected_points[validator->collected_points_count++] = validator->new_point;
-        validator->new_point = NULL;
+
+    TobiiResearchDisplayArea display_area;
+    if (get_display_area(validator, &display_area) != TOBII_RESEARCH_STATUS_OK) {
+        return CALIBRATION_VALIDATION_STATUS_INTERNAL_ERROR;
     }
-}
 
-static void destroy_collected_data(CalibrationValidator* validator) {
-    if (validator->collected_points_capacity > 0) {
-        for (size_t i = 0; i < validator->collected_points_count; ++i) {
-            for (size_t j = 0; j < validator->collected_points[i]->gaze_data_count; ++j) {
-                free(validator->collected_points[i]->gaze_data[j]);
-            }
-            free(validator->collected_points[i]->gaze_data);
-            free(validator->collected_points[i]);
-        }
-        free(validator->collected_points);
-        validator->collected_points = NULL;
-        validator->collected_points_capacity = 0;
-        validator->collected_points_count = 0;
+    GazeRecorder* recorder = gaze_recorder_init(path, &display_area);
+    if (!recorder) {
+        return CALIBRATION_VALIDATION_STATUS_INVALID_RECORDING;
     }
-}
+    gaze_recorder_destroy(validator->recorder);
+    validator->recorder = recorder;
 
-static float calculate_eye_accuracy(TobiiResearchPoint3D* gaze_origin_mean,
-    TobiiResearchPoint3D* gaze_point_mean, TobiiResearchPoint3D* stimuli_point) {
-    TobiiResearchVector3D direction_gaze_point;
-    TobiiResearchVector3D direction_target;
-    vector3_create_from_points(&direction_gaze_point, gaze_origin_mean, gaze_point_mean);
-    vector3_normalize(&direction_gaze_point);
-    vector3_create_from_points(&direction_target, gaze_origin_mean, stimuli_point);
-    vector3_normalize(&direction_target);
-    return vector3_angle(&direction_gaze_point, &direction_target);
+    return CALIBRATION_VALIDATION_STATUS_OK;
 }
 
-static float calculate_eye_precision(TobiiResearchVector3D* direction_gaze_point_all,
-    TobiiResearchVector3D* direction_gaze_point_mean_all, size_t vector_count) {
-    float variance = 0.0f;
-    for (size_t i = 0; i < vector_count; ++i) {
-        float angle = vector3_angle(&direction_gaze_point_all[i], &direction_gaze_point_mean_all[i]);
-        variance += angle*angle;
+CalibrationValidationStatus tobii_research_screen_based_calibration_validation_stop_recording(
+    CalibrationValidator* validator) {
+    if (validator->state != CALIBRATION_VALIDATION_STATE_IDLE) {
+        return CALIBRATION_VALIDATION_STATUS_ALREADY_IN_VALIDATION_MODE;
     }
-    variance /= vector_count;
-    float standard_deviation = (float)sqrt(variance);
-    return standard_deviation;
+
+    int succeeded = gaze_recorder_destroy(validator->recorder);
+    validator->recorder = NULL;
+
+    return succeeded ? CALIBRATION_VALIDATION_STATUS_OK : CALIBRATION_VALIDATION_STATUS_INVALID_RECORDING;
 }
 
-static float calculate_eye_precision_rms(TobiiResearchVector3D* direction_gaze_point_all, size_t vector_count) {
-    float variance = 0.0f;
-    for (size_t i = 1; i < vector_count; ++i) {
-        float angle = vector3_angle(&direction_gaze_point_all[i-1], &direction_gaze_point_all[i]);
-        variance += angle*angle;
+CalibrationValidationStatus tobii_research_screen_based_calibration_validation_replay(
+    CalibrationValidator* validator, float speed) {
+    process_gaze_data(validator);
+    if (!validator->replay_recording) {
+        return CALIBRATION_VALIDATION_STATUS_INVALID_RECORDING;
+    }
+    if (validator->state == CALIBRATION_VALIDATION_STATE_IDLE) {
+        return CALIBRATION_VALIDATION_STATUS_NOT_IN_VALIDATION_MODE;
+    }
+    if (validator->state == CALIBRATION_VALIDATION_STATE_COLLECTING_DATA) {
+        return CALIBRATION_VALIDATION_STATUS_OPERATION_NOT_ALLOWED_DURING_DATA_COLLECTION;
+    }
+
+    const GazeRecord* records = gaze_recording_records(validator->replay_recording);
+    size_t records_count = gaze_recording_count(validator->replay_recording);
+    int64_t first_time_stamp = 0;
+    stopwatch_reset(validator->wait_stopwatch);
+    stopwatch_start(validator->wait_stopwatch);
+
+    for (size_t i = 0; i < records_count; ++i) {
+        const GazeRecord* record = &records[i];
+        int64_t time_stamp = record->type == GAZE_RECORD_STIMULUS ?
+            record->data.stimulus.system_time_stamp : record->data.gaze_data.system_time_stamp;
+
+        if (speed > 0.0f) {
+            /* Keep the recorded pace, scaled by speed. */
+            if (i == 0) {
+                first_time_stamp = time_stamp;
+            }
+            long due_time = (long)((time_stamp - first_time_stamp) / (1000.0f * speed));
+            long elapsed_time = stopwatch_elapsed(validator->wait_stopwatch);
+            if (due_time > elapsed_time) {
+                sleep_ms(due_time - elapsed_time);
+            }
+        }
+
+        if (record->type == GAZE_RECORD_STIMULUS) {
+            end_replayed_data_collection(validator);
+            CalibrationValidationPlanPoint point;
+            point.screen_point = record->data.stimulus.screen_point;
+            point.settle_time = 0;
+            CalibrationValidationStatus status = start_collecting_data(validator, &point, 1, 0, &time_stamp);
+            if (status != CALIBRATION_VALIDATION_STATUS_OK) {
+                return status;
+            }
+        } else if (record->type == GAZE_RECORD_GAZE_DATA) {
+            /* The gaze data callback times the data collection by the recorded time stamps. */
+            TobiiResearchGazeData gaze_data = record->data.gaze_data;
+            gaze_data_callback(&gaze_data, validator);
+            process_gaze_data(validator);
+        }
+    }
+    end_replayed_data_collection(validator);
+
+    return CALIBRATION_VALIDATION_STATUS_OK;
+}
+
+CalibrationValidationStatus tobii_research_screen_based_calibration_validation_start_monitoring(
+    CalibrationValidator* validator, const TobiiResearchNormalizedPoint2D* screen_point) {
+    if (validator->state == CALIBRATION_VALIDATION_STATE_IDLE) {
+        return CALIBRATION_VALIDATION_STATUS_NOT_IN_VALIDATION_MODE;
+    }
+
+    if (!(screen_point->x >= 0.0f && screen_point->x <= 1.0f &&
+          screen_point->y >= 0.0f && screen_point->y <= 1.0f)) {
+        return CALIBRATION_VALIDATION_STATUS_INVALID_SCREEN_POINT;
+    }
+
+    TobiiResearchDisplayArea display_area;
+    read_display_area(validator, &display_area);
+    TobiiResearchPoint3D target;
+    calculate_normalized_point2_to_point3(&target, &display_area, screen_point);
+
+    drift_monitor_set_target(validator->monitor, screen_point, &target, validator->angle_kernel);
+    return CALIBRATION_VALIDATION_STATUS_OK;
+}
+
+CalibrationValidationStatus tobii_research_screen_based_calibration_validation_stop_monitoring(
+    CalibrationValidator* validator) {
+    if (validator->state == CALIBRATION_VALIDATION_STATE_IDLE) {
+        return CALIBRATION_VALIDATION_STATUS_NOT_IN_VALIDATION_MODE;
+    }
+
+    drift_monitor_set_target(validator->monitor, NULL, NULL, validator->angle_kernel);
+    return CALIBRATION_VALIDATION_STATUS_OK;
+}
+
+CalibrationValidationStatus tobii_research_screen_based_calibration_validation_get_monitor_result(
+    CalibrationValidator* validator, CalibrationValidationMonitorResult* result) {
+    drift_monitor_result(validator->monitor, result);
+    return CALIBRATION_VALIDATION_STATUS_OK;
+}
+
+CalibrationValidationStatus tobii_research_screen_based_calibration_validation_write_trace(const char* path) {
+    return trace_write(path) ? CALIBRATION_VALIDATION_STATUS_OK : CALIBRATION_VALIDATION_STATUS_INVALID_TRACE;
+}
+
+CalibrationValidationStatus tobii_research_screen_based_calibration_validation_get_stats(
+    CalibrationValidator* validator, CalibrationValidationStats* stats) {
+    validation_stats_get(validator->stats, stats);
+    return CALIBRATION_VALIDATION_STATUS_OK;
+}
+
+CalibrationValidationStatus tobii_research_screen_based_calibration_validation_reset_stats(
+    CalibrationValidator* validator) {
+    validation_stats_reset(validator->stats);
+    return CALIBRATION_VALIDATION_STATUS_OK;
+}
+
+static void init_validator(CalibrationValidator* validator, size_t sample_count, int timeout) {
+    validator->sample_count = sample_count;
+    validator->timeout = timeout;
+    validator->online_statistics = 0;
+    validator->retain_gaze_data = 0;
+    validator->result_gaze_data = CALIBRATION_VALIDATION_RESULT_GAZE_DATA_COPY;
+    validator->angle_kernel = VECTOR3_ANGLE_KERNEL_REFERENCE;
+    validator->compute_threads = 1;
+    validator->compute_worker_pool = NULL;
+    validator->compute_scratch = create_compute_scratch(validator->compute_threads);
+    validator->timing = CALIBRATION_VALIDATION_TIMING_STOPWATCH;
+    validator->robust_statistics = 0;
+    validator->trim_percentage = TRIM_PERCENTAGE_DEFAULT;
+    validator->state = CALIBRATION_VALIDATION_STATE_IDLE;
+    validator->display_area_sequence = 0;
+    memset(&validator->display_area, 0, sizeof(validator->display_area));
+
+    memset(&validator->new_point, 0, sizeof(validator->new_point));
+    validator->collected_points = NULL;
+    validator->collected_points_capacity = 0;
+    validator->collected_points_count = 0;
+    validator->discarded_points_count = 0;
+    validator->collected_points_index = NULL;
+    validator->free_blocks = NULL;
+
+    validator->gaze_data_ring = gaze_data_ring_init(GAZE_DATA_RING_CAPACITY);
+    validator->active_collection_id = 0;
+    validator->last_collection_id = 0;
+    validator->plan_sequence = 0;
+    validator->plan_points = NULL;
+    validator->plan_points_count = 0;
+    validator->plan_points_capacity = 0;
+    validator->plan_first_collection_id = 0;
+    validator->plan_start_time_stamp = 0;
+    validator->retired_plan_points = NULL;
+    validator->retired_plan_points_count = 0;
+    validator->collection_id = 0;
+    validator->plan_last_collection_id = 0;
+    validator->timed_collection_id = 0;
+    validator->timed_collection_received = 0;
+    validator->callback_collection_id = 0;
+    validator->callback_sample_count = 0;
+    validator->callback_stopwatch = stopwatch_init();
+    validator->callback_start_time_stamp = 0;
+
+    validator->collection_callback = NULL;
+    validator->collection_callback_user_data = NULL;
+    validator->target_callback = NULL;
+    validator->target_callback_user_data = NULL;
+    validator->collection_event = event_init();
+    validator->collection_result = CALIBRATION_VALIDATION_COLLECTION_RESULT_ONGOING;
+
+    validator->recorder = NULL;
+    validator->replay_recording = NULL;
+
+    validator->monitor_window = MONITOR_WINDOW_DEFAULT;
+    validator->monitor = drift_monitor_init(validator->monitor_window);
+
+    validator->stats = validation_stats_init();
+    validator->duration_histograms = 0;
+    validator->callback_duration_stopwatch = stopwatch_init();
+
+    validator->stopwatch = stopwatch_init();
+    validator->wait_stopwatch = stopwatch_init();
+    validator->compute_stopwatch = stopwatch_init();
+}
+
+static TobiiResearchStatus get_display_area(CalibrationValidator* validator, TobiiResearchDisplayArea* display_area) {
+    if (validator->replay_recording) {
+        *display_area = *gaze_recording_display_area(validator->replay_recording);
+        return TOBII_RESEARCH_STATUS_OK;
+    }
+    return tobii_research_get_display_area(validator->eyetracker, display_area);
+}
+
+static size_t read_display_area(CalibrationValidator* validator, TobiiResearchDisplayArea* display_area) {
+    /* Only valid in validation mode. */
+    size_t sequence;
+    do {
+        sequence = seqlock_read_begin(&validator->display_area_sequence);
+        *display_area = validator->display_area;
+    } while (seqlock_read_retry(&validator->display_area_sequence, sequence));
+    return sequence;
+}
+
+static void end_replayed_data_collection(CalibrationValidator* validator) {
+    if (validator->state == CALIBRATION_VALIDATION_STATE_COLLECTING_DATA) {
+        /* The recording moved on to the next stimuli point or ended before this one completed. */
+        stop_plan(validator, validator->last_collection_id);
+        process_gaze_data(validator);
+    }
+}
+
+static int is_timed_by_time_stamps(const CalibrationValidator* validator) {
+    return validator->timing == CALIBRATION_VALIDATION_TIMING_TIME_STAMPS || validator->replay_recording;
+}
+
+static int64_t collection_timeout(const CalibrationValidator* validator) {
+    /* In microseconds, as seen by the application thread. The gaze data callback ends the data collection on the
+     * first sample after the timeout, this only ends it if no such sample arrives. Until a sample is received the
+     * settle time of the point counts as well. */
+    int64_t timeout = (validator->timeout + TIMEOUT_MARGIN) * (int64_t)1000;
+    if (!validator->timed_collection_received) {
+        const CalibrationValidationPlanPoint* point =
+            &validator->plan_points[validator->timed_collection_id - validator->plan_first_collection_id];
+        timeout += point->settle_time * (int64_t)1000;
+    }
+    return timeout;
+}
+
+static void gaze_data_callback(TobiiResearchGazeData* gaze_data, void* user_data) {
+    CalibrationValidator* validator = (CalibrationValidator*)user_data;
+    validation_stats_count(validator->stats, VALIDATION_STATS_GAZE_DATA);
+    if (!validator->duration_histograms) {
+        handle_gaze_data(validator, gaze_data);
+        return;
+    }
+
+    stopwatch_reset(validator->callback_duration_stopwatch);
+    stopwatch_start(validator->callback_duration_stopwatch);
+    handle_gaze_data(validator, gaze_data);
+    validation_stats_add_duration(validator->stats, VALIDATION_STATS_GAZE_DATA_CALLBACK_DURATION,
+        stopwatch_elapsed_ns(validator->callback_duration_stopwatch));
+}
+
+static void display_area_callback(TobiiResearchDisplayArea* display_area, void* user_data) {
+    CalibrationValidator* validator = (CalibrationValidator*)user_data;
+    seqlock_write_begin(&validator->display_area_sequence);
+    validator->display_area = *display_area;
+    seqlock_write_end(&validator->display_area_sequence);
+}
+
+static void handle_gaze_data(CalibrationValidator* validator, const TobiiResearchGazeData* gaze_data) {
+    if (validator->recorder) {
+        gaze_recorder_add_gaze_data(validator->recorder, gaze_data);
+    }
+    if (is_valid_sample(gaze_data)) {
+        drift_monitor_add(validator->monitor, gaze_data);
+    }
+
+    size_t collection_id = atomic_load_acquire(&validator->active_collection_id);
+    CallbackPlanPoint plan_point;
+    if (!collection_id || !read_plan_point(validator, collection_id, &plan_point)) {
+        /* Not collecting, or the data collection ended and the application started another one meanwhile. */
+        validation_stats_count(validator->stats, VALIDATION_STATS_IDLE_GAZE_DATA);
+        return;
+    }
+    /* The callback has moved on to every point after the first one itself. */
+    int64_t start_time_stamp = plan_point.index == 0 ?
+        plan_point.plan_start_time_stamp : validator->callback_start_time_stamp;
+    if (plan_point.point.settle_time > 0 && gaze_data->system_time_stamp < start_time_stamp) {
+        /* Still settling on the point, the data collection starts with the first sample after it. */
+        validation_stats_count(validator->stats, VALIDATION_STATS_IDLE_GAZE_DATA);
+        return;
+    }
+    if (gaze_data_ring_full(validator->gaze_data_ring)) {
+        /* The application has not processed the queued samples, wait at the current point until it has. */
+        validation_stats_count(validator->stats, VALIDATION_STATS_DROPPED_GAZE_DATA);
+        return;
+    }
+    int timed_by_time_stamps = is_timed_by_time_stamps(validator);
+    if (collection_id != validator->callback_collection_id) {
+        /* First sample of a new data collection. */
+        validator->callback_sample_count = 0;
+        if (!timed_by_time_stamps) {
+            stopwatch_reset(validator->callback_stopwatch);
+            stopwatch_start(validator->callback_stopwatch);
+        }
+        atomic_store_release(&validator->callback_collection_id, collection_id);
+    }
+
+    if (timed_by_time_stamps) {
+        /* Only samples taken within the data collection count, no clock needs to be read. */
+        int64_t time = gaze_data->system_time_stamp - start_time_stamp;
+        if (time > validator->timeout * (int64_t)1000) {
+            end_plan_point(validator, collection_id, &plan_point, CALIBRATION_VALIDATION_COLLECTION_RESULT_TIMED_OUT,
+                gaze_data->system_time_stamp);
+        }
+        if (time < 0 || time > validator->timeout * (int64_t)1000) {
+            validation_stats_count(validator->stats, VALIDATION_STATS_IDLE_GAZE_DATA);
+            return;
+        }
+    }
+
+    /* Only the gaze data callback fills the ring, so the sample fits. */
+    gaze_data_ring_push(validator->gaze_data_ring, gaze_data, collection_id);
+    if (is_valid_sample(gaze_data)) {
+        validator->callback_sample_count++;
+    } else {
+        validation_stats_count(validator->stats, VALIDATION_STATS_INVALID_GAZE_DATA);
+    }
+
+    /* End the data collection right away, the queued samples are stored later by process_gaze_data. */
+    if (validator->callback_sample_count >= validator->sample_count) {
+        end_plan_point(validator, collection_id, &plan_point, CALIBRATION_VALIDATION_COLLECTION_RESULT_COMPLETED,
+            gaze_data->system_time_stamp);
+    } else if (!timed_by_time_stamps &&
+        stopwatch_elapsed_us(validator->callback_stopwatch) > validator->timeout * (int64_t)1000) {
+        end_plan_point(validator, collection_id, &plan_point, CALIBRATION_VALIDATION_COLLECTION_RESULT_TIMED_OUT,
+            gaze_data->system_time_stamp);
+    }
+}
+
+static int read_plan_point(CalibrationValidator* validator, size_t collection_id, CallbackPlanPoint* plan_point) {
+    /* Returns 0 if the collection id is not of the plan, the plan may have been replaced since it was read. */
+    size_t sequence;
+    int found = 0;
+    do {
+        sequence = seqlock_read_begin(&validator->plan_sequence);
+        const CalibrationValidationPlanPoint* points = validator->plan_points;
+        size_t points_count = validator->plan_points_count;
+        size_t index = collection_id - validator->plan_first_collection_id;
+        if (seqlock_read_retry(&validator->plan_sequence, sequence)) {
+            /* Only index the points once they are known to match the count. */
+            continue;
+        }
+        found = index < points_count;
+        if (found) {
+            plan_point->index = index;
+            plan_point->point = points[index];
+            plan_point->has_next = index + 1 < points_count;
+            if (plan_point->has_next) {
+                plan_point->next_point = points[index + 1];
+            }
+            plan_point->plan_start_time_stamp = validator->plan_start_time_stamp;
+        }
+    } while (seqlock_read_retry(&validator->plan_sequence, sequence));
+    return found;
+}
+
+static int is_valid_sample(const TobiiResearchGazeData* gaze_data) {
+    return gaze_data->left_eye.gaze_point.validity == TOBII_RESEARCH_VALIDITY_VALID &&
+        gaze_data->right_eye.gaze_point.validity == TOBII_RESEARCH_VALIDITY_VALID;
+}
+
+static int end_data_collection(CalibrationValidator* validator, size_t collection_id,
+    CalibrationValidationCollectionResult result) {
+    /* Read before ending the data collection, after that the application may change them. */
+    CalibrationValidationCollectionCallback callback = validator->collection_callback;
+    void* user_data = validator->collection_callback_user_data;
+
+    /* Both the gaze data callback and the application thread may try to end the data collection, only the
+     * first one notifies. */
+    if (atomic_compare_exchange(&validator->active_collection_id, collection_id, 0)) {
+        event_set(validator->collection_event);
+        if (callback) {
+            callback(result, user_data);
+        }
+        return 1;
+    }
+    return 0;
+}
+
+static void end_plan_point(CalibrationValidator* validator, size_t collection_id,
+    const CallbackPlanPoint* plan_point, CalibrationValidationCollectionResult result, int64_t system_time_stamp) {
+    if (!plan_point->has_next) {
+        end_data_collection(validator, collection_id, result);
+        return;
+    }
+
+    /* Read before moving on, once the plan is stopped the application may change them. */
+    CalibrationValidationCollectionCallback callback = validator->collection_callback;
+    void* user_data = validator->collection_callback_user_data;
+    CalibrationValidationTargetCallback target_callback = validator->target_callback;
+    void* target_user_data = validator->target_callback_user_data;
+    const CalibrationValidationPlanPoint* next_point = &plan_point->next_point;
+    int64_t start_time_stamp = system_time_stamp + next_point->settle_time * (int64_t)1000;
+
+    if (atomic_compare_exchange(&validator->active_collection_id, collection_id, collection_id + 1)) {
+        /* Only read by the gaze data callback, so it may be set after the next point is published. */
+        validator->callback_start_time_stamp = start_time_stamp;
+        if (validator->recorder) {
+            gaze_recorder_add_callback_stimulus(validator->recorder, &next_point->screen_point, start_time_stamp);
+        }
+        event_set(validator->collection_event);
+        if (callback) {
+            callback(result, user_data);
+        }
+        if (target_callback) {
+            target_callback(plan_point->index + 1, &next_point->screen_point, target_user_data);
+        }
+    }
+}
+
+static void stop_plan(CalibrationValidator* validator, size_t collection_id) {
+    /* Ending the data collection from the application thread stops the plan at the current point. */
+    if (end_data_collection(validator, collection_id, CALIBRATION_VALIDATION_COLLECTION_RESULT_TIMED_OUT)) {
+        validator->plan_last_collection_id = collection_id;
+    }
+}
+
+static void process_gaze_data(CalibrationValidator* validator) {
+    int collection_ended = 0;
+    size_t collection_id = 0;
+    if (validator->state == CALIBRATION_VALIDATION_STATE_COLLECTING_DATA) {
+        collection_id = atomic_load_acquire(&validator->active_collection_id);
+        if (collection_id && collection_id != validator->timed_collection_id) {
+            /* The gaze data callback moved on to the next point of the plan. */
+            validator->timed_collection_id = collection_id;
+            validator->timed_collection_received = 0;
+            stopwatch_reset(validator->stopwatch);
+            stopwatch_start(validator->stopwatch);
+        }
+        if (collection_id && !validator->timed_collection_received &&
+            atomic_load_acquire(&validator->callback_collection_id) == collection_id) {
+            /* The gaze data callback times the data collection from its first sample, time it from no earlier. */
+            validator->timed_collection_received = 1;
+            stopwatch_reset(validator->stopwatch);
+            stopwatch_start(validator->stopwatch);
+        }
+        if (collection_id && gaze_data_ring_full(validator->gaze_data_ring)) {
+            /* The gaze data callback waits for the queued samples to be stored, it ends the data collection once it
+             * can queue samples again. */
+            stopwatch_reset(validator->stopwatch);
+            stopwatch_start(validator->stopwatch);
+        }
+        /* Replayed data collections time out on the recorded time stamps only. */
+        if (collection_id && !validator->replay_recording &&
+            stopwatch_elapsed_us(validator->stopwatch) > collection_timeout(validator)) {
+            /* No gaze data arrived to end the data collection. */
+            stop_plan(validator, collection_id);
+        }
+        /* Once ended, no more samples are queued for the data collection. */
+        collection_ended = atomic_load_acquire(&validator->active_collection_id) == 0;
+    }
+
+    const GazeDataRingEntry* entry;
+    while ((entry = gaze_data_ring_front(validator->gaze_data_ring)) != NULL) {
+        if (validator->retired_plan_points_count && entry->collection_id >= validator->plan_first_collection_id) {
+            /* The gaze data callback has read the current plan, so it no longer reads the arrays it outgrew. */
+            destroy_retired_plan_points(validator);
+        }
+        if (validator->state == CALIBRATION_VALIDATION_STATE_COLLECTING_DATA &&
+            entry->collection_id >= validator->collection_id &&
+            entry->collection_id <= validator->plan_last_collection_id) {
+            /* The points of the plan before the one the sample is for have ended. */
+            while (validator->collection_id < entry->collection_id) {
+                next_plan_point(validator);
+            }
+            const TobiiResearchGazeData* gaze_data = &entry->gaze_data;
+            if (validator->new_point.gaze_data_count < validator->sample_count && is_valid_sample(gaze_data)) {
+                /* Store gaze data sample. */
+                store_data_point_sample(&validator->new_point, gaze_data);
+                if (validator->online_statistics) {
+                    eye_statistics_add(&validator->new_point.left_eye_statistics,
+                        &gaze_data->left_eye.gaze_origin.position_in_user_coordinates,
+                        &gaze_data->left_eye.gaze_point.position_in_user_coordinates, validator->angle_kernel);
+                    eye_statistics_add(&validator->new_point.right_eye_statistics,
+                        &gaze_data->right_eye.gaze_origin.position_in_user_coordinates,
+                        &gaze_data->right_eye.gaze_point.position_in_user_coordinates, validator->angle_kernel);
+                }
+            }
+        }
+        /* Samples left over from earlier data collections are simply discarded. */
+        gaze_data_ring_pop(validator->gaze_data_ring);
+    }
+
+    if (collection_ended) {
+        stop_collecting_data(validator);
+    } else {
+        /* The gaze data callback queued every sample of the points it moved on from before moving on, so they are
+         * complete and are stored now. Otherwise a point that ended without samples queued for the next one yet
+         * would be stored after a later clear or discard, as if it were still being collected. */
+        while (validator->collection_id < collection_id) {
+            next_plan_point(validator);
+        }
+    }
+}
+
+static void store_plan_point(CalibrationValidator* validator) {
+    validator->collection_result = validator->new_point.gaze_data_count >= validator->sample_count ?
+        CALIBRATION_VALIDATION_COLLECTION_RESULT_COMPLETED : CALIBRATION_VALIDATION_COLLECTION_RESULT_TIMED_OUT;
+    validation_stats_count(validator->stats,
+        validator->collection_result == CALIBRATION_VALIDATION_COLLECTION_RESULT_COMPLETED ?
+        VALIDATION_STATS_COMPLETED_COLLECTIONS : VALIDATION_STATS_TIMED_OUT_COLLECTIONS);
+    store_collected_data(validator);
+    TRACE_SPAN("collect_data", validator->collection_trace_start);
+}
+
+static void next_plan_point(CalibrationValidator* validator) {
+    store_plan_point(validator);
+    validator->collection_id++;
+    validator->collection_trace_start = TRACE_NOW();
+    reserve_collected_data(validator);
+    create_data_point(validator, &validator->new_point,
+        &validator->plan_points[validator->collection_id - validator->plan_first_collection_id].screen_point);
+}
+
+static void stop_collecting_data(CalibrationValidator* validator) {
+    /* Points of the plan may have ended without any samples queued for them. */
+    while (validator->collection_id < validator->plan_last_collection_id) {
+        next_plan_point(validator);
+    }
+    store_plan_point(validator);
+    validator->state = CALIBRATION_VALIDATION_STATE_CALIBRATION_MODE;
+}
+
+static void retire_plan_points(CalibrationValidator* validator) {
+    if (!validator->plan_points) {
+        return;
+    }
+    validator->retired_plan_points = realloc(validator->retired_plan_points,
+        (validator->retired_plan_points_count + 1) * sizeof(*validator->retired_plan_points));
+    validator->retired_plan_points[validator->retired_plan_points_count++] = validator->plan_points;
+}
+
+static void destroy_retired_plan_points(CalibrationValidator* validator) {
+    /* Only once no more gaze data is received. */
+    for (size_t i = 0; i < validator->retired_plan_points_count; ++i) {
+        free(validator->retired_plan_points[i]);
+    }
+    free(validator->retired_plan_points);
+    validator->retired_plan_points = NULL;
+    validator->retired_plan_points_count = 0;
+}
+
+
+static SampleBlock* allocate_sample_block(CalibrationValidator* validator, size_t capacity) {
+    /* Header and all arrays share one allocation. */
+    size_t stride = SAMPLE_BLOCK_STRIDE(capacity);
+    size_t size = SAMPLE_BLOCK_HEADER_SIZE + stride * (2 * sizeof(int64_t) + 12 * sizeof(float));
+    if (validator->retain_gaze_data) {
+        size += stride * sizeof(TobiiResearchGazeData);
+    }
+    SampleBlock* block = malloc(size);
+    block->capacity = capacity;
+
+    char* data = (char*)block + SAMPLE_BLOCK_HEADER_SIZE;
+    block->device_time_stamp = (int64_t*)data;
+    data += stride * sizeof(int64_t);
+    block->system_time_stamp = (int64_t*)data;
+    data += stride * sizeof(int64_t);
+    if (validator->retain_gaze_data) {
+        block->gaze_data = (TobiiResearchGazeData*)data;
+        data += stride * sizeof(TobiiResearchGazeData);
+    } else {
+        block->gaze_data = NULL;
+    }
+    Point3Arrays* arrays[] = {
+        &block->gaze_origin_left, &block->gaze_point_left, &block->gaze_origin_right, &block->gaze_point_right
+    };
+    for (size_t i = 0; i < sizeof(arrays) / sizeof(arrays[0]); ++i) {
+        arrays[i]->x = (float*)data;
+        data += stride * sizeof(float);
+        arrays[i]->y = (float*)data;
+        data += stride * sizeof(float);
+        arrays[i]->z = (float*)data;
+        data += stride * sizeof(float);
+    }
+    block->next = NULL;
+    block->count = 0;
+    return block;
+}
+
+static SampleBlock* acquire_sample_block(CalibrationValidator* validator) {
+    SampleBlock* block = validator->free_blocks;
+    if (!block) {
+        return allocate_sample_block(validator, validator->sample_count);
+    }
+    validator->free_blocks = block->next;
+    block->next = NULL;
+    block->count = 0;
+    return block;
+}
+
+static void release_sample_blocks(CalibrationValidator* validator, SampleBlock* first_block) {
+    while (first_block) {
+        SampleBlock* next = first_block->next;
+        if (first_block->capacity == validator->sample_count) {
+            first_block->next = validator->free_blocks;
+            validator->free_blocks = first_block;
+        } else {
+            /* Coalesced blocks are not reused. */
+            free(first_block);
+        }
+        first_block = next;
+    }
+}
+
+static void destroy_free_sample_blocks(CalibrationValidator* validator) {
+    while (validator->free_blocks) {
+        SampleBlock* next = validator->free_blocks->next;
+        free(validator->free_blocks);
+        validator->free_blocks = next;
+    }
+}
+
+static void create_data_point(CalibrationValidator* validator, CollectedDataPoint* data_point,
+    const TobiiResearchNormalizedPoint2D* screen_point) {
+    data_point->screen_point = *screen_point;
+    data_point->first_block = acquire_sample_block(validator);
+    data_point->last_block = data_point->first_block;
+    data_point->gaze_data_count = 0;
+    data_point->discarded = 0;
+    data_point->dirty = 1;
+    TobiiResearchDisplayArea display_area;
+    data_point->display_area_sequence = read_display_area(validator, &display_area);
+    calculate_normalized_point2_to_point3(&data_point->stimuli_point, &display_area, screen_point);
+    eye_statistics_reset(&data_point->left_eye_statistics);
+    eye_statistics_reset(&data_point->right_eye_statistics);
+}
+
+static void destroy_data_point(CalibrationValidator* validator, CollectedDataPoint* data_point) {
+    release_sample_blocks(validator, data_point->first_block);
+    data_point->first_block = NULL;
+    data_point->last_block = NULL;
+    data_point->gaze_data_count = 0;
+}
+
+static void store_data_point_sample(CollectedDataPoint* data_point, const TobiiResearchGazeData* gaze_data) {
+    SampleBlock* block = data_point->last_block;
+    size_t index = block->count++;
+    point3_arrays_set(&block->gaze_origin_left, index, &gaze_data->left_eye.gaze_origin.position_in_user_coordinates);
+    point3_arrays_set(&block->gaze_point_left, index, &gaze_data->left_eye.gaze_point.position_in_user_coordinates);
+    point3_arrays_set(&block->gaze_origin_right, index,
+        &gaze_data->right_eye.gaze_origin.position_in_user_coordinates);
+    point3_arrays_set(&block->gaze_point_right, index, &gaze_data->right_eye.gaze_point.position_in_user_coordinates);
+    block->device_time_stamp[index] = gaze_data->device_time_stamp;
+    block->system_time_stamp[index] = gaze_data->system_time_stamp;
+    if (block->gaze_data) {
+        block->gaze_data[index] = *gaze_data;
+    }
+    data_point->gaze_data_count++;
+}
+
+static void coalesce_data_point(CalibrationValidator* validator, CollectedDataPoint* data_point) {
+    if (data_point->first_block == data_point->last_block) {
+        return;
+    }
+
+    /* Move the samples of all blocks into a single block holding exactly the collected samples. */
+    SampleBlock* coalesced = allocate_sample_block(validator, data_point->gaze_data_count);
+    for (SampleBlock* block = data_point->first_block; block; block = block->next) {
+        const Point3Arrays* from[] = {
+            &block->gaze_origin_left, &block->gaze_point_left, &block->gaze_origin_right, &block->gaze_point_right
+        };
+        Point3Arrays* to[] = {
+            &coalesced->gaze_origin_left, &coalesced->gaze_point_left,
+            &coalesced->gaze_origin_right, &coalesced->gaze_point_right
+        };
+        for (size_t i = 0; i < sizeof(from) / sizeof(from[0]); ++i) {
+            memcpy(to[i]->x + coalesced->count, from[i]->x, block->count * sizeof(float));
+            memcpy(to[i]->y + coalesced->count, from[i]->y, block->count * sizeof(float));
+            memcpy(to[i]->z + coalesced->count, from[i]->z, block->count * sizeof(float));
+        }
+        memcpy(coalesced->device_time_stamp + coalesced->count, block->device_time_stamp,
+            block->count * sizeof(int64_t));
+        memcpy(coalesced->system_time_stamp + coalesced->count, block->system_time_stamp,
+            block->count * sizeof(int64_t));
+        if (coalesced->gaze_data) {
+            memcpy(coalesced->gaze_data + coalesced->count, block->gaze_data,
+                block->count * sizeof(TobiiResearchGazeData));
+        }
+        coalesced->count += block->count;
+    }
+
+    release_sample_blocks(validator, data_point->first_block);
+    data_point->first_block = coalesced;
+    data_point->last_block = coalesced;
+}
+
+static int has_gaze_data(const CollectedDataPoint* data_point) {
+    /* Either no gaze data collected, or not retained. */
+    return data_point->gaze_data_count && data_point->first_block->gaze_data;
+}
+
+static void set_point_gaze_data(CalibrationValidator* validator, CalibrationValidationPoint* point,
+    CollectedDataPoint* data_point, TobiiResearchGazeData** gaze_data_copy) {
+    point->gaze_data = NULL;
+    point->gaze_data_count = 0;
+    if (!has_gaze_data(data_point)) {
+        return;
+    }
+
+    switch (validator->result_gaze_data) {
+        case CALIBRATION_VALIDATION_RESULT_GAZE_DATA_NONE:
+            break;
+
+        case CALIBRATION_VALIDATION_RESULT_GAZE_DATA_VIEW:
+            /* A view needs the samples to be contiguous, which they are unless the point was collected more
+             * than once since the last compute. */
+            coalesce_data_point(validator, data_point);
+            point->gaze_data = data_point->first_block->gaze_data;
+            point->gaze_data_count = data_point->gaze_data_count;
+            break;
+
+        case CALIBRATION_VALIDATION_RESULT_GAZE_DATA_COPY:
+        default:
+            /* Copied to where the result has room for the gaze data of this point. */
+            point->gaze_data = *gaze_data_copy;
+            point->gaze_data_count = data_point->gaze_data_count;
+            TobiiResearchGazeData* to = point->gaze_data;
+            for (SampleBlock* block = data_point->first_block; block; block = block->next) {
+                memcpy(to, block->gaze_data, block->count * sizeof(*to));
+                to += block->count;
+            }
+            *gaze_data_copy = to;
+            break;
+    }
+}
+
+static void init_collected_data(CalibrationValidator* validator) {
+    validator->collected_points_capacity = 5;
+    validator->collected_points_count = 0;
+    validator->discarded_points_count = 0;
+    validator->collected_points = malloc(validator->collected_points_capacity * sizeof(*validator->collected_points));
+    validator->collected_points_index = point_index_init(validator->collected_points_capacity);
+}
+
+static void reserve_collected_data(CalibrationValidator* validator) {
+    if (validator->collected_points_count < validator->collected_points_capacity) {
+        return;
+    }
+    if (validator->discarded_points_count > 0) {
+        /* Reuse the slots of discarded points before growing. */
+        compact_collected_data(validator);
+        return;
+    }
+    validator->collected_points_capacity *= 2;
+    validator->collected_points = realloc(validator->collected_points,
+        validator->collected_points_capacity * sizeof(*validator->collected_points));
+    point_index_reserve(validator->collected_points_index, validator->collected_points_capacity);
+}
+
+static void store_collected_data(CalibrationValidator* validator) {
+    /* Check if data for stimuli point already is collected. */
+    size_t idx = point_index_find(validator->collected_points_index, &validator->new_point.screen_point);
+    if (idx != POINT_INDEX_NOT_FOUND) {
+        CollectedDataPoint* data_point = &validator->collected_points[idx];
+        /* Stimuli point already collected, chain the new sample block to it. */
+        data_point->last_block->next = validator->new_point.first_block;
+        data_point->last_block = validator->new_point.last_block;
+        data_point->gaze_data_count += validator->new_point.gaze_data_count;
+        data_point->dirty = 1;
+        eye_statistics_merge(&data_point->left_eye_statistics, &validator->new_point.left_eye_statistics,
+            validator->angle_kernel);
+        eye_statistics_merge(&data_point->right_eye_statistics, &validator->new_point.right_eye_statistics,
+            validator->angle_kernel);
+    } else {
+        /* New stimuli point, store collected data. Capacity is reserved when data collection starts. */
+        point_index_insert(validator->collected_points_index, &validator->new_point.screen_point,
+            validator->collected_points_count);
+        validator->collected_points[validator->collected_points_count++] = validator->new_point;
+    }
+    validator->new_point.first_block = NULL;
+    validator->new_point.last_block = NULL;
+    validator->new_point.gaze_data_count = 0;
+}
+
+static void destroy_collected_data(CalibrationValidator* validator) {
+    if (validator->collected_points_capacity > 0) {
+        for (size_t i = 0; i < validator->collected_points_count; ++i) {
+            destroy_data_point(validator, &validator->collected_points[i]);
+        }
+        free(validator->collected_points);
+        validator->collected_points = NULL;
+        validator->collected_points_capacity = 0;
+        validator->collected_points_count = 0;
+        validator->discarded_points_count = 0;
+        point_index_destroy(validator->collected_points_index);
+        validator->collected_points_index = NULL;
+    }
+}
+
+static void compact_collected_data(CalibrationValidator* validator) {
+    if (validator->discarded_points_count == 0) {
+        return;
+    }
+
+    /* Close the gaps left by discarded points, keeping the collection order. */
+    size_t count = 0;
+    for (size_t i = 0; i < validator->collected_points_count; ++i) {
+        if (!validator->collected_points[i].discarded) {
+            validator->collected_points[count] = validator->collected_points[i];
+            point_index_insert(validator->collected_points_index, &validator->collected_points[count].screen_point,
+                count);
+            count++;
+        }
+    }
+    validator->collected_points_count = count;
+    validator->discarded_points_count = 0;
+}
+
+static void update_computed_points(CalibrationValidator* validator) {
+    /* Points collected before the display area last changed have their stimuli point moved. */
+    TobiiResearchDisplayArea display_area;
+    size_t display_area_sequence = read_display_area(validator, &display_area);
+    size_t* dirty_indices = malloc(validator->collected_points_count * sizeof(*dirty_indices));
+    size_t dirty_count = 0;
+    for (size_t i = 0; i < validator->collected_points_count; ++i) {
+        CollectedDataPoint* data_point = &validator->collected_points[i];
+        if (data_point->display_area_sequence != display_area_sequence) {
+            calculate_normalized_point2_to_point3(&data_point->stimuli_point, &display_area,
+                &data_point->screen_point);
+            data_point->display_area_sequence = display_area_sequence;
+            data_point->dirty = 1;
+        }
+        if (data_point->dirty) {
+            dirty_indices[dirty_count++] = i;
+        }
+    }
+
+    /* The dirty points are computed independently, possibly on the worker threads. */
+    if (validator->compute_worker_pool && dirty_count > 1) {
+        /* Have the batch functions selected before the workers use them. */
+        vectormath_batch_implementation();
+        ComputeContext context;
+        context.validator = validator;
+        context.dirty_indices = dirty_indices;
+        context.dirty_count = dirty_count;
+        context.job_count = dirty_count < (size_t)validator->compute_threads ?
+            dirty_count : (size_t)validator->compute_threads;
+        worker_pool_run(validator->compute_worker_pool, compute_points_job, &context, context.job_count);
+    } else {
+        compute_points(validator, dirty_indices, dirty_count, &validator->compute_scratch[0]);
+    }
+    for (size_t i = 0; i < dirty_count; ++i) {
+        validator->collected_points[dirty_indices[i]].dirty = 0;
+    }
+    free(dirty_indices);
+}
+
+static void calculate_averages(const CalibrationValidator* validator, CalibrationValidationResult* result) {
+    float accuracy_left_eye_average = 0.0f;
+    float accuracy_right_eye_average = 0.0f;
+    float precision_left_eye_average = 0.0f;
+    float precision_right_eye_average = 0.0f;
+    float precision_rms_left_eye_average = 0.0f;
+    float precision_rms_right_eye_average = 0.0f;
+    int valid_points_count = 0;
+
+    for (size_t i = 0; i < validator->collected_points_count; ++i) {
+        const CalibrationValidationPoint* point = &validator->collected_points[i].computed_point;
+        if (point->timed_out) {
+            continue;
+        }
+
+        /* Ackumulate values for average calculation */
+        accuracy_left_eye_average += point->accuracy_left_eye;
+        accuracy_right_eye_average += point->accuracy_right_eye;
+        precision_left_eye_average += point->precision_left_eye;
+        precision_right_eye_average += point->precision_right_eye;
+        precision_rms_left_eye_average += point->precision_rms_left_eye;
+        precision_rms_right_eye_average += point->precision_rms_right_eye;
+
+        valid_points_count++;
+    }
+
+    if (valid_points_count > 0) {
+        accuracy_left_eye_average /= valid_points_count;
+        accuracy_right_eye_average /= valid_points_count;
+        precision_left_eye_average /= valid_points_count;
+        precision_right_eye_average /= valid_points_count;
+        precision_rms_left_eye_average /= valid_points_count;
+        precision_rms_right_eye_average /= valid_points_count;
+    } else {
+        accuracy_left_eye_average = NAN;
+        accuracy_right_eye_average = NAN;
+        precision_left_eye_average = NAN;
+        precision_right_eye_average = NAN;
+        precision_rms_left_eye_average = NAN;
+        precision_rms_right_eye_average = NAN;
+    }
+
+    result->average_accuracy_left = accuracy_left_eye_average;
+    result->average_accuracy_right = accuracy_right_eye_average;
+    result->average_precision_left = precision_left_eye_average;
+    result->average_precision_right = precision_right_eye_average;
+    result->average_precision_rms_left = precision_rms_left_eye_average;
+    result->average_precision_rms_right = precision_rms_right_eye_average;
+}
+
+/* The metrics of a point in the order they are exported, the order of CalibrationValidationPoint. */
+static void get_point_metrics(const CalibrationValidationPoint* point, float* metrics) {
+    metrics[0] = point->accuracy_left_eye;
+    metrics[1] = point->accuracy_right_eye;
+    metrics[2] = point->precision_left_eye;
+    metrics[3] = point->precision_right_eye;
+    metrics[4] = point->precision_rms_left_eye;
+    metrics[5] = point->precision_rms_right_eye;
+    metrics[6] = point->accuracy_median_left_eye;
+    metrics[7] = point->accuracy_median_right_eye;
+    metrics[8] = point->accuracy_trimmed_left_eye;
+    metrics[9] = point->accuracy_trimmed_right_eye;
+    metrics[10] = point->precision_mad_left_eye;
+    metrics[11] = point->precision_mad_right_eye;
+    metrics[12] = point->precision_rms_trimmed_left_eye;
+    metrics[13] = point->precision_rms_trimmed_right_eye;
+}
+
+static const char* const export_metric_names[] = {
+    "accuracy_left_eye",
+    "accuracy_right_eye",
+    "precision_left_eye",
+    "precision_right_eye",
+    "precision_rms_left_eye",
+    "precision_rms_right_eye",
+    "accuracy_median_left_eye",
+    "accuracy_median_right_eye",
+    "accuracy_trimmed_left_eye",
+    "accuracy_trimmed_right_eye",
+    "precision_mad_left_eye",
+    "precision_mad_right_eye",
+    "precision_rms_trimmed_left_eye",
+    "precision_rms_trimmed_right_eye",
+};
+
+#define EXPORT_METRIC_COUNT (sizeof(export_metric_names) / sizeof(export_metric_names[0]))
+
+/* The gaze origins and gaze points of a sample, in the order they are exported. */
+static void get_sample_points(const SampleBlock* block, size_t index, TobiiResearchPoint3D* points) {
+    point3_arrays_get(&points[0], &block->gaze_origin_left, index);
+    point3_arrays_get(&points[1], &block->gaze_point_left, index);
+    point3_arrays_get(&points[2], &block->gaze_origin_right, index);
+    point3_arrays_get(&points[3], &block->gaze_point_right, index);
+}
+
+static const char* const export_sample_point_names[] = {
+    "left_gaze_origin",
+    "left_gaze_point",
+    "right_gaze_origin",
+    "right_gaze_point",
+};
+
+static void export_binary(const CalibrationValidator* validator, ExportWriter* writer,
+    const CalibrationValidationResult* averages, int include_samples) {
+    size_t sample_count = 0;
+    for (size_t i = 0; include_samples && i < validator->collected_points_count; ++i) {
+        sample_count += validator->collected_points[i].gaze_data_count;
+    }
+    export_writer_write(writer, EXPORT_MAGIC, 4);
+    export_writer_u32(writer, EXPORT_VERSION);
+    export_writer_u32(writer, include_samples ? 1 : 0);
+    export_writer_u32(writer, (uint32_t)validator->collected_points_count);
+    export_writer_u32(writer, (uint32_t)sample_count);
+    export_writer_u32(writer, 0);
+    export_writer_f32(writer, averages->average_accuracy_left);
+    export_writer_f32(writer, averages->average_accuracy_right);
+    export_writer_f32(writer, averages->average_precision_left);
+    export_writer_f32(writer, averages->average_precision_right);
+    export_writer_f32(writer, averages->average_precision_rms_left);
+    export_writer_f32(writer, averages->average_precision_rms_right);
+
+    for (size_t i = 0; i < validator->collected_points_count; ++i) {
+        const CollectedDataPoint* data_point = &validator->collected_points[i];
+        float metrics[EXPORT_METRIC_COUNT];
+        get_point_metrics(&data_point->computed_point, metrics);
+        export_writer_f32(writer, data_point->screen_point.x);
+        export_writer_f32(writer, data_point->screen_point.y);
+        export_writer_u32(writer, data_point->computed_point.timed_out ? 1 : 0);
+        export_writer_u32(writer, (uint32_t)data_point->gaze_data_count);
+        for (size_t j = 0; j < EXPORT_METRIC_COUNT; ++j) {
+            export_writer_f32(writer, metrics[j]);
+        }
+
+        for (const SampleBlock* block = data_point->first_block; include_samples && block; block = block->next) {
+            for (size_t j = 0; j < block->count; ++j) {
+                TobiiResearchPoint3D points[4];
+                get_sample_points(block, j, points);
+                export_writer_i64(writer, block->device_time_stamp[j]);
+                export_writer_i64(writer, block->system_time_stamp[j]);
+                for (size_t k = 0; k < 4; ++k) {
+                    export_writer_f32(writer, points[k].x);
+                    export_writer_f32(writer, points[k].y);
+                    export_writer_f32(writer, points[k].z);
+                }
+            }
+        }
+    }
+}
+
+static void export_json(const CalibrationValidator* validator, ExportWriter* writer,
+    const CalibrationValidationResult* averages, int include_samples) {
+    const char* const average_names[] = {
+        "average_accuracy_left",
+        "average_accuracy_right",
+        "average_precision_left",
+        "average_precision_right",
+        "average_precision_rms_left",
+        "average_precision_rms_right",
+    };
+    const float average_values[] = {
+        averages->average_accuracy_left,
+        averages->average_accuracy_right,
+        averages->average_precision_left,
+        averages->average_precision_right,
+        averages->average_precision_rms_left,
+        averages->average_precision_rms_right,
+    };
+    export_writer_printf(writer, "{\"type\":\"validation\",\"version\":%d,\"points_count\":%zu", EXPORT_VERSION,
+        validator->collected_points_count);
+    for (size_t i = 0; i < sizeof(average_values) / sizeof(average_values[0]); ++i) {
+        export_writer_printf(writer, ",\"%s\":", average_names[i]);
+        export_writer_json_f32(writer, average_values[i]);
+    }
+    export_writer_write(writer, "}\n", 2);
+
+    for (size_t i = 0; i < validator->collected_points_count; ++i) {
+        const CollectedDataPoint* data_point = &validator->collected_points[i];
+        float metrics[EXPORT_METRIC_COUNT];
+        get_point_metrics(&data_point->computed_point, metrics);
+        export_writer_printf(writer, "{\"type\":\"point\",\"index\":%zu,\"screen_point\":[", i);
+        export_writer_json_f32(writer, data_point->screen_point.x);
+        export_writer_write(writer, ",", 1);
+        export_writer_json_f32(writer, data_point->screen_point.y);
+        export_writer_printf(writer, "],\"timed_out\":%s,\"gaze_data_count\":%zu",
+            data_point->computed_point.timed_out ? "true" : "false", data_point->gaze_data_count);
+        for (size_t j = 0; j < EXPORT_METRIC_COUNT; ++j) {
+            export_writer_printf(writer, ",\"%s\":", export_metric_names[j]);
+            export_writer_json_f32(writer, metrics[j]);
+        }
+        export_writer_write(writer, "}\n", 2);
+
+        for (const SampleBlock* block = data_point->first_block; include_samples && block; block = block->next) {
+            for (size_t j = 0; j < block->count; ++j) {
+                TobiiResearchPoint3D points[4];
+                get_sample_points(block, j, points);
+                export_writer_printf(writer,
+                    "{\"type\":\"sample\",\"point\":%zu,\"device_time_stamp\":%lld,\"system_time_stamp\":%lld",
+                    i, (long long)block->device_time_stamp[j], (long long)block->system_time_stamp[j]);
+                for (size_t k = 0; k < 4; ++k) {
+                    export_writer_printf(writer, ",\"%s\":[", export_sample_point_names[k]);
+                    export_writer_json_f32(writer, points[k].x);
+                    export_writer_write(writer, ",", 1);
+                    export_writer_json_f32(writer, points[k].y);
+                    export_writer_write(writer, ",", 1);
+                    export_writer_json_f32(writer, points[k].z);
+                    export_writer_write(writer, "]", 1);
+                }
+                export_writer_write(writer, "}\n", 2);
+            }
+        }
+    }
+}
+
+static void compute_points(CalibrationValidator* validator, const size_t* dirty_indices, size_t dirty_count,
+    ComputeScratch* scratch) {
+    for (size_t i = 0; i < dirty_count; ++i) {
+        CollectedDataPoint* data_point = &validator->collected_points[dirty_indices[i]];
+        compute_point(validator, data_point, &data_point->computed_point, scratch);
+    }
+}
+
+static void compute_points_job(void* context, size_t index) {
+    ComputeContext* compute_context = (ComputeContext*)context;
+    size_t first = index * compute_context->dirty_count / compute_context->job_count;
+    size_t end = (index + 1) * compute_context->dirty_count / compute_context->job_count;
+    compute_points(compute_context->validator, compute_context->dirty_indices + first, end - first,
+        &compute_context->validator->compute_scratch[index]);
+}
+
+static void compute_point(const CalibrationValidator* validator, const CollectedDataPoint* collected_data_point,
+    CalibrationValidationPoint* point, ComputeScratch* scratch) {
+    point->screen_point = collected_data_point->screen_point;
+
+    if (collected_data_point->gaze_data_count < validator->sample_count) {
+        /* Timeout before collecting enough valid samples, no calculations to be done. */
+        point->accuracy_left_eye = NAN;
+        point->accuracy_right_eye = NAN;
+        point->precision_left_eye = NAN;
+        point->precision_right_eye = NAN;
+        point->precision_rms_left_eye = NAN;
+        point->precision_rms_right_eye = NAN;
+        clear_point_robust_statistics(point);
+        point->timed_out = 1;
+        return;
+    }
+
+    int64_t trace_start = TRACE_NOW();
+    const TobiiResearchPoint3D* stimuli_point = &collected_data_point->stimuli_point;
+
+    if (validator->online_statistics) {
+        calculate_point_statistics_online(collected_data_point, stimuli_point, validator->angle_kernel, point);
+        clear_point_robust_statistics(point);
+    } else {
+        calculate_point_statistics(collected_data_point, stimuli_point, validator->angle_kernel,
+            validator->robust_statistics, validator->trim_percentage / 100.0f, scratch, point);
+    }
+    point->timed_out = 0;
+    TRACE_SPAN("compute_point", trace_start);
+}
+
+static ComputeScratch* create_compute_scratch(int count) {
+    ComputeScratch* scratch = malloc((size_t)count * sizeof(*scratch));
+    for (int i = 0; i < count; ++i) {
+        /* Allocated when first used. */
+        scratch[i].values = NULL;
+        scratch[i].capacity = 0;
+    }
+    return scratch;
+}
+
+static void destroy_compute_scratch(ComputeScratch* scratch, int count) {
+    for (int i = 0; i < count; ++i) {
+        free(scratch[i].values);
+    }
+    free(scratch);
+}
+
+static void calculate_point_statistics(const CollectedDataPoint* collected_data_point,
+    const TobiiResearchPoint3D* stimuli_point, Vector3AngleKernel kernel, int robust_statistics, float trim,
+    ComputeScratch* scratch, CalibrationValidationPoint* point) {
+    clear_point_robust_statistics(point);
+
+    /* Calculate mean points */
+    TobiiResearchPoint3D gaze_origin_left_mean;
+    point3_set_zero(&gaze_origin_left_mean);
+    TobiiResearchPoint3D gaze_origin_right_mean;
+    point3_set_zero(&gaze_origin_right_mean);
+    TobiiResearchPoint3D gaze_point_left_mean;
+    point3_set_zero(&gaze_point_left_mean);
+    TobiiResearchPoint3D gaze_point_right_mean;
+    point3_set_zero(&gaze_point_right_mean);
+
+    for (SampleBlock* block = collected_data_point->first_block; block; block = block->next) {
+        for (size_t k = 0; k < block->count; ++k) {
+            TobiiResearchPoint3D point;
+
+            point3_arrays_get(&point, &block->gaze_origin_left, k);
+            point3_add(&gaze_origin_left_mean, &point);
+            point3_arrays_get(&point, &block->gaze_origin_right, k);
+            point3_add(&gaze_origin_right_mean, &point);
+            point3_arrays_get(&point, &block->gaze_point_left, k);
+            point3_add(&gaze_point_left_mean, &point);
+            point3_arrays_get(&point, &block->gaze_point_right, k);
+            point3_add(&gaze_point_right_mean, &point);
+        }
+    }
+    float denominator_factor = 1.0f / collected_data_point->gaze_data_count;
+    point3_mul(&gaze_origin_left_mean, denominator_factor);
+    point3_mul(&gaze_origin_right_mean, denominator_factor);
+    point3_mul(&gaze_point_left_mean, denominator_factor);
+    point3_mul(&gaze_point_right_mean, denominator_factor);
+
+    /* Calculate gaze vectors needed for validation statistics, as four arrays of vectors followed by the angles
+     * in the scratch memory. */
+    size_t count = collected_data_point->gaze_data_count;
+    if (scratch->capacity < count) {
+        free(scratch->values);
+        scratch->values = malloc(13 * count * sizeof(*scratch->values));
+        scratch->capacity = count;
+    }
+    float* values = scratch->values;
+    Point3Arrays direction_gaze_point_left_all;
+    point3_arrays_init(&direction_gaze_point_left_all, values, count);
+    Point3Arrays direction_gaze_point_left_mean_all;
+    point3_arrays_init(&direction_gaze_point_left_mean_all, values + 3 * count, count);
+    Point3Arrays direction_gaze_point_right_all;
+    point3_arrays_init(&direction_gaze_point_right_all, values + 6 * count, count);
+    Point3Arrays direction_gaze_point_right_mean_all;
+    point3_arrays_init(&direction_gaze_point_right_mean_all, values + 9 * count, count);
+    float* angles = values + 12 * count;
+
+    size_t j = 0;
+    for (SampleBlock* block = collected_data_point->first_block; block; block = block->next) {
+        create_directions(&direction_gaze_point_left_all, &direction_gaze_point_left_mean_all, j,
+            &block->gaze_origin_left, &block->gaze_point_left, &gaze_point_left_mean, block->count);
+        create_directions(&direction_gaze_point_right_all, &direction_gaze_point_right_mean_all, j,
+            &block->gaze_origin_right, &block->gaze_point_right, &gaze_point_right_mean, block->count);
+        j += block->count;
+    }
+    vector3_normalize_batch(&direction_gaze_point_left_all, count);
+    vector3_normalize_batch(&direction_gaze_point_left_mean_all, count);
+    vector3_normalize_batch(&direction_gaze_point_right_all, count);
+    vector3_normalize_batch(&direction_gaze_point_right_mean_all, count);
+
+    /* Accuracy calculations */
+    float accuracy_left_eye = calculate_eye_accuracy(
+        &gaze_origin_left_mean, &gaze_point_left_mean, stimuli_point, kernel);
+    float accuracy_right_eye = calculate_eye_accuracy(
+        &gaze_origin_right_mean, &gaze_point_right_mean, stimuli_point, kernel);
+
+    /* Precision calculations. The robust statistics reuse the angles each calculation leaves behind. */
+    float precision_left_eye = calculate_eye_precision(
+        &direction_gaze_point_left_all, &direction_gaze_point_left_mean_all, count, kernel, angles);
+    if (robust_statistics) {
+        point->precision_mad_left_eye = order_statistics_mad(angles, count);
+    }
+    float precision_right_eye = calculate_eye_precision(
+        &direction_gaze_point_right_all, &direction_gaze_point_right_mean_all, count, kernel, angles);
+    if (robust_statistics) {
+        point->precision_mad_right_eye = order_statistics_mad(angles, count);
+    }
+
+    /* RMS precision calculations */
+    float precision_rms_left_eye = calculate_eye_precision_rms(&direction_gaze_point_left_all, count, kernel, angles);
+    if (robust_statistics) {
+        point->precision_rms_trimmed_left_eye = calculate_eye_precision_rms_trimmed(count, trim, angles);
+    }
+    float precision_rms_right_eye = calculate_eye_precision_rms(&direction_gaze_point_right_all, count, kernel,
+        angles);
+    if (robust_statistics) {
+        point->precision_rms_trimmed_right_eye = calculate_eye_precision_rms_trimmed(count, trim, angles);
+    }
+
+    if (robust_statistics) {
+        /* The directions to the mean gaze points are not needed anymore, replace them with the directions to the
+         * stimuli point. */
+        j = 0;
+        for (SampleBlock* block = collected_data_point->first_block; block; block = block->next) {
+            create_target_directions(&direction_gaze_point_left_mean_all, j, &block->gaze_origin_left, stimuli_point,
+                block->count);
+            create_target_directions(&direction_gaze_point_right_mean_all, j, &block->gaze_origin_right,
+                stimuli_point, block->count);
+            j += block->count;
+        }
+        calculate_eye_accuracy_robust(&direction_gaze_point_left_all, &direction_gaze_point_left_mean_all, count,
+            kernel, trim, angles, &point->accuracy_median_left_eye, &point->accuracy_trimmed_left_eye);
+        calculate_eye_accuracy_robust(&direction_gaze_point_right_all, &direction_gaze_point_right_mean_all, count,
+            kernel, trim, angles, &point->accuracy_median_right_eye, &point->accuracy_trimmed_right_eye);
+    }
+
+    point->accuracy_left_eye = accuracy_left_eye;
+    point->accuracy_right_eye = accuracy_right_eye;
+    point->precision_left_eye = precision_left_eye;
+    point->precision_right_eye = precision_right_eye;
+    point->precision_rms_left_eye = precision_rms_left_eye;
+    point->precision_rms_right_eye = precision_rms_right_eye;
+}
+
+static void calculate_point_statistics_online(const CollectedDataPoint* collected_data_point,
+    const TobiiResearchPoint3D* stimuli_point, Vector3AngleKernel kernel, CalibrationValidationPoint* point) {
+    point->accuracy_left_eye = eye_statistics_accuracy(&collected_data_point->left_eye_statistics, stimuli_point,
+        kernel);
+    point->accuracy_right_eye = eye_statistics_accuracy(&collected_data_point->right_eye_statistics, stimuli_point,
+        kernel);
+    point->precision_left_eye = eye_statistics_precision(&collected_data_point->left_eye_statistics);
+    point->precision_right_eye = eye_statistics_precision(&collected_data_point->right_eye_statistics);
+    point->precision_rms_left_eye = eye_statistics_precision_rms(&collected_data_point->left_eye_statistics);
+    point->precision_rms_right_eye = eye_statistics_precision_rms(&collected_data_point->right_eye_statistics);
+}
+
+static float calculate_eye_accuracy(const TobiiResearchPoint3D* gaze_origin_mean,
+    const TobiiResearchPoint3D* gaze_point_mean, const TobiiResearchPoint3D* stimuli_point, Vector3AngleKernel kernel) {
+    TobiiResearchVector3D direction_gaze_point;
+    TobiiResearchVector3D direction_target;
+    vector3_create_from_points(&direction_gaze_point, gaze_origin_mean, gaze_point_mean);
+    vector3_normalize(&direction_gaze_point);
+    vector3_create_from_points(&direction_target, gaze_origin_mean, stimuli_point);
+    vector3_normalize(&direction_target);
+    return vector3_angle_with(kernel, &direction_gaze_point, &direction_target);
+}
+
+static void create_directions(Point3Arrays* direction_gaze_point_all, Point3Arrays* direction_gaze_point_mean_all,
+    size_t offset, const Point3Arrays* gaze_origin, const Point3Arrays* gaze_point,
+    const TobiiResearchPoint3D* gaze_point_mean, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        direction_gaze_point_all->x[offset + i] = gaze_point->x[i] - gaze_origin->x[i];
+        direction_gaze_point_all->y[offset + i] = gaze_point->y[i] - gaze_origin->y[i];
+        direction_gaze_point_all->z[offset + i] = gaze_point->z[i] - gaze_origin->z[i];
+        direction_gaze_point_mean_all->x[offset + i] = gaze_point_mean->x - gaze_origin->x[i];
+        direction_gaze_point_mean_all->y[offset + i] = gaze_point_mean->y - gaze_origin->y[i];
+        direction_gaze_point_mean_all->z[offset + i] = gaze_point_mean->z - gaze_origin->z[i];
+    }
+}
+
+static void create_target_directions(Point3Arrays* direction_target_all, size_t offset,
+    const Point3Arrays* gaze_origin, const TobiiResearchPoint3D* stimuli_point, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        direction_target_all->x[offset + i] = stimuli_point->x - gaze_origin->x[i];
+        direction_target_all->y[offset + i] = stimuli_point->y - gaze_origin->y[i];
+        direction_target_all->z[offset + i] = stimuli_point->z - gaze_origin->z[i];
+    }
+}
+
+static float calculate_eye_precision(const Point3Arrays* direction_gaze_point_all,
+    const Point3Arrays* direction_gaze_point_mean_all, size_t vector_count, Vector3AngleKernel kernel, float* angles) {
+    vector3_angle_batch_with(kernel, angles, direction_gaze_point_all, direction_gaze_point_mean_all, vector_count);
+    float variance = 0.0f;
+    for (size_t i = 0; i < vector_count; ++i) {
+        variance += angles[i]*angles[i];
+    }
+    variance /= vector_count;
+    float standard_deviation = (float)sqrt(variance);
+    return standard_deviation;
+}
+
+static float calculate_eye_precision_rms(const Point3Arrays* direction_gaze_point_all, size_t vector_count,
+    Vector3AngleKernel kernel, float* angles) {
+    Point3Arrays direction_gaze_point_next_all;
+    point3_arrays_offset(&direction_gaze_point_next_all, direction_gaze_point_all, 1);
+    vector3_angle_batch_with(kernel, angles, direction_gaze_point_all, &direction_gaze_point_next_all,
+        vector_count - 1);
+    float variance = 0.0f;
+    for (size_t i = 0; i < vector_count - 1; ++i) {
+        variance += angles[i]*angles[i];
     }
     variance /= vector_count - 1;
     float rms = (float)sqrt(variance);
     return rms;
 }
+
+static void calculate_eye_accuracy_robust(const Point3Arrays* direction_gaze_point_all,
+    Point3Arrays* direction_target_all, size_t vector_count, Vector3AngleKernel kernel, float trim, float* angles,
+    float* accuracy_median, float* accuracy_trimmed) {
+    vector3_normalize_batch(direction_target_all, vector_count);
+    vector3_angle_batch_with(kernel, angles, direction_gaze_point_all, direction_target_all, vector_count);
+    /* Both are independent of the order the median leaves the angles in. */
+    *accuracy_median = order_statistics_median(angles, vector_count);
+    *accuracy_trimmed = order_statistics_trimmed_mean(angles, vector_count, trim);
+}
+
+static float calculate_eye_precision_rms_trimmed(size_t vector_count, float trim, float* angles) {
+    /* The sample-to-sample angles left behind by calculate_eye_precision_rms. */
+    for (size_t i = 0; i < vector_count - 1; ++i) {
+        angles[i] = angles[i]*angles[i];
+    }
+    return (float)sqrt(order_statistics_trimmed_mean(angles, vector_count - 1, trim));
+}
+
+static void clear_point_robust_statistics(CalibrationValidationPoint* point) {
+    point->accuracy_median_left_eye = NAN;
+    point->accuracy_median_right_eye = NAN;
+    point->accuracy_trimmed_left_eye = NAN;
+    point->accuracy_trimmed_right_eye = NAN;
+    point->precision_mad_left_eye = NAN;
+    point->precision_mad_right_eye = NAN;
+    point->precision_rms_trimmed_left_eye = NAN;
+    point->precision_rms_trimmed_right_eye = NAN;
+}
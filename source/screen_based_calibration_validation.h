@@ -100,8 +100,392 @@ typedef enum {
     Internal error.
     */
     CALIBRATION_VALIDATION_STATUS_INTERNAL_ERROR,
+
+    /**
+    Invalid option or option value argument.
+    */
+    CALIBRATION_VALIDATION_STATUS_INVALID_OPTION,
+
+    /**
+    A gaze recording file could not be created, written or read as a recording.
+    */
+    CALIBRATION_VALIDATION_STATUS_INVALID_RECORDING,
+
+    /**
+    Invalid number of worker threads for a calibration validation manager.
+    */
+    CALIBRATION_VALIDATION_STATUS_INVALID_WORKER_COUNT,
+
+    /**
+    A trace file could not be written.
+    */
+    CALIBRATION_VALIDATION_STATUS_INVALID_TRACE,
+
+    /**
+    Invalid stimulus plan argument, i.e. no points or a settle time out of range.
+    */
+    CALIBRATION_VALIDATION_STATUS_INVALID_PLAN,
+
+    /**
+    Invalid export format or no sink, or the sink failed to write the export.
+    */
+    CALIBRATION_VALIDATION_STATUS_INVALID_EXPORT,
 } CalibrationValidationStatus;
 
+/**
+Options controlling how a calibration validator collects data and computes results.
+See @ref tobii_research_screen_based_calibration_validation_set_option.
+*/
+typedef enum {
+    /**
+    Boolean, default 0. When enabled the statistics of a point are updated as each valid sample is collected and
+    @ref tobii_research_screen_based_calibration_validation_compute only finalizes them, so its cost no longer
+    grows with the number of samples. Accuracy and RMS precision are unchanged. The standard deviation precision
+    is measured about the mean gaze direction from the mean gaze origin rather than from each sample's gaze
+    origin, which differs by the gaze origin movement during the collection.
+    */
+    CALIBRATION_VALIDATION_OPTION_ONLINE_STATISTICS,
+
+    /**
+    Boolean, default 0. By default only the gaze origins, gaze points and time stamps needed for the metrics are
+    stored for each sample. When enabled the complete gaze data samples are kept as well and returned in
+    @ref CalibrationValidationPoint.
+    */
+    CALIBRATION_VALIDATION_OPTION_RETAIN_GAZE_DATA,
+
+    /**
+    A @ref CalibrationValidationResultGazeData value, default @ref CALIBRATION_VALIDATION_RESULT_GAZE_DATA_COPY.
+    Selects how @ref tobii_research_screen_based_calibration_validation_compute returns the retained gaze data
+    samples of each point. Only has an effect if @ref CALIBRATION_VALIDATION_OPTION_RETAIN_GAZE_DATA is enabled.
+    */
+    CALIBRATION_VALIDATION_OPTION_RESULT_GAZE_DATA,
+
+    /**
+    Number of threads, default 1, maximum 64. The points of a result are computed independently of each other by
+    @ref tobii_research_screen_based_calibration_validation_compute. With more than one thread they are spread
+    over that many worker threads owned by the validator, while the calling thread waits. The averages are summed
+    in point order on the calling thread, so the result is identical for any number of threads.
+    */
+    CALIBRATION_VALIDATION_OPTION_COMPUTE_THREADS,
+
+    /**
+    A @ref CalibrationValidationAngleKernel value, default @ref CALIBRATION_VALIDATION_ANGLE_KERNEL_REFERENCE.
+    Selects how the angles behind accuracy and precision are computed. Only
+    @ref CALIBRATION_VALIDATION_ANGLE_KERNEL_ATAN2 and @ref CALIBRATION_VALIDATION_ANGLE_KERNEL_FAST compute the
+    angles of the samples with SIMD instructions, the others compute them one at a time.
+    */
+    CALIBRATION_VALIDATION_OPTION_ANGLE_KERNEL,
+
+    /**
+    Boolean, default 0. When enabled the gaze data callback and
+    @ref tobii_research_screen_based_calibration_validation_compute are timed for the duration histograms of
+    @ref CalibrationValidationStats, which reads the clock twice more for each gaze data sample. Otherwise the
+    histograms stay empty and only the counters are updated.
+    */
+    CALIBRATION_VALIDATION_OPTION_DURATION_HISTOGRAMS,
+
+    /**
+    A @ref CalibrationValidationTiming value, default @ref CALIBRATION_VALIDATION_TIMING_STOPWATCH. Selects how
+    the timeout of a data collection is measured.
+    */
+    CALIBRATION_VALIDATION_OPTION_TIMING,
+
+    /**
+    Boolean, default 0. When enabled @ref tobii_research_screen_based_calibration_validation_compute also computes
+    the robust statistics of each point, which a few outlying samples, e.g. at the edges of blinks, hardly
+    affect. See @ref CalibrationValidationPoint. They are not computed with
+    @ref CALIBRATION_VALIDATION_OPTION_ONLINE_STATISTICS.
+    */
+    CALIBRATION_VALIDATION_OPTION_ROBUST_STATISTICS,
+
+    /**
+    Percentage of the samples removed at each end for the trimmed means of the robust statistics, default 10,
+    maximum 49.
+    */
+    CALIBRATION_VALIDATION_OPTION_TRIM_PERCENTAGE,
+
+    /**
+    Number of most recent valid samples monitored by
+    @ref tobii_research_screen_based_calibration_validation_start_monitoring, default 600, minimum 10, maximum
+    3000.
+    */
+    CALIBRATION_VALIDATION_OPTION_MONITOR_WINDOW,
+} CalibrationValidationOption;
+
+/**
+Values of @ref CALIBRATION_VALIDATION_OPTION_RESULT_GAZE_DATA.
+*/
+typedef enum {
+    /**
+    Each point of the result gets its own copy of the gaze data samples, owned by the result.
+    */
+    CALIBRATION_VALIDATION_RESULT_GAZE_DATA_COPY,
+
+    /**
+    The gaze data samples are left out of the result, for callers only interested in the metrics.
+    */
+    CALIBRATION_VALIDATION_RESULT_GAZE_DATA_NONE,
+
+    /**
+    Each point of the result refers to the gaze data samples stored in the validator. Nothing is copied, but the
+    samples are only valid until the next call to
+    @ref tobii_research_screen_based_calibration_validation_compute,
+    @ref tobii_research_screen_based_calibration_validation_discard_collected_data,
+    @ref tobii_research_screen_based_calibration_validation_clear_collected_data,
+    @ref tobii_research_screen_based_calibration_validation_leave_validation_mode or
+    @ref tobii_research_screen_based_calibration_validation_destroy for the same validator. They must not be
+    modified.
+    */
+    CALIBRATION_VALIDATION_RESULT_GAZE_DATA_VIEW,
+} CalibrationValidationResultGazeData;
+
+/**
+Values of @ref CALIBRATION_VALIDATION_OPTION_ANGLE_KERNEL, from most accurate to fastest. The error bounds are
+relative to the exact angle between the gaze directions.
+*/
+typedef enum {
+    /**
+    The arccosine of the normalized dot product in double precision. Within 1e-5 degrees.
+    */
+    CALIBRATION_VALIDATION_ANGLE_KERNEL_REFERENCE,
+
+    /**
+    The arccosine of the dot product in double precision, relying on the gaze directions being normalized already.
+    Within 1e-3 degrees between 1 and 179 degrees, but only within 0.05 degrees for smaller angles since the
+    normalized directions are not of exactly unit length.
+    */
+    CALIBRATION_VALIDATION_ANGLE_KERNEL_NORMALIZED,
+
+    /**
+    atan2 of the cross and dot products, which stays accurate for small angles. In double precision for accuracy
+    and the online statistics, within 1e-5 degrees, and vectorized in single precision for the precision of the
+    samples, within 1e-4 degrees.
+    */
+    CALIBRATION_VALIDATION_ANGLE_KERNEL_ATAN2,
+
+    /**
+    atan2 of the cross and dot products, vectorized in single precision with a shorter approximation of the
+    arctangent. Within 1e-3 degrees.
+    */
+    CALIBRATION_VALIDATION_ANGLE_KERNEL_FAST,
+} CalibrationValidationAngleKernel;
+
+/**
+Values of @ref CALIBRATION_VALIDATION_OPTION_TIMING.
+*/
+typedef enum {
+    /**
+    The timeout is measured on the thread delivering gaze data, from when the first gaze data sample of the data
+    collection is received until each following sample is received, with microsecond resolution. For a point of a
+    plan, the first sample is the first one taken after its settle time. The first sample received after the
+    timeout ends the data collection. Without one, the data collection only times out 100 milliseconds after the
+    timeout, counted from the first sample, or from the start of the data collection plus the settle time if no
+    sample is received.
+    */
+    CALIBRATION_VALIDATION_TIMING_STOPWATCH,
+
+    /**
+    Only gaze data samples with a system time stamp from the call to
+    @ref tobii_research_screen_based_calibration_validation_start_collecting_data until the timeout after it are
+    collected, to the microsecond. Samples taken before the call but received after it are ignored, and the first
+    sample taken after the timeout ends the data collection. Since gaze data is received some time after it is
+    taken, the data collection only times out without such a sample 100 milliseconds after the timeout.
+    */
+    CALIBRATION_VALIDATION_TIMING_TIME_STAMPS,
+} CalibrationValidationTiming;
+
+/**
+How a data collection ended, see @ref tobii_research_screen_based_calibration_validation_wait_for_data_collection.
+*/
+typedef enum {
+    /**
+    The data collection has not ended yet.
+    */
+    CALIBRATION_VALIDATION_COLLECTION_RESULT_ONGOING,
+
+    /**
+    The requested number of valid samples was collected.
+    */
+    CALIBRATION_VALIDATION_COLLECTION_RESULT_COMPLETED,
+
+    /**
+    The timeout passed before the requested number of valid samples was collected.
+    */
+    CALIBRATION_VALIDATION_COLLECTION_RESULT_TIMED_OUT,
+} CalibrationValidationCollectionResult;
+
+/**
+Called when a data collection ends, see @ref tobii_research_screen_based_calibration_validation_set_collection_callback.
+
+@param result: @ref CALIBRATION_VALIDATION_COLLECTION_RESULT_COMPLETED or
+@ref CALIBRATION_VALIDATION_COLLECTION_RESULT_TIMED_OUT.
+@param user_data: The user data given when setting the callback.
+*/
+typedef void (*CalibrationValidationCollectionCallback)(CalibrationValidationCollectionResult result, void* user_data);
+
+/**
+A point of a stimulus plan, see @ref tobii_research_screen_based_calibration_validation_start_plan.
+*/
+typedef struct {
+    /**
+    The 2D coordinates of the stimuli point (in Active Display Coordinate System).
+    */
+    TobiiResearchNormalizedPoint2D screen_point;
+    /**
+    Time in milliseconds from when the stimulus moves to the point until data is collected for it, to let the
+    stimulus be drawn and the gaze reach it. Minimum 0, maximum 3000.
+    */
+    int settle_time;
+} CalibrationValidationPlanPoint;
+
+/**
+Called when a stimulus plan moves on to a point, see
+@ref tobii_research_screen_based_calibration_validation_set_target_callback.
+
+@param index: Index of the point in the plan.
+@param screen_point: The point the stimulus should be moved to.
+@param user_data: The user data given when setting the callback.
+*/
+typedef void (*CalibrationValidationTargetCallback)(size_t index, const TobiiResearchNormalizedPoint2D* screen_point,
+    void* user_data);
+
+/**
+Formats of @ref tobii_research_screen_based_calibration_validation_export.
+*/
+typedef enum {
+    /**
+    Compact binary format, all values little-endian. A header of the four characters "TVEX", then as uint32 the
+    format version (1), the flags (bit 0 set if samples are included), the number of points, the total number of
+    samples included and a reserved zero, followed by the six averages of @ref CalibrationValidationResult as
+    float32. Then for each point, the screen point x and y as float32, timed_out and the number of samples collected
+    as uint32, and the fourteen metrics of @ref CalibrationValidationPoint as float32 in declaration order. If
+    samples are included, the point is followed by its samples, each the device and system time stamps as int64 and
+    the left gaze origin, left gaze point, right gaze origin and right gaze point in user coordinates as three
+    float32 each.
+    */
+    CALIBRATION_VALIDATION_EXPORT_FORMAT_BINARY,
+
+    /**
+    Newline-delimited JSON. A first line of type "validation" with the format version and the averages, then one
+    line of type "point" per point with its metrics, each followed by one line of type "sample" per sample if
+    samples are included. Metrics that are NaN are written as null.
+    */
+    CALIBRATION_VALIDATION_EXPORT_FORMAT_JSON,
+} CalibrationValidationExportFormat;
+
+/**
+Receives the data of an export, see @ref tobii_research_screen_based_calibration_validation_export. Called with
+at most 64 KiB at a time, in order, e.g. to write it to a file.
+
+@param data: The next bytes of the export.
+@param size: Number of bytes.
+@param user_data: The user data given to the export.
+@returns 0 if all bytes were written, otherwise nonzero to abort the export.
+*/
+typedef int (*CalibrationValidationExportSink)(const void* data, size_t size, void* user_data);
+
+/**
+Number of buckets of the duration histograms in @ref CalibrationValidationStats. Bucket 0 counts durations below
+1 microsecond and bucket i durations of at least 2^(i-1) but less than 2^i microseconds. The last bucket also
+counts all longer durations, i.e. from about 4 seconds.
+*/
+#define CALIBRATION_VALIDATION_STATS_BUCKET_COUNT (24)
+
+/**
+Counters describing what a calibration validator has done since it was initialized or the counters were reset,
+see @ref tobii_research_screen_based_calibration_validation_get_stats.
+*/
+typedef struct {
+    /**
+    Number of gaze data samples received from the eye tracker.
+    */
+    size_t gaze_data_count;
+    /**
+    Number of gaze data samples received while not collecting data, or taken outside of the data collection with
+    @ref CALIBRATION_VALIDATION_TIMING_TIME_STAMPS, which are ignored.
+    */
+    size_t idle_gaze_data_count;
+    /**
+    Number of gaze data samples received while collecting data but not used since the gaze point of either eye
+    was invalid.
+    */
+    size_t invalid_gaze_data_count;
+    /**
+    Number of gaze data samples received while collecting data but dropped since too many samples were waiting to
+    be processed by the application thread. Data collection waits at the current point meanwhile.
+    */
+    size_t dropped_gaze_data_count;
+    /**
+    Number of data collections that collected the requested number of valid samples.
+    */
+    size_t completed_collection_count;
+    /**
+    Number of data collections that timed out.
+    */
+    size_t timed_out_collection_count;
+    /**
+    Number of successful calls to @ref tobii_research_screen_based_calibration_validation_compute.
+    */
+    size_t compute_count;
+    /**
+    Histogram of the time spent handling each gaze data sample on the thread delivering gaze data. Empty unless
+    @ref CALIBRATION_VALIDATION_OPTION_DURATION_HISTOGRAMS is enabled.
+    */
+    size_t gaze_data_callback_durations[CALIBRATION_VALIDATION_STATS_BUCKET_COUNT];
+    /**
+    Histogram of the durations of the successful calls to
+    @ref tobii_research_screen_based_calibration_validation_compute. Empty unless
+    @ref CALIBRATION_VALIDATION_OPTION_DURATION_HISTOGRAMS is enabled.
+    */
+    size_t compute_durations[CALIBRATION_VALIDATION_STATS_BUCKET_COUNT];
+} CalibrationValidationStats;
+
+/**
+Accuracy and precision over the most recent samples while monitoring, see
+@ref tobii_research_screen_based_calibration_validation_get_monitor_result.
+*/
+typedef struct {
+    /**
+    The 2D coordinates of the monitored point (in Active Display Coordinate System).
+    */
+    TobiiResearchNormalizedPoint2D screen_point;
+    /**
+    Number of valid samples the values are computed from, at most
+    @ref CALIBRATION_VALIDATION_OPTION_MONITOR_WINDOW. Zero before any valid sample is received for the point, when
+    all values are NaN.
+    */
+    size_t sample_count;
+    /**
+    System time stamp of the most recent sample, in microseconds.
+    */
+    int64_t system_time_stamp;
+    /**
+    The accuracy in degrees for the left eye.
+    */
+    float accuracy_left_eye;
+    /**
+    The accuracy in degrees for the right eye.
+    */
+    float accuracy_right_eye;
+    /**
+    The precision (standard deviation) in degrees for the left eye. Measured about the mean gaze direction from the
+    mean gaze origin, as with @ref CALIBRATION_VALIDATION_OPTION_ONLINE_STATISTICS.
+    */
+    float precision_left_eye;
+    /**
+    The precision (standard deviation) in degrees for the right eye.
+    */
+    float precision_right_eye;
+    /**
+    The precision (root mean square of sample-to-sample error) in degrees for the left eye.
+    */
+    float precision_rms_left_eye;
+    /**
+    The precision (root mean square of sample-to-sample error) in degrees for the right eye.
+    */
+    float precision_rms_right_eye;
+} CalibrationValidationMonitorResult;
+
 /**
 Represents a collected point that goes into the calibration validation. It contains calculated values
 for accuracy and precision as well as the original gaze samples collected for the point.
@@ -141,13 +525,51 @@ typedef struct {
     TobiiResearchNormalizedPoint2D screen_point;
     /**
     The gaze data samples collected for this point. These samples are the base for the
-    calculated accuracy and precision.
+    calculated accuracy and precision. NULL unless @ref CALIBRATION_VALIDATION_OPTION_RETAIN_GAZE_DATA is enabled,
+    see also @ref CALIBRATION_VALIDATION_OPTION_RESULT_GAZE_DATA.
     */
     TobiiResearchGazeData* gaze_data;
     /**
-    Number of gaze data samples collected for this point.
+    Number of gaze data samples collected for this point. Zero if gaze_data is NULL.
     */
     size_t gaze_data_count;
+    /**
+    The median of the angles in degrees between the gaze direction of each sample and the direction from its gaze
+    origin to the point, for the left eye. The robust statistics are NaN unless
+    @ref CALIBRATION_VALIDATION_OPTION_ROBUST_STATISTICS is enabled.
+    */
+    float accuracy_median_left_eye;
+    /**
+    The median angle in degrees between the gaze direction of each sample and the point, for the right eye.
+    */
+    float accuracy_median_right_eye;
+    /**
+    The trimmed mean of the angles in degrees between the gaze direction of each sample and the point, for the left
+    eye. See @ref CALIBRATION_VALIDATION_OPTION_TRIM_PERCENTAGE.
+    */
+    float accuracy_trimmed_left_eye;
+    /**
+    The trimmed mean angle in degrees between the gaze direction of each sample and the point, for the right eye.
+    */
+    float accuracy_trimmed_right_eye;
+    /**
+    The precision (median absolute deviation) in degrees for the left eye. The deviation of the angles between each
+    gaze direction and the mean gaze direction from their median, scaled by 1.4826 to compare to a standard
+    deviation.
+    */
+    float precision_mad_left_eye;
+    /**
+    The precision (median absolute deviation) in degrees for the right eye.
+    */
+    float precision_mad_right_eye;
+    /**
+    The precision (root of the trimmed mean of the squared sample-to-sample errors) in degrees for the left eye.
+    */
+    float precision_rms_trimmed_left_eye;
+    /**
+    The precision (root of the trimmed mean of the squared sample-to-sample errors) in degrees for the right eye.
+    */
+    float precision_rms_trimmed_right_eye;
 } CalibrationValidationPoint;
 
 /**
@@ -188,10 +610,20 @@ typedef struct {
     Number of points collected in result.
     */
     size_t points_count;
+    /**
+    Size in bytes of the single block holding the result, followed by its points and the gaze data samples copied
+    for them. See @ref tobii_research_screen_based_calibration_validation_relocate_result.
+    */
+    size_t size;
 } CalibrationValidationResult;
 
 /**
 Opaque representation of a calibration validator struct.
+
+Gaze data delivered by the eye tracker is only queued on the SDK thread, where the end of a data collection is
+also detected. The queued samples are processed on the thread calling the validator functions, e.g.
+@ref tobii_research_screen_based_calibration_validation_is_collecting_data.
+The validator functions must not be called concurrently for the same validator.
 */
 typedef struct CalibrationValidator CalibrationValidator;
 
@@ -221,6 +653,22 @@ TOBII_RESEARCH_API CalibrationValidationStatus TOBII_RESEARCH_CALL
     tobii_research_screen_based_calibration_validation_init_default(
         const char* address, CalibrationValidator** validator);
 
+/**
+@brief Initialize a calibration validator struct that replays a gaze recording instead of using an eye tracker.
+See @ref tobii_research_screen_based_calibration_validation_start_recording and
+@ref tobii_research_screen_based_calibration_validation_replay. The display area is taken from the recording.
+
+@param path: Path of the recording file.
+@param sample_count: The number of samples to collect. Default 30, minimum 10, maximum 3000.
+@param timeout: Timeout in milliseconds. Default 1000, minimum 100, maximum 3000.
+@param validator: Calibration validator struct returned. Should be destroyed by user using
+@ref tobii_research_screen_based_calibration_validation_destroy when done.
+@returns A @ref CalibrationValidationStatus code.
+*/
+TOBII_RESEARCH_API CalibrationValidationStatus TOBII_RESEARCH_CALL
+    tobii_research_screen_based_calibration_validation_init_replay(
+        const char* path, size_t sample_count, int timeout, CalibrationValidator** validator);
+
 /**
 @brief Destroy a calibration validator struct (i.e. free used memory).
 After this operation the validator struct cannot be used.
@@ -234,6 +682,8 @@ TOBII_RESEARCH_API CalibrationValidationStatus TOBII_RESEARCH_CALL
 
 /**
 @brief Enter the calibration validation mode and starts subscribing to gaze data from the eye tracker.
+The display area is read from the eye tracker once and then followed through its change notifications, so that
+nothing else in validation mode has to wait for the eye tracker.
 
 @param validator: Calibration validator struct pointer returned during initialization.
 @returns A @ref CalibrationValidationStatus code.
@@ -267,7 +717,34 @@ TOBII_RESEARCH_API CalibrationValidationStatus TOBII_RESEARCH_CALL
         CalibrationValidator* validator, const TobiiResearchNormalizedPoint2D* screen_point);
 
 /**
-@brief Clear all collected data.
+@brief Starts collecting data for a sequence of calibration validation points. The validator moves on to the next
+point by itself, on the thread delivering gaze data, the moment the data collection for a point ends. It then
+notifies the target callback, see @ref tobii_research_screen_based_calibration_validation_set_target_callback,
+and waits for the settle time of the point before collecting data for it. The time stamp of the sample that ended
+the previous point starts the settle time.
+
+The validator is collecting data until the last point ends. Each point ends, and notifies the collection callback,
+like a data collection started with @ref tobii_research_screen_based_calibration_validation_start_collecting_data,
+and is stored the same way. If gaze data stops arriving, the plan stops at the point being collected 100
+milliseconds after it times out.
+
+The samples are stored by the application thread, so keep processing gaze data while the plan runs, for example
+with @ref tobii_research_screen_based_calibration_validation_wait_for_data_collection. About 3.4 seconds of gaze
+data at 1200 Hz can wait to be stored. Once that much is waiting, the plan waits at the current point and the
+samples received meanwhile are counted as dropped, see @ref CalibrationValidationStats.
+
+@param validator: Calibration validator struct pointer returned during initialization.
+@param points: The points in the order to collect them, copied by the validator.
+@param points_count: Number of points, at least one.
+@returns A @ref CalibrationValidationStatus code.
+*/
+TOBII_RESEARCH_API CalibrationValidationStatus TOBII_RESEARCH_CALL
+    tobii_research_screen_based_calibration_validation_start_plan(
+        CalibrationValidator* validator, const CalibrationValidationPlanPoint* points, size_t points_count);
+
+/**
+@brief Clear all collected data. Can be called during data collection, which goes on and stores the point being
+collected when it ends as usual.
 
 @param validator: Calibration validator struct pointer returned during initialization.
 @returns A @ref CalibrationValidationStatus code.
@@ -277,7 +754,9 @@ TOBII_RESEARCH_API CalibrationValidationStatus TOBII_RESEARCH_CALL
         CalibrationValidator* validator);
 
 /**
-@brief Removes the collected data for a specific calibration validation point.
+@brief Removes the collected data for a specific calibration validation point. Can be called during data
+collection. If data is being collected for the same point, only the data of earlier data collections is removed,
+the data of the ongoing one is stored when it ends.
 
 @param validator: Calibration validator struct pointer returned during initialization.
 @param screen_point: The calibration point to remove.
@@ -293,6 +772,14 @@ If there are insufficient data to compute the results for a certain point that @
 will contain invalid data (NaN) for the results. Gaze data will still be untouched. If there are no valid data
 for any point, the average results of @ref CalibrationValidationResult will be invalid (NaN) as well.
 
+Can be called during data collection, e.g. to show the results of the points done so far while the next one is
+being collected. The result then contains the points whose data collection has ended, the point being collected
+is left out. Gaze data keeps being received and queued meanwhile, and is processed once compute returns.
+@ref CALIBRATION_VALIDATION_STATUS_NO_DATA_COLLECTED is returned if no data collection has ended yet.
+
+The result, its points and the gaze data samples copied for them are allocated as one block of the size given
+in the result.
+
 @param validator: Calibration validator struct pointer returned during initialization.
 @param result: Calibration validation result struct returned. Should be destroyed by user using
 @ref tobii_research_screen_based_calibration_validation_destroy_result when done.
@@ -312,6 +799,68 @@ TOBII_RESEARCH_API void TOBII_RESEARCH_CALL
     tobii_research_screen_based_calibration_validation_destroy_result(
         CalibrationValidationResult* result);
 
+/**
+@brief Make a result that was copied as a whole refer to its own points and gaze data samples, e.g. after copying
+size bytes of it with memcpy, moving it with realloc or writing it to shared memory. Gaze data samples returned
+as a @ref CALIBRATION_VALIDATION_RESULT_GAZE_DATA_VIEW are not part of the block and keep referring to the
+validator. Only the copy is read, so the original may already be destroyed. A copy is freed by whoever allocated
+it, and with @ref tobii_research_screen_based_calibration_validation_destroy_result only if it was allocated with
+malloc or realloc.
+
+@param result: The copy of a calibration validation result struct returned by
+@ref tobii_research_screen_based_calibration_validation_compute.
+*/
+TOBII_RESEARCH_API void TOBII_RESEARCH_CALL
+    tobii_research_screen_based_calibration_validation_relocate_result(
+        CalibrationValidationResult* result);
+
+/**
+@brief Export the collected data with the same statistics as
+@ref tobii_research_screen_based_calibration_validation_compute, written straight from the validator without
+creating a result. Only the points that changed since the last compute or export are calculated. The export is
+handed to the sink in chunks through a fixed buffer, so its memory use does not depend on the number of points
+or samples. Like compute, it can be called during data collection and then leaves out the point being collected.
+
+The samples included are the valid samples the statistics are calculated from, with the fields needed by them,
+regardless of @ref CALIBRATION_VALIDATION_OPTION_RETAIN_GAZE_DATA.
+
+@param validator: Calibration validator struct pointer returned during initialization.
+@param format: The format to write, see @ref CalibrationValidationExportFormat.
+@param include_samples: Nonzero to include the samples of each point.
+@param sink: Function receiving the export.
+@param user_data: Passed to the sink.
+@returns A @ref CalibrationValidationStatus code. @ref CALIBRATION_VALIDATION_STATUS_INVALID_EXPORT if the sink
+failed, in which case the export is incomplete.
+*/
+TOBII_RESEARCH_API CalibrationValidationStatus TOBII_RESEARCH_CALL
+    tobii_research_screen_based_calibration_validation_export(
+        CalibrationValidator* validator, CalibrationValidationExportFormat format, int include_samples,
+        CalibrationValidationExportSink sink, void* user_data);
+
+/**
+@brief Set an option on a calibration validator. Options can only be changed when not in validation mode.
+
+@param validator: Calibration validator struct pointer returned during initialization.
+@param option: The @ref CalibrationValidationOption to set.
+@param value: The new value of the option.
+@returns A @ref CalibrationValidationStatus code.
+*/
+TOBII_RESEARCH_API CalibrationValidationStatus TOBII_RESEARCH_CALL
+    tobii_research_screen_based_calibration_validation_set_option(
+        CalibrationValidator* validator, CalibrationValidationOption option, int value);
+
+/**
+@brief Get the current value of an option of a calibration validator.
+
+@param validator: Calibration validator struct pointer returned during initialization.
+@param option: The @ref CalibrationValidationOption to get.
+@param value: The value of the option returned.
+@returns A @ref CalibrationValidationStatus code.
+*/
+TOBII_RESEARCH_API CalibrationValidationStatus TOBII_RESEARCH_CALL
+    tobii_research_screen_based_calibration_validation_get_option(
+        CalibrationValidator* validator, CalibrationValidationOption option, int* value);
+
 /**
 @brief Check if calibration validator is in validation mode.
 
@@ -332,6 +881,183 @@ TOBII_RESEARCH_API int TOBII_RESEARCH_CALL
     tobii_research_screen_based_calibration_validation_is_collecting_data(
         CalibrationValidator* validator);
 
+/**
+@brief Wait until the ongoing data collection ends, instead of polling
+@ref tobii_research_screen_based_calibration_validation_is_collecting_data.
+Returns as soon as the last sample needed is received or the timeout of the data collection passes. For a stimulus
+plan, waits until its last point ends and returns how that point ended.
+
+@param validator: Calibration validator struct pointer returned during initialization.
+@param timeout: Maximum time to wait in milliseconds, or -1 to wait until the data collection ends.
+@param result: How the data collection ended returned, @ref CALIBRATION_VALIDATION_COLLECTION_RESULT_ONGOING if it
+did not end within timeout. If not collecting data, how the last data collection ended.
+@returns A @ref CalibrationValidationStatus code. @ref CALIBRATION_VALIDATION_STATUS_NO_DATA_COLLECTED if no
+data collection was started since entering validation mode.
+*/
+TOBII_RESEARCH_API CalibrationValidationStatus TOBII_RESEARCH_CALL
+    tobii_research_screen_based_calibration_validation_wait_for_data_collection(
+        CalibrationValidator* validator, int timeout, CalibrationValidationCollectionResult* result);
+
+/**
+@brief Set a callback to be called the moment a data collection ends. Cannot be changed during data collection.
+
+The callback is called on the thread delivering gaze data, or on the thread calling the validator functions if
+the data collection timed out while no gaze data was received. It must return quickly and must not call any
+validator function. It is meant to wake up the application, which then continues with the validator as usual.
+
+@param validator: Calibration validator struct pointer returned during initialization.
+@param callback: Function to call, or NULL to remove the callback.
+@param user_data: Passed to the callback.
+@returns A @ref CalibrationValidationStatus code.
+*/
+TOBII_RESEARCH_API CalibrationValidationStatus TOBII_RESEARCH_CALL
+    tobii_research_screen_based_calibration_validation_set_collection_callback(
+        CalibrationValidator* validator, CalibrationValidationCollectionCallback callback, void* user_data);
+
+/**
+@brief Set a callback to be called when a stimulus plan moves on to a point, so that the application can move the
+stimulus. Cannot be changed during data collection.
+
+For the first point of a plan, the callback is called by
+@ref tobii_research_screen_based_calibration_validation_start_plan before data collection starts. For the other
+points, it is called on the thread delivering gaze data, right after the collection callback for the previous
+point. It must return quickly and must not call any validator function.
+
+@param validator: Calibration validator struct pointer returned during initialization.
+@param callback: Function to call, or NULL to remove the callback.
+@param user_data: Passed to the callback.
+@returns A @ref CalibrationValidationStatus code.
+*/
+TOBII_RESEARCH_API CalibrationValidationStatus TOBII_RESEARCH_CALL
+    tobii_research_screen_based_calibration_validation_set_target_callback(
+        CalibrationValidator* validator, CalibrationValidationTargetCallback callback, void* user_data);
+
+/**
+@brief Start recording all gaze data received and every stimuli point data is collected for to a binary file,
+together with the display area. The recording can be replayed using
+@ref tobii_research_screen_based_calibration_validation_init_replay. Recording can only be started when not in
+validation mode and goes on until stopped or the validator is destroyed.
+
+@param validator: Calibration validator struct pointer returned during initialization.
+@param path: Path of the recording file to create.
+@returns A @ref CalibrationValidationStatus code.
+*/
+TOBII_RESEARCH_API CalibrationValidationStatus TOBII_RESEARCH_CALL
+    tobii_research_screen_based_calibration_validation_start_recording(
+        CalibrationValidator* validator, const char* path);
+
+/**
+@brief Stop recording gaze data. Can only be called when not in validation mode. The recording is written by a
+thread of its own and gaze data that does not fit in its buffer while the file is written too slowly is dropped.
+
+@param validator: Calibration validator struct pointer returned during initialization.
+@returns A @ref CalibrationValidationStatus code, @ref CALIBRATION_VALIDATION_STATUS_INVALID_RECORDING if gaze
+data was dropped or the file could not be written. The recording is kept up to the last record written.
+*/
+TOBII_RESEARCH_API CalibrationValidationStatus TOBII_RESEARCH_CALL
+    tobii_research_screen_based_calibration_validation_stop_recording(
+        CalibrationValidator* validator);
+
+/**
+@brief Replay the recording of a validator created with
+@ref tobii_research_screen_based_calibration_validation_init_replay. Data is collected for each recorded stimuli
+point from the gaze data recorded after it, just as during the recording. Must be in validation mode and not
+collecting data. The collected data is then available through
+@ref tobii_research_screen_based_calibration_validation_compute as usual.
+
+Data collection timeouts are measured with the system time stamps of the recorded gaze data as with
+@ref CALIBRATION_VALIDATION_TIMING_TIME_STAMPS, regardless of the option, so that they happen at the same
+samples regardless of the speed.
+
+@param validator: Calibration validator struct pointer returned during initialization.
+@param speed: Playback speed relative to the recording, e.g. 1 for real time or 0 for as fast as possible.
+@returns A @ref CalibrationValidationStatus code.
+*/
+TOBII_RESEARCH_API CalibrationValidationStatus TOBII_RESEARCH_CALL
+    tobii_research_screen_based_calibration_validation_replay(
+        CalibrationValidator* validator, float speed);
+
+/**
+@brief Get the counters of a calibration validator. They are updated without locking while gaze data is received,
+so the counters read are each exact but not necessarily from the same moment. Can be called in any state.
+
+@param validator: Calibration validator struct pointer returned during initialization.
+@param stats: The counters returned.
+@returns A @ref CalibrationValidationStatus code.
+*/
+TOBII_RESEARCH_API CalibrationValidationStatus TOBII_RESEARCH_CALL
+    tobii_research_screen_based_calibration_validation_get_stats(
+        CalibrationValidator* validator, CalibrationValidationStats* stats);
+
+/**
+@brief Set all counters of a calibration validator to zero. Can be called in any state.
+
+@param validator: Calibration validator struct pointer returned during initialization.
+@returns A @ref CalibrationValidationStatus code.
+*/
+TOBII_RESEARCH_API CalibrationValidationStatus TOBII_RESEARCH_CALL
+    tobii_research_screen_based_calibration_validation_reset_stats(
+        CalibrationValidator* validator);
+
+/**
+@brief Start monitoring the accuracy and precision for a point the user is assumed to be looking at, e.g. a
+fixation target during a recording, to watch for calibration drift. Unlike a data collection, monitoring goes on
+until stopped and only considers the most recent valid samples, see @ref CALIBRATION_VALIDATION_OPTION_MONITOR_WINDOW.
+Each sample is accounted for in constant time on the thread delivering gaze data, so monitoring can go on for
+hours with constant memory and CPU use.
+
+Must be in validation mode. Data can be collected meanwhile. Calling it again while monitoring moves on to
+another point, starting over with no samples.
+
+@param validator: Calibration validator struct pointer returned during initialization.
+@param screen_point: The normalized 2D point on the display area.
+@returns A @ref CalibrationValidationStatus code.
+*/
+TOBII_RESEARCH_API CalibrationValidationStatus TOBII_RESEARCH_CALL
+    tobii_research_screen_based_calibration_validation_start_monitoring(
+        CalibrationValidator* validator, const TobiiResearchNormalizedPoint2D* screen_point);
+
+/**
+@brief Stop monitoring. The last monitor result stays available. Leaving validation mode also stops monitoring.
+
+@param validator: Calibration validator struct pointer returned during initialization.
+@returns A @ref CalibrationValidationStatus code.
+*/
+TOBII_RESEARCH_API CalibrationValidationStatus TOBII_RESEARCH_CALL
+    tobii_research_screen_based_calibration_validation_stop_monitoring(
+        CalibrationValidator* validator);
+
+/**
+@brief Get the latest accuracy and precision while monitoring, updated with every valid sample received. Unlike
+the other validator functions it can be called from any thread, also while another thread calls them, except
+@ref tobii_research_screen_based_calibration_validation_set_option and
+@ref tobii_research_screen_based_calibration_validation_destroy. It never waits for the thread delivering gaze
+data.
+
+@param validator: Calibration validator struct pointer returned during initialization.
+@param result: The latest monitor result returned.
+@returns A @ref CalibrationValidationStatus code.
+*/
+TOBII_RESEARCH_API CalibrationValidationStatus TOBII_RESEARCH_CALL
+    tobii_research_screen_based_calibration_validation_get_monitor_result(
+        CalibrationValidator* validator, CalibrationValidationMonitorResult* result);
+
+/**
+@brief Write a timeline of what all calibration validators have done to a file, in the Chrome trace event JSON
+format that chrome://tracing and Perfetto open. It shows entering and leaving validation mode, each data
+collection, each phase of @ref tobii_research_screen_based_calibration_validation_compute including every point
+on the thread computing it, and @ref tobii_research_screen_based_calibration_validation_destroy_result.
+
+Tracing is only compiled in if the library is built with CALIBRATION_VALIDATION_TRACE defined, e.g. with
+make TRACE=1. Otherwise the trace is empty. Each thread records at most 16384 spans.
+
+@param path: Path of the trace file to create.
+@returns A @ref CalibrationValidationStatus code.
+*/
+TOBII_RESEARCH_API CalibrationValidationStatus TOBII_RESEARCH_CALL
+    tobii_research_screen_based_calibration_validation_write_trace(
+        const char* path);
+
 #ifdef __cplusplus
 }
 #endif
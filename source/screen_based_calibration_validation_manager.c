@@ -0,0 +1,181 @@
+/*
+Copyright 2019 Tobii Pro AB
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "screen_based_calibration_validation_manager.h"
+#include "worker_pool.h"
+
+#define WORKER_COUNT_DEFAULT_MAX (8)
+#define WORKER_COUNT_MAX (64)
+
+/* Everything is owned by the application thread. The worker threads only run the jobs of a batch started by a
+ * manager function, each job using the validator of one eye tracker, so no validator is used concurrently. */
+struct CalibrationValidationManager {
+    WorkerPool* worker_pool;
+
+    /* Status of every eye tracker, in the order they were added. */
+    CalibrationValidationEyeTrackerStatus* statuses;
+    size_t statuses_count;
+    size_t statuses_capacity;
+};
+
+
+static void update_status(CalibrationValidationEyeTrackerStatus* status);
+static void update_status_job(void* context, size_t index);
+static void compute_job(void* context, size_t index);
+
+
+CalibrationValidationStatus tobii_research_screen_based_calibration_validation_manager_init(
+    size_t worker_count, CalibrationValidationManager** manager) {
+    if (worker_count > WORKER_COUNT_MAX) {
+        return CALIBRATION_VALIDATION_STATUS_INVALID_WORKER_COUNT;
+    }
+    if (worker_count == 0) {
+        worker_count = worker_pool_processor_count();
+        if (worker_count > WORKER_COUNT_DEFAULT_MAX) {
+            worker_count = WORKER_COUNT_DEFAULT_MAX;
+        }
+    }
+
+    *manager = malloc(sizeof(CalibrationValidationManager));
+    (*manager)->worker_pool = worker_pool_init(worker_count);
+    (*manager)->statuses = NULL;
+    (*manager)->statuses_count = 0;
+    (*manager)->statuses_capacity = 0;
+
+    return CALIBRATION_VALIDATION_STATUS_OK;
+}
+
+CalibrationValidationStatus tobii_research_screen_based_calibration_validation_manager_destroy(
+    CalibrationValidationManager* manager) {
+    for (size_t i = 0; i < manager->statuses_count; ++i) {
+        if (tobii_research_screen_based_calibration_validation_is_collecting_data(manager->statuses[i].validator)) {
+            return CALIBRATION_VALIDATION_STATUS_OPERATION_NOT_ALLOWED_DURING_DATA_COLLECTION;
+        }
+    }
+
+    while (manager->statuses_count > 0) {
+        CalibrationValidationStatus status =
+            tobii_research_screen_based_calibration_validation_manager_remove_eyetracker(
+                manager, manager->statuses[manager->statuses_count - 1].validator);
+        if (status != CALIBRATION_VALIDATION_STATUS_OK) {
+            return status;
+        }
+    }
+
+    worker_pool_destroy(manager->worker_pool);
+    free(manager->statuses);
+    free(manager);
+
+    return CALIBRATION_VALIDATION_STATUS_OK;
+}
+
+CalibrationValidationStatus tobii_research_screen_based_calibration_validation_manager_add_eyetracker(
+    CalibrationValidationManager* manager, const char* address, size_t sample_count, int timeout,
+    CalibrationValidator** validator) {
+    CalibrationValidationStatus status = tobii_research_screen_based_calibration_validation_init(
+        address, sample_count, timeout, validator);
+    if (status != CALIBRATION_VALIDATION_STATUS_OK) {
+        return status;
+    }
+
+    if (manager->statuses_count == manager->statuses_capacity) {
+        manager->statuses_capacity = manager->statuses_capacity ? 2 * manager->statuses_capacity : 8;
+        manager->statuses = realloc(manager->statuses, manager->statuses_capacity * sizeof(*manager->statuses));
+    }
+    CalibrationValidationEyeTrackerStatus* eyetracker_status = &manager->statuses[manager->statuses_count++];
+    eyetracker_status->validator = *validator;
+    eyetracker_status->compute_status = CALIBRATION_VALIDATION_STATUS_NO_DATA_COLLECTED;
+    eyetracker_status->result = NULL;
+    update_status(eyetracker_status);
+
+    return CALIBRATION_VALIDATION_STATUS_OK;
+}
+
+CalibrationValidationStatus tobii_research_screen_based_calibration_validation_manager_remove_eyetracker(
+    CalibrationValidationManager* manager, CalibrationValidator* validator) {
+    size_t index = 0;
+    while (index < manager->statuses_count && manager->statuses[index].validator != validator) {
+        index++;
+    }
+    if (index == manager->statuses_count) {
+        return CALIBRATION_VALIDATION_STATUS_INVALID_EYETRACKER;
+    }
+
+    CalibrationValidationStatus status = tobii_research_screen_based_calibration_validation_destroy(validator);
+    if (status != CALIBRATION_VALIDATION_STATUS_OK) {
+        return status;
+    }
+    tobii_research_screen_based_calibration_validation_destroy_result(manager->statuses[index].result);
+
+    memmove(&manager->statuses[index], &manager->statuses[index + 1],
+        (manager->statuses_count - index - 1) * sizeof(*manager->statuses));
+    manager->statuses_count--;
+
+    return CALIBRATION_VALIDATION_STATUS_OK;
+}
+
+CalibrationValidationStatus tobii_research_screen_based_calibration_validation_manager_compute(
+    CalibrationValidationManager* manager) {
+    worker_pool_run(manager->worker_pool, compute_job, manager->statuses, manager->statuses_count);
+    return CALIBRATION_VALIDATION_STATUS_OK;
+}
+
+CalibrationValidationStatus tobii_research_screen_based_calibration_validation_manager_get_status(
+    CalibrationValidationManager* manager, const CalibrationValidationEyeTrackerStatus** statuses,
+    size_t* count) {
+    worker_pool_run(manager->worker_pool, update_status_job, manager->statuses, manager->statuses_count);
+    *statuses = manager->statuses;
+    *count = manager->statuses_count;
+    return CALIBRATION_VALIDATION_STATUS_OK;
+}
+
+static void update_status(CalibrationValidationEyeTrackerStatus* status) {
+    /* Waiting without a timeout processes the queued gaze data and reports how the last data collection ended. */
+    CalibrationValidationCollectionResult collection_result = CALIBRATION_VALIDATION_COLLECTION_RESULT_ONGOING;
+    CalibrationValidationStatus wait_status =
+        tobii_research_screen_based_calibration_validation_wait_for_data_collection(
+            status->validator, 0, &collection_result);
+    if (wait_status != CALIBRATION_VALIDATION_STATUS_OK) {
+        collection_result = CALIBRATION_VALIDATION_COLLECTION_RESULT_ONGOING;
+    }
+
+    status->validation_mode = tobii_research_screen_based_calibration_validation_is_validation_mode(
+        status->validator);
+    status->collecting_data = tobii_research_screen_based_calibration_validation_is_collecting_data(
+        status->validator);
+    status->collection_result = status->collecting_data ?
+        CALIBRATION_VALIDATION_COLLECTION_RESULT_ONGOING : collection_result;
+}
+
+static void update_status_job(void* context, size_t index) {
+    update_status(&((CalibrationValidationEyeTrackerStatus*)context)[index]);
+}
+
+static void compute_job(void* context, size_t index) {
+    CalibrationValidationEyeTrackerStatus* status = &((CalibrationValidationEyeTrackerStatus*)context)[index];
+
+    tobii_research_screen_based_calibration_validation_destroy_result(status->result);
+    status->result = NULL;
+    status->compute_status = tobii_research_screen_based_calibration_validation_compute(
+        status->validator, &status->result);
+    if (status->compute_status != CALIBRATION_VALIDATION_STATUS_OK) {
+        status->result = NULL;
+    }
+    update_status(status);
+}
@@ -0,0 +1,158 @@
+/*
+Copyright 2019 Tobii Pro AB
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+/**
+ * @file screen_based_calibration_validation_manager.h
+ * @brief <b>Validate calibrations of several eye trackers at once.</b>
+ *
+ */
+
+#ifndef SCREEN_BASED_CALIBRATION_VALIDATION_MANAGER_H_
+#define SCREEN_BASED_CALIBRATION_VALIDATION_MANAGER_H_
+
+#include "screen_based_calibration_validation.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+Status of an eye tracker owned by a calibration validation manager, as of the last call to
+@ref tobii_research_screen_based_calibration_validation_manager_get_status or
+@ref tobii_research_screen_based_calibration_validation_manager_compute.
+*/
+typedef struct {
+    /**
+    The calibration validator of the eye tracker, owned by the manager.
+    */
+    CalibrationValidator* validator;
+    /**
+    A boolean indicating if in validation mode.
+    */
+    int validation_mode;
+    /**
+    A boolean indicating if data is collected.
+    */
+    int collecting_data;
+    /**
+    How the last data collection ended, @ref CALIBRATION_VALIDATION_COLLECTION_RESULT_ONGOING if collecting data or
+    no data collection was started since entering validation mode.
+    */
+    CalibrationValidationCollectionResult collection_result;
+    /**
+    Status of the last @ref tobii_research_screen_based_calibration_validation_manager_compute for the eye tracker.
+    */
+    CalibrationValidationStatus compute_status;
+    /**
+    Result of the last @ref tobii_research_screen_based_calibration_validation_manager_compute for the eye tracker,
+    NULL if it failed. Owned by the manager, valid until the next compute or until the eye tracker is removed.
+    */
+    CalibrationValidationResult* result;
+} CalibrationValidationEyeTrackerStatus;
+
+/**
+Opaque representation of a calibration validation manager struct.
+
+A manager owns the calibration validators of several eye trackers and processes their gaze data and computes
+their results on a fixed number of shared worker threads. The validators are otherwise used as usual through the
+calibration validator functions. The manager functions and the validator functions of its validators must not be
+called concurrently.
+*/
+typedef struct CalibrationValidationManager CalibrationValidationManager;
+
+/**
+@brief Initialize a calibration validation manager struct.
+
+@param worker_count: Number of worker threads. Zero for one per processor, at most 8. Maximum 64.
+@param manager: Calibration validation manager struct returned. Should be destroyed by user using
+@ref tobii_research_screen_based_calibration_validation_manager_destroy when done.
+@returns A @ref CalibrationValidationStatus code.
+*/
+TOBII_RESEARCH_API CalibrationValidationStatus TOBII_RESEARCH_CALL
+    tobii_research_screen_based_calibration_validation_manager_init(
+        size_t worker_count, CalibrationValidationManager** manager);
+
+/**
+@brief Destroy a calibration validation manager struct and the calibration validators of all its eye trackers.
+Not allowed while any of them is collecting data. After this operation the manager struct cannot be used.
+
+@param manager: Calibration validation manager struct pointer returned during initialization.
+@returns A @ref CalibrationValidationStatus code.
+*/
+TOBII_RESEARCH_API CalibrationValidationStatus TOBII_RESEARCH_CALL
+    tobii_research_screen_based_calibration_validation_manager_destroy(
+        CalibrationValidationManager* manager);
+
+/**
+@brief Add an eye tracker to a calibration validation manager. See
+@ref tobii_research_screen_based_calibration_validation_init for the arguments.
+
+@param manager: Calibration validation manager struct pointer returned during initialization.
+@param address: Address of eye tracker to get data for.
+@param sample_count: The number of samples to collect. Default 30, minimum 10, maximum 3000.
+@param timeout: Timeout in milliseconds. Default 1000, minimum 100, maximum 3000.
+@param validator: Calibration validator struct of the eye tracker returned. Owned by the manager, it must not be
+destroyed by the user.
+@returns A @ref CalibrationValidationStatus code.
+*/
+TOBII_RESEARCH_API CalibrationValidationStatus TOBII_RESEARCH_CALL
+    tobii_research_screen_based_calibration_validation_manager_add_eyetracker(
+        CalibrationValidationManager* manager, const char* address, size_t sample_count, int timeout,
+        CalibrationValidator** validator);
+
+/**
+@brief Remove an eye tracker from a calibration validation manager and destroy its calibration validator.
+
+@param manager: Calibration validation manager struct pointer returned during initialization.
+@param validator: Calibration validator struct of the eye tracker returned when it was added.
+@returns A @ref CalibrationValidationStatus code. @ref CALIBRATION_VALIDATION_STATUS_INVALID_EYETRACKER if the
+validator does not belong to the manager.
+*/
+TOBII_RESEARCH_API CalibrationValidationStatus TOBII_RESEARCH_CALL
+    tobii_research_screen_based_calibration_validation_manager_remove_eyetracker(
+        CalibrationValidationManager* manager, CalibrationValidator* validator);
+
+/**
+@brief Compute the results of all eye trackers, in parallel on the worker threads. The status and result of each
+eye tracker are returned by
+@ref tobii_research_screen_based_calibration_validation_manager_get_status.
+
+@param manager: Calibration validation manager struct pointer returned during initialization.
+@returns A @ref CalibrationValidationStatus code.
+*/
+TOBII_RESEARCH_API CalibrationValidationStatus TOBII_RESEARCH_CALL
+    tobii_research_screen_based_calibration_validation_manager_compute(
+        CalibrationValidationManager* manager);
+
+/**
+@brief Process the gaze data received by all eye trackers on the worker threads and get their status.
+
+@param manager: Calibration validation manager struct pointer returned during initialization.
+@param statuses: Status of each eye tracker returned, in the order they were added. Owned by the manager, valid
+until the next call to a manager function.
+@param count: Number of eye trackers returned.
+@returns A @ref CalibrationValidationStatus code.
+*/
+TOBII_RESEARCH_API CalibrationValidationStatus TOBII_RESEARCH_CALL
+    tobii_research_screen_based_calibration_validation_manager_get_status(
+        CalibrationValidationManager* manager, const CalibrationValidationEyeTrackerStatus** statuses,
+        size_t* count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* SCREEN_BASED_CALIBRATION_VALIDATION_MANAGER_H_ */
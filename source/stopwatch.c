@@ -37,6 +37,12 @@ static long diff_milliseconds(LARGE_INTEGER* timespan, LARGE_INTEGER* freq) {
     return (long)elapsed.QuadPart;
 }
 
+static int64_t diff_nanoseconds(LARGE_INTEGER* timespan, LARGE_INTEGER* freq) {
+    /* Split to not overflow for long timespans. */
+    return timespan->QuadPart / freq->QuadPart * 1000000000 +
+        timespan->QuadPart % freq->QuadPart * 1000000000 / freq->QuadPart;
+}
+
 Stopwatch* stopwatch_init() {
     Stopwatch *instance = malloc(sizeof(*instance));
     QueryPerformanceFrequency(&instance->freq);
@@ -75,6 +81,22 @@ long stopwatch_elapsed(Stopwatch* instance) {
     return diff_milliseconds(&accumulated_time, &instance->freq);
 }
 
+int64_t stopwatch_elapsed_us(Stopwatch* instance) {
+    return stopwatch_elapsed_ns(instance) / 1000;
+}
+
+int64_t stopwatch_elapsed_ns(Stopwatch* instance) {
+    if (!instance->running) {
+        return 0;
+    }
+    LARGE_INTEGER accumulated_time;
+    LARGE_INTEGER current_time;
+    QueryPerformanceCounter(&current_time);
+    accumulated_time.QuadPart = instance->total_time.QuadPart;
+    accumulated_time.QuadPart += current_time.QuadPart - instance->last_start_time.QuadPart;
+    return diff_nanoseconds(&accumulated_time, &instance->freq);
+}
+
 void stopwatch_reset(Stopwatch* instance) {
     instance->total_time.QuadPart = 0;
     instance->running = 0;
@@ -126,6 +148,20 @@ long stopwatch_elapsed(Stopwatch* instance) {
         (now.tv_usec - instance->start.tv_usec) / 1000;
 }
 
+int64_t stopwatch_elapsed_us(Stopwatch* instance) {
+    return stopwatch_elapsed_ns(instance) / 1000;
+}
+
+int64_t stopwatch_elapsed_ns(Stopwatch* instance) {
+    if (!instance->running) {
+        return 0;
+    }
+    struct timeval now;
+    gettimeofday(&now, NULL);
+    return instance->total_time * (int64_t)1000000 + (now.tv_sec - instance->start.tv_sec) * (int64_t)1000000000 +
+        (now.tv_usec - instance->start.tv_usec) * (int64_t)1000;
+}
+
 void stopwatch_reset(Stopwatch* instance) {
     instance->total_time = 0;
     instance->running = 0;
@@ -177,6 +213,20 @@ long stopwatch_elapsed(Stopwatch* instance) {
         (now.tv_nsec - instance->start.tv_nsec) / 1000000;
 }
 
+int64_t stopwatch_elapsed_us(Stopwatch* instance) {
+    return stopwatch_elapsed_ns(instance) / 1000;
+}
+
+int64_t stopwatch_elapsed_ns(Stopwatch* instance) {
+    if (!instance->running) {
+        return 0;
+    }
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return instance->total_time * (int64_t)1000000 + (now.tv_sec - instance->start.tv_sec) * (int64_t)1000000000 +
+        (now.tv_nsec - instance->start.tv_nsec);
+}
+
 void stopwatch_reset(Stopwatch* instance) {
     instance->total_time = 0;
     instance->running = 0;
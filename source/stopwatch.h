@@ -17,6 +17,8 @@ limitations under the License.
 #ifndef STOPWATCH_H_
 #define STOPWATCH_H_
 
+#include <stdint.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -27,6 +29,9 @@ extern Stopwatch* stopwatch_init();
 extern void stopwatch_start(Stopwatch* instance);
 extern long stopwatch_stop(Stopwatch* instance);
 extern long stopwatch_elapsed(Stopwatch* instance);
+/* Like stopwatch_elapsed but in microseconds or nanoseconds, without truncating to whole milliseconds. */
+extern int64_t stopwatch_elapsed_us(Stopwatch* instance);
+extern int64_t stopwatch_elapsed_ns(Stopwatch* instance);
 extern void stopwatch_reset(Stopwatch* instance);
 
 #ifdef __cplusplus
@@ -0,0 +1,55 @@
+/*
+Copyright 2019 Tobii Pro AB
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#ifndef TEST_H_
+#define TEST_H_
+
+#include <stdarg.h>
+#include <stdio.h>
+
+/* Checks shared by the test programs, run with "make test". Every failed check is reported, a test program
+ * returns test_result() from main so that any failure fails the run. Only included by the test programs. */
+
+static int test_failures_count = 0;
+
+static void test_fail(const char* file, int line, const char* format, ...) {
+    va_list arguments;
+    va_start(arguments, format);
+    fprintf(stderr, "%s:%d: ", file, line);
+    vfprintf(stderr, format, arguments);
+    fprintf(stderr, "\n");
+    va_end(arguments);
+    test_failures_count++;
+}
+
+#define TEST_CHECK(condition) \
+    do { \
+        if (!(condition)) { \
+            test_fail(__FILE__, __LINE__, "check failed: %s", #condition); \
+        } \
+    } while (0)
+
+static int test_result(const char* name) {
+    if (test_failures_count) {
+        printf("%s: %d checks failed\n", name, test_failures_count);
+        return 1;
+    }
+    printf("%s: passed\n", name);
+    return 0;
+}
+
+#endif  /* TEST_H_ */
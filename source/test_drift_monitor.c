@@ -0,0 +1,167 @@
+/*
+Copyright 2019 Tobii Pro AB
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+/* Tests of the drift monitor, run with "make test". Its sliding window is compared with the statistics of the same
+ * samples computed at once. */
+
+#include <math.h>
+#include <string.h>
+
+#include "drift_monitor.h"
+#include "eye_statistics.h"
+#include "test.h"
+
+#define WINDOW_SIZE (10)
+#define SAMPLES_MAX (20000)
+
+static unsigned int random_state = 1;
+
+/* Uniformly distributed in [-0.5, 0.5]. */
+static float next_noise() {
+    random_state = random_state * 1103515245u + 12345u;
+    return (float)((random_state >> 8) & 0xffff) / 65535.0f - 0.5f;
+}
+
+static TobiiResearchGazeData samples[SAMPLES_MAX];
+
+static void make_sample(TobiiResearchGazeData* gaze_data, const TobiiResearchPoint3D* target, size_t index) {
+    memset(gaze_data, 0, sizeof(*gaze_data));
+    TobiiResearchEyeData* eyes[] = { &gaze_data->left_eye, &gaze_data->right_eye };
+    for (size_t eye = 0; eye < 2; ++eye) {
+        TobiiResearchPoint3D* origin = &eyes[eye]->gaze_origin.position_in_user_coordinates;
+        origin->x = (eye ? 30.0f : -30.0f) + next_noise();
+        origin->y = 170.0f + next_noise();
+        origin->z = 600.0f + next_noise();
+        TobiiResearchPoint3D* point = &eyes[eye]->gaze_point.position_in_user_coordinates;
+        point->x = target->x + 2.0f + 8.0f * next_noise();
+        point->y = target->y - 1.0f + 8.0f * next_noise();
+        point->z = target->z;
+        eyes[eye]->gaze_origin.validity = TOBII_RESEARCH_VALIDITY_VALID;
+        eyes[eye]->gaze_point.validity = TOBII_RESEARCH_VALIDITY_VALID;
+    }
+    gaze_data->system_time_stamp = 1000000 + (int64_t)index * 833;
+    gaze_data->device_time_stamp = gaze_data->system_time_stamp;
+}
+
+static int close_to(float value, float expected) {
+    return fabsf(value - expected) <= 1e-4f + 1e-4f * fabsf(expected);
+}
+
+/* Checks the result against the statistics of the count samples, computed at once. */
+static void check_result(const CalibrationValidationMonitorResult* result, const TobiiResearchGazeData* window,
+    size_t count, const TobiiResearchPoint3D* target, size_t index) {
+    EyeStatistics left;
+    EyeStatistics right;
+    eye_statistics_reset(&left);
+    eye_statistics_reset(&right);
+    for (size_t i = 0; i < count; ++i) {
+        eye_statistics_add(&left, &window[i].left_eye.gaze_origin.position_in_user_coordinates,
+            &window[i].left_eye.gaze_point.position_in_user_coordinates, VECTOR3_ANGLE_KERNEL_REFERENCE);
+        eye_statistics_add(&right, &window[i].right_eye.gaze_origin.position_in_user_coordinates,
+            &window[i].right_eye.gaze_point.position_in_user_coordinates, VECTOR3_ANGLE_KERNEL_REFERENCE);
+    }
+    int same = result->sample_count == count &&
+        result->system_time_stamp == window[count - 1].system_time_stamp &&
+        close_to(result->accuracy_left_eye, eye_statistics_accuracy(&left, target, VECTOR3_ANGLE_KERNEL_REFERENCE)) &&
+        close_to(result->accuracy_right_eye,
+            eye_statistics_accuracy(&right, target, VECTOR3_ANGLE_KERNEL_REFERENCE)) &&
+        close_to(result->precision_left_eye, eye_statistics_precision(&left)) &&
+        close_to(result->precision_right_eye, eye_statistics_precision(&right));
+    if (count > 1) {
+        same = same && close_to(result->precision_rms_left_eye, eye_statistics_precision_rms(&left)) &&
+            close_to(result->precision_rms_right_eye, eye_statistics_precision_rms(&right));
+    } else {
+        same = same && isnan(result->precision_rms_left_eye) && isnan(result->precision_rms_right_eye);
+    }
+    if (!same) {
+        test_fail(__FILE__, __LINE__, "result after sample %zu differs from the statistics of the window", index);
+    }
+}
+
+static void test_sliding_window(void) {
+    /* Over many windows, so that rounding errors of adding and removing samples would show if they built up. */
+    DriftMonitor* monitor = drift_monitor_init(WINDOW_SIZE);
+    TobiiResearchNormalizedPoint2D screen_point = { 0.25f, 0.75f };
+    TobiiResearchPoint3D target = { -125.0f, 95.0f, 20.0f };
+    drift_monitor_set_target(monitor, &screen_point, &target, VECTOR3_ANGLE_KERNEL_REFERENCE);
+    for (size_t i = 0; i < SAMPLES_MAX; ++i) {
+        make_sample(&samples[i], &target, i);
+        drift_monitor_add(monitor, &samples[i]);
+        CalibrationValidationMonitorResult result;
+        drift_monitor_result(monitor, &result);
+        size_t count = i + 1 < WINDOW_SIZE ? i + 1 : WINDOW_SIZE;
+        check_result(&result, &samples[i + 1 - count], count, &target, i);
+        TEST_CHECK(result.screen_point.x == screen_point.x && result.screen_point.y == screen_point.y);
+    }
+    drift_monitor_destroy(monitor);
+}
+
+static void test_target_change(void) {
+    /* A new target starts over with only the samples added after it. */
+    DriftMonitor* monitor = drift_monitor_init(WINDOW_SIZE);
+    TobiiResearchNormalizedPoint2D screen_points[] = { { 0.25f, 0.75f }, { 0.5f, 0.5f } };
+    TobiiResearchPoint3D targets[] = { { -125.0f, 95.0f, 20.0f }, { 0.0f, 170.0f, 20.0f } };
+    drift_monitor_set_target(monitor, &screen_points[0], &targets[0], VECTOR3_ANGLE_KERNEL_REFERENCE);
+    for (size_t i = 0; i < 15; ++i) {
+        make_sample(&samples[i], &targets[0], i);
+        drift_monitor_add(monitor, &samples[i]);
+    }
+    drift_monitor_set_target(monitor, &screen_points[1], &targets[1], VECTOR3_ANGLE_KERNEL_REFERENCE);
+    for (size_t i = 15; i < 18; ++i) {
+        make_sample(&samples[i], &targets[1], i);
+        drift_monitor_add(monitor, &samples[i]);
+    }
+    CalibrationValidationMonitorResult result;
+    drift_monitor_result(monitor, &result);
+    TEST_CHECK(result.screen_point.x == screen_points[1].x && result.screen_point.y == screen_points[1].y);
+    check_result(&result, &samples[15], 3, &targets[1], 17);
+    drift_monitor_destroy(monitor);
+}
+
+static void test_stopped(void) {
+    /* Nothing is monitored before a target is set, and samples added after stopping are ignored. */
+    DriftMonitor* monitor = drift_monitor_init(WINDOW_SIZE);
+    TobiiResearchPoint3D target = { -125.0f, 95.0f, 20.0f };
+    make_sample(&samples[0], &target, 0);
+    drift_monitor_add(monitor, &samples[0]);
+    CalibrationValidationMonitorResult result;
+    drift_monitor_result(monitor, &result);
+    TEST_CHECK(result.sample_count == 0);
+    TEST_CHECK(isnan(result.accuracy_left_eye) && isnan(result.precision_rms_right_eye));
+
+    TobiiResearchNormalizedPoint2D screen_point = { 0.25f, 0.75f };
+    drift_monitor_set_target(monitor, &screen_point, &target, VECTOR3_ANGLE_KERNEL_REFERENCE);
+    for (size_t i = 1; i < 5; ++i) {
+        make_sample(&samples[i], &target, i);
+        drift_monitor_add(monitor, &samples[i]);
+    }
+    drift_monitor_set_target(monitor, NULL, NULL, VECTOR3_ANGLE_KERNEL_REFERENCE);
+    for (size_t i = 5; i < 8; ++i) {
+        make_sample(&samples[i], &target, i);
+        drift_monitor_add(monitor, &samples[i]);
+    }
+    drift_monitor_result(monitor, &result);
+    check_result(&result, &samples[1], 4, &target, 7);
+    drift_monitor_destroy(monitor);
+}
+
+int main(void) {
+    test_sliding_window();
+    test_target_change();
+    test_stopped();
+    return test_result("test_drift_monitor");
+}
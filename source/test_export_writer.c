@@ -0,0 +1,212 @@
+/*
+Copyright 2019 Tobii Pro AB
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+/* Tests of the export writer, run with "make test". The sink keeps every chunk it is handed, so that both the
+ * bytes written and how they were split up can be checked. */
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "export_writer.h"
+#include "test.h"
+
+#define CHUNKS_MAX (16)
+
+typedef struct {
+    unsigned char* data;
+    size_t size;
+    size_t chunk_sizes[CHUNKS_MAX];
+    size_t chunk_count;
+    /* The sink fails on the call with this index. */
+    size_t fail_at;
+} Sink;
+
+static int sink_write(const void* data, size_t size, void* user_data) {
+    Sink* sink = (Sink*)user_data;
+    size_t index = sink->chunk_count++;
+    if (index < CHUNKS_MAX) {
+        sink->chunk_sizes[index] = size;
+    }
+    if (index == sink->fail_at) {
+        return 1;
+    }
+    sink->data = realloc(sink->data, sink->size + size);
+    memcpy(sink->data + sink->size, data, size);
+    sink->size += size;
+    return 0;
+}
+
+static void init_sink(Sink* sink) {
+    memset(sink, 0, sizeof(*sink));
+    sink->fail_at = (size_t)-1;
+}
+
+/* Checks that the sink got the chunks of the given sizes. */
+static void check_chunks(const Sink* sink, const size_t* sizes, size_t count) {
+    int same = sink->chunk_count == count;
+    for (size_t i = 0; same && i < count; ++i) {
+        same = sink->chunk_sizes[i] == sizes[i];
+    }
+    if (!same) {
+        test_fail(__FILE__, __LINE__, "got %zu chunks, expected %zu", sink->chunk_count, count);
+    }
+}
+
+/* Fills the buffer of the writer with size bytes of 'a', without handing them to the sink yet. */
+static void fill(ExportWriter* writer, size_t size) {
+    char* filler = malloc(size);
+    memset(filler, 'a', size);
+    export_writer_write(writer, filler, size);
+    free(filler);
+}
+
+static int is_filler(const unsigned char* data, size_t size) {
+    for (size_t i = 0; i < size; ++i) {
+        if (data[i] != 'a') {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static void test_write(void) {
+    /* Handed to the sink in full buffers, the rest when destroyed. */
+    Sink sink;
+    init_sink(&sink);
+    ExportWriter* writer = export_writer_init(sink_write, &sink);
+    size_t size = 2 * EXPORT_WRITER_BUFFER_SIZE + 100;
+    unsigned char* data = malloc(size);
+    for (size_t i = 0; i < size; ++i) {
+        data[i] = (unsigned char)(i * 7);
+    }
+    export_writer_write(writer, data, 10);
+    export_writer_write(writer, data + 10, size - 10);
+    TEST_CHECK(sink.chunk_count == 2);
+    TEST_CHECK(export_writer_destroy(writer));
+    static const size_t sizes[] = { EXPORT_WRITER_BUFFER_SIZE, EXPORT_WRITER_BUFFER_SIZE, 100 };
+    check_chunks(&sink, sizes, 3);
+    TEST_CHECK(sink.size == size && memcmp(sink.data, data, size) == 0);
+    free(data);
+    free(sink.data);
+}
+
+static void test_little_endian(void) {
+    /* Values are split over two chunks when the buffer fills up in the middle of them. */
+    Sink sink;
+    init_sink(&sink);
+    ExportWriter* writer = export_writer_init(sink_write, &sink);
+    fill(writer, EXPORT_WRITER_BUFFER_SIZE - 2);
+    export_writer_u32(writer, 0x04030201u);
+    export_writer_i64(writer, -2);
+    export_writer_f32(writer, 1.0f);
+    TEST_CHECK(export_writer_destroy(writer));
+    static const size_t sizes[] = { EXPORT_WRITER_BUFFER_SIZE, 14 };
+    check_chunks(&sink, sizes, 2);
+    static const unsigned char expected[] = {
+        0x01, 0x02, 0x03, 0x04,
+        0xfe, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+        0x00, 0x00, 0x80, 0x3f,
+    };
+    TEST_CHECK(sink.size == EXPORT_WRITER_BUFFER_SIZE + 14 &&
+        memcmp(sink.data + EXPORT_WRITER_BUFFER_SIZE - 2, expected, sizeof(expected)) == 0);
+    free(sink.data);
+}
+
+static void test_printf(void) {
+    /* Text that fits, with room for the terminating null character vsnprintf writes, stays in the buffer. Text
+     * that does not is formatted again after handing the buffer to the sink, and never split. */
+    for (size_t room = 4; room <= 7; ++room) {
+        Sink sink;
+        init_sink(&sink);
+        ExportWriter* writer = export_writer_init(sink_write, &sink);
+        fill(writer, EXPORT_WRITER_BUFFER_SIZE - room);
+        export_writer_printf(writer, "%s%d", "abc", 12);
+        TEST_CHECK(export_writer_destroy(writer));
+        size_t filled = EXPORT_WRITER_BUFFER_SIZE - room;
+        if (room > 5) {
+            size_t sizes[] = { filled + 5 };
+            check_chunks(&sink, sizes, 1);
+        } else {
+            size_t sizes[] = { filled, 5 };
+            check_chunks(&sink, sizes, 2);
+        }
+        TEST_CHECK(sink.size == filled + 5 && is_filler(sink.data, filled) &&
+            memcmp(sink.data + filled, "abc12", 5) == 0);
+        free(sink.data);
+    }
+
+    /* Text longer than the buffer fails the export, after what was written before it. */
+    Sink sink;
+    init_sink(&sink);
+    ExportWriter* writer = export_writer_init(sink_write, &sink);
+    fill(writer, 10);
+    export_writer_printf(writer, "%*d", EXPORT_WRITER_BUFFER_SIZE, 1);
+    export_writer_write(writer, "b", 1);
+    TEST_CHECK(!export_writer_destroy(writer));
+    TEST_CHECK(sink.size == 10 && is_filler(sink.data, 10));
+    free(sink.data);
+}
+
+static void test_sink_failure(void) {
+    /* Once the sink fails it is not called again, and the writer reports the failure. */
+    Sink sink;
+    init_sink(&sink);
+    sink.fail_at = 1;
+    ExportWriter* writer = export_writer_init(sink_write, &sink);
+    fill(writer, 3 * EXPORT_WRITER_BUFFER_SIZE);
+    export_writer_printf(writer, "%d", 1);
+    export_writer_u32(writer, 1);
+    TEST_CHECK(!export_writer_destroy(writer));
+    TEST_CHECK(sink.chunk_count == 2);
+    TEST_CHECK(sink.size == EXPORT_WRITER_BUFFER_SIZE);
+    free(sink.data);
+}
+
+static void test_json_f32(void) {
+    /* Read back as the same float, and null if not finite. */
+    static const float values[] = { 0.0f, 0.1f, -1.5f, 3.14159274f, 1e-30f, 3.4e38f };
+    for (size_t i = 0; i < sizeof(values) / sizeof(*values); ++i) {
+        Sink sink;
+        init_sink(&sink);
+        ExportWriter* writer = export_writer_init(sink_write, &sink);
+        export_writer_json_f32(writer, values[i]);
+        export_writer_write(writer, "", 1);
+        TEST_CHECK(export_writer_destroy(writer));
+        TEST_CHECK(strtof((const char*)sink.data, NULL) == values[i]);
+        free(sink.data);
+    }
+    static const float not_finite[] = { NAN, INFINITY, -INFINITY };
+    for (size_t i = 0; i < sizeof(not_finite) / sizeof(*not_finite); ++i) {
+        Sink sink;
+        init_sink(&sink);
+        ExportWriter* writer = export_writer_init(sink_write, &sink);
+        export_writer_json_f32(writer, not_finite[i]);
+        TEST_CHECK(export_writer_destroy(writer));
+        TEST_CHECK(sink.size == 4 && memcmp(sink.data, "null", 4) == 0);
+        free(sink.data);
+    }
+}
+
+int main(void) {
+    test_write();
+    test_little_endian();
+    test_printf();
+    test_sink_failure();
+    test_json_f32();
+    return test_result("test_export_writer");
+}
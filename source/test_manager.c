@@ -0,0 +1,232 @@
+/*
+Copyright 2019 Tobii Pro AB
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+/* Tests of the calibration validation manager and its worker pool, run with "make test". The eye trackers are
+ * stand-ins whose gaze data is delivered on the calling thread. */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "screen_based_calibration_validation_manager.h"
+#include "test.h"
+#include "tobii_research_eyetracker.h"
+#include "worker_pool.h"
+
+#define SAMPLE_COUNT (10)
+#define TIMEOUT (1000)
+#define GAZE_DATA_RATE (1200)
+#define EYETRACKER_COUNT (3)
+
+/* Stand-in for the Tobii Pro SDK. The address of an eye tracker is its index, gaze data is delivered by calling
+ * the callback subscribed for it directly. */
+
+typedef struct {
+    tobii_research_gaze_data_callback callback;
+    void* user_data;
+} Subscription;
+
+static int eyetrackers[EYETRACKER_COUNT];
+static Subscription subscriptions[EYETRACKER_COUNT];
+static int64_t current_time_stamp = 1000000;
+
+static size_t eyetracker_index(TobiiResearchEyeTracker* instance) {
+    return (size_t)((int*)instance - eyetrackers);
+}
+
+TobiiResearchStatus tobii_research_get_eyetracker(const char* address, TobiiResearchEyeTracker** instance) {
+    int index = atoi(address);
+    if (index < 0 || index >= EYETRACKER_COUNT) {
+        return TOBII_RESEARCH_STATUS_FE_NOT_FOUND;
+    }
+    *instance = (TobiiResearchEyeTracker*)&eyetrackers[index];
+    return TOBII_RESEARCH_STATUS_OK;
+}
+
+TobiiResearchStatus tobii_research_subscribe_to_gaze_data(TobiiResearchEyeTracker* instance,
+    tobii_research_gaze_data_callback callback, void* user_data) {
+    subscriptions[eyetracker_index(instance)].callback = callback;
+    subscriptions[eyetracker_index(instance)].user_data = user_data;
+    return TOBII_RESEARCH_STATUS_OK;
+}
+
+TobiiResearchStatus tobii_research_unsubscribe_from_gaze_data(TobiiResearchEyeTracker* instance,
+    tobii_research_gaze_data_callback callback) {
+    (void)callback;
+    subscriptions[eyetracker_index(instance)].callback = NULL;
+    return TOBII_RESEARCH_STATUS_OK;
+}
+
+TobiiResearchStatus tobii_research_get_display_area(TobiiResearchEyeTracker* instance,
+    TobiiResearchDisplayArea* display_area) {
+    (void)instance;
+    display_area->width = 500.0f;
+    display_area->height = 300.0f;
+    display_area->top_left.x = -250.0f;
+    display_area->top_left.y = 320.0f;
+    display_area->top_left.z = 20.0f;
+    display_area->top_right = display_area->top_left;
+    display_area->top_right.x = 250.0f;
+    display_area->bottom_left = display_area->top_left;
+    display_area->bottom_left.y = 20.0f;
+    display_area->bottom_right = display_area->bottom_left;
+    display_area->bottom_right.x = 250.0f;
+    return TOBII_RESEARCH_STATUS_OK;
+}
+
+TobiiResearchStatus tobii_research_subscribe_to_display_area(TobiiResearchEyeTracker* instance,
+    tobii_research_display_area_callback callback, void* user_data) {
+    (void)instance;
+    (void)callback;
+    (void)user_data;
+    return TOBII_RESEARCH_STATUS_OK;
+}
+
+TobiiResearchStatus tobii_research_unsubscribe_from_display_area(TobiiResearchEyeTracker* instance,
+    tobii_research_display_area_callback callback) {
+    (void)instance;
+    (void)callback;
+    return TOBII_RESEARCH_STATUS_OK;
+}
+
+TobiiResearchStatus tobii_research_get_system_time_stamp(int64_t* time_stamp) {
+    *time_stamp = current_time_stamp;
+    return TOBII_RESEARCH_STATUS_OK;
+}
+
+/* Delivers count valid samples looking at the screen point from the eye tracker. */
+static void deliver_gaze_data(size_t eyetracker, const TobiiResearchNormalizedPoint2D* screen_point, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        TobiiResearchGazeData gaze_data;
+        memset(&gaze_data, 0, sizeof(gaze_data));
+        TobiiResearchEyeData* eyes[] = { &gaze_data.left_eye, &gaze_data.right_eye };
+        for (size_t eye = 0; eye < 2; ++eye) {
+            eyes[eye]->gaze_origin.position_in_user_coordinates.x = eye ? 30.0f : -30.0f;
+            eyes[eye]->gaze_origin.position_in_user_coordinates.y = 170.0f;
+            eyes[eye]->gaze_origin.position_in_user_coordinates.z = 600.0f;
+            eyes[eye]->gaze_point.position_in_user_coordinates.x = -250.0f + 500.0f * screen_point->x + (i % 3);
+            eyes[eye]->gaze_point.position_in_user_coordinates.y = 320.0f - 300.0f * screen_point->y;
+            eyes[eye]->gaze_point.position_in_user_coordinates.z = 20.0f;
+            eyes[eye]->gaze_origin.validity = TOBII_RESEARCH_VALIDITY_VALID;
+            eyes[eye]->gaze_point.validity = TOBII_RESEARCH_VALIDITY_VALID;
+        }
+        current_time_stamp += 1000000 / GAZE_DATA_RATE;
+        gaze_data.device_time_stamp = current_time_stamp;
+        gaze_data.system_time_stamp = current_time_stamp;
+        if (subscriptions[eyetracker].callback) {
+            subscriptions[eyetracker].callback(&gaze_data, subscriptions[eyetracker].user_data);
+        }
+    }
+}
+
+static void count_call(void* context, size_t index) {
+    /* Each index is written by a single call, so the counts need no synchronization. */
+    ((int*)context)[index]++;
+}
+
+static void test_worker_pool(void) {
+    /* Every index of a batch is run exactly once, whether there are fewer or more of them than workers. */
+    static const size_t worker_counts[] = { 1, 3 };
+    static const size_t counts[] = { 0, 1, 2, 3, 100 };
+    for (size_t i = 0; i < sizeof(worker_counts) / sizeof(*worker_counts); ++i) {
+        WorkerPool* pool = worker_pool_init(worker_counts[i]);
+        TEST_CHECK(worker_pool_worker_count(pool) == worker_counts[i]);
+        for (size_t j = 0; j < sizeof(counts) / sizeof(*counts); ++j) {
+            int calls[100];
+            memset(calls, 0, sizeof(calls));
+            worker_pool_run(pool, count_call, calls, counts[j]);
+            for (size_t index = 0; index < 100; ++index) {
+                TEST_CHECK(calls[index] == (index < counts[j] ? 1 : 0));
+            }
+        }
+        worker_pool_destroy(pool);
+    }
+    TEST_CHECK(worker_pool_processor_count() >= 1);
+}
+
+static void test_manager(void) {
+    /* Each eye tracker collects a point of its own, which is the only point of its result. */
+    CalibrationValidationManager* manager = NULL;
+    TEST_CHECK(tobii_research_screen_based_calibration_validation_manager_init(2, &manager) ==
+        CALIBRATION_VALIDATION_STATUS_OK);
+    CalibrationValidator* validators[EYETRACKER_COUNT];
+    TobiiResearchNormalizedPoint2D screen_points[EYETRACKER_COUNT];
+    for (size_t i = 0; i < EYETRACKER_COUNT; ++i) {
+        char address[2] = { (char)('0' + i), '\0' };
+        TEST_CHECK(tobii_research_screen_based_calibration_validation_manager_add_eyetracker(manager, address,
+            SAMPLE_COUNT, TIMEOUT, &validators[i]) == CALIBRATION_VALIDATION_STATUS_OK);
+        TEST_CHECK(tobii_research_screen_based_calibration_validation_enter_validation_mode(validators[i]) ==
+            CALIBRATION_VALIDATION_STATUS_OK);
+        screen_points[i].x = 0.1f + 0.4f * i;
+        screen_points[i].y = 0.5f;
+        TEST_CHECK(tobii_research_screen_based_calibration_validation_start_collecting_data(validators[i],
+            &screen_points[i]) == CALIBRATION_VALIDATION_STATUS_OK);
+    }
+
+    const CalibrationValidationEyeTrackerStatus* statuses = NULL;
+    size_t count = 0;
+    TEST_CHECK(tobii_research_screen_based_calibration_validation_manager_get_status(manager, &statuses, &count) ==
+        CALIBRATION_VALIDATION_STATUS_OK);
+    TEST_CHECK(count == EYETRACKER_COUNT);
+    for (size_t i = 0; i < count; ++i) {
+        TEST_CHECK(statuses[i].validator == validators[i]);
+        TEST_CHECK(statuses[i].validation_mode);
+        TEST_CHECK(statuses[i].collecting_data);
+    }
+    /* A manager cannot be destroyed while its eye trackers collect data. */
+    TEST_CHECK(tobii_research_screen_based_calibration_validation_manager_destroy(manager) ==
+        CALIBRATION_VALIDATION_STATUS_OPERATION_NOT_ALLOWED_DURING_DATA_COLLECTION);
+
+    for (size_t i = 0; i < EYETRACKER_COUNT; ++i) {
+        deliver_gaze_data(i, &screen_points[i], SAMPLE_COUNT);
+    }
+    TEST_CHECK(tobii_research_screen_based_calibration_validation_manager_compute(manager) ==
+        CALIBRATION_VALIDATION_STATUS_OK);
+    TEST_CHECK(tobii_research_screen_based_calibration_validation_manager_get_status(manager, &statuses, &count) ==
+        CALIBRATION_VALIDATION_STATUS_OK);
+    TEST_CHECK(count == EYETRACKER_COUNT);
+    for (size_t i = 0; i < count; ++i) {
+        TEST_CHECK(!statuses[i].collecting_data);
+        TEST_CHECK(statuses[i].collection_result == CALIBRATION_VALIDATION_COLLECTION_RESULT_COMPLETED);
+        TEST_CHECK(statuses[i].compute_status == CALIBRATION_VALIDATION_STATUS_OK);
+        if (statuses[i].result) {
+            TEST_CHECK(statuses[i].result->points_count == 1);
+            TEST_CHECK(statuses[i].result->points[0].screen_point.x == screen_points[i].x);
+        } else {
+            test_fail(__FILE__, __LINE__, "no result for eye tracker %zu", i);
+        }
+    }
+
+    /* Removing an eye tracker keeps the others in order. */
+    TEST_CHECK(tobii_research_screen_based_calibration_validation_manager_remove_eyetracker(manager,
+        validators[1]) == CALIBRATION_VALIDATION_STATUS_OK);
+    TEST_CHECK(tobii_research_screen_based_calibration_validation_manager_remove_eyetracker(manager,
+        validators[1]) == CALIBRATION_VALIDATION_STATUS_INVALID_EYETRACKER);
+    TEST_CHECK(tobii_research_screen_based_calibration_validation_manager_get_status(manager, &statuses, &count) ==
+        CALIBRATION_VALIDATION_STATUS_OK);
+    TEST_CHECK(count == EYETRACKER_COUNT - 1);
+    TEST_CHECK(count == EYETRACKER_COUNT - 1 && statuses[0].validator == validators[0] &&
+        statuses[1].validator == validators[2]);
+
+    TEST_CHECK(tobii_research_screen_based_calibration_validation_manager_destroy(manager) ==
+        CALIBRATION_VALIDATION_STATUS_OK);
+}
+
+int main(void) {
+    test_worker_pool();
+    test_manager();
+    return test_result("test_manager");
+}
@@ -0,0 +1,221 @@
+/*
+Copyright 2019 Tobii Pro AB
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+/* Tests of the order statistics against sorting with qsort, run with "make test". The values are multiples of
+ * 1/16 small enough for every sum to be exact, so the results must be equal, not just close. */
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "order_statistics.h"
+#include "test.h"
+
+#define VALUES_MAX (1000)
+/* Same as in order_statistics.c, ranges this small are sorted. */
+#define SELECT_SORT_THRESHOLD (16)
+
+typedef enum {
+    INPUT_RANDOM,
+    INPUT_EQUAL,
+    INPUT_DUPLICATES,
+    INPUT_SORTED,
+    INPUT_REVERSED,
+    INPUT_ADVERSARIAL,
+    INPUT_COUNT,
+} Input;
+
+static const char* input_names[] = { "random", "equal", "duplicates", "sorted", "reversed", "adversarial" };
+
+static unsigned int random_state = 1;
+
+static unsigned int next_random() {
+    random_state = random_state * 1103515245u + 12345u;
+    return (random_state >> 8) & 0xffff;
+}
+
+static int compare_floats(const void* a, const void* b) {
+    float x = *(const float*)a;
+    float y = *(const float*)b;
+    return (x > y) - (x < y);
+}
+
+/* Builds values that make every median of three pivot of order_statistics_select the second smallest value of the
+ * range, so that each partition only removes two values and the depth limit is reached. The selection is run on
+ * the original indices of the values, which get their values as the pivots are chosen. Values not yet chosen
+ * compare larger than all chosen ones, which holds for any values larger than them given in the end. */
+static void make_adversarial(float* values, size_t count, size_t k) {
+    size_t indices[VALUES_MAX];
+    float chosen[VALUES_MAX];
+    for (size_t i = 0; i < count; ++i) {
+        indices[i] = i;
+        chosen[i] = INFINITY;
+    }
+    float next_value = 0.0f;
+    size_t first = 0;
+    size_t last = count - 1;
+    while (last - first + 1 > SELECT_SORT_THRESHOLD && k > first + 1) {
+        size_t middle = first + (last - first) / 2;
+        chosen[indices[first]] = next_value++;
+        chosen[indices[middle]] = next_value++;
+        /* The median of three ordering: first and middle are in order and smaller than last. */
+        size_t tmp = indices[middle];
+        indices[middle] = indices[last - 1];
+        indices[last - 1] = tmp;
+        /* Partitioning stops at first + 1 from the left and at first from the right. */
+        tmp = indices[first + 1];
+        indices[first + 1] = indices[last - 1];
+        indices[last - 1] = tmp;
+        first += 2;
+    }
+    /* The values never chosen get the largest values, in reverse order. */
+    for (size_t i = first; i < count; ++i) {
+        chosen[indices[i]] = next_value + (float)(count - 1 - i);
+    }
+    for (size_t i = 0; i < count; ++i) {
+        values[i] = chosen[i] / 16.0f;
+    }
+}
+
+static void make_input(float* values, size_t count, Input input) {
+    for (size_t i = 0; i < count; ++i) {
+        switch (input) {
+            case INPUT_RANDOM:
+                values[i] = (float)(next_random() % 10000) / 16.0f;
+                break;
+            case INPUT_EQUAL:
+                values[i] = 2.5f;
+                break;
+            case INPUT_DUPLICATES:
+                values[i] = (float)(next_random() % 3) / 16.0f;
+                break;
+            case INPUT_SORTED:
+                values[i] = (float)i / 16.0f;
+                break;
+            case INPUT_REVERSED:
+                values[i] = (float)(count - i) / 16.0f;
+                break;
+            default:
+                break;
+        }
+    }
+    if (input == INPUT_ADVERSARIAL) {
+        make_adversarial(values, count, count / 2);
+    }
+}
+
+static void sorted_copy(const float* values, size_t count, float* sorted) {
+    memcpy(sorted, values, count * sizeof(*values));
+    qsort(sorted, count, sizeof(*sorted), compare_floats);
+}
+
+static float reference_median(const float* values, size_t count) {
+    float sorted[VALUES_MAX];
+    sorted_copy(values, count, sorted);
+    return count % 2 ? sorted[count / 2] : 0.5f * (sorted[count / 2 - 1] + sorted[count / 2]);
+}
+
+static float reference_mad(const float* values, size_t count) {
+    float median = reference_median(values, count);
+    float deviations[VALUES_MAX];
+    for (size_t i = 0; i < count; ++i) {
+        deviations[i] = fabsf(values[i] - median);
+    }
+    return 1.4826f * reference_median(deviations, count);
+}
+
+static float reference_trimmed_mean(const float* values, size_t count, float trim) {
+    size_t trimmed = (size_t)(trim * count);
+    if (2 * trimmed >= count) {
+        return reference_median(values, count);
+    }
+    float sorted[VALUES_MAX];
+    sorted_copy(values, count, sorted);
+    double sum = 0.0;
+    for (size_t i = trimmed; i < count - trimmed; ++i) {
+        sum += sorted[i];
+    }
+    return (float)(sum / (count - 2 * trimmed));
+}
+
+static void check_select(const float* values, size_t count, Input input) {
+    float sorted[VALUES_MAX];
+    sorted_copy(values, count, sorted);
+    for (size_t k = 0; k < count; ++k) {
+        float selected[VALUES_MAX];
+        memcpy(selected, values, count * sizeof(*values));
+        float value = order_statistics_select(selected, count, k);
+        int partitioned = selected[k] == value;
+        for (size_t i = 0; i < count; ++i) {
+            partitioned &= i < k ? selected[i] <= value : selected[i] >= value;
+        }
+        /* Still the same values, only reordered. */
+        qsort(selected, count, sizeof(*selected), compare_floats);
+        if (value != sorted[k] || !partitioned || memcmp(selected, sorted, count * sizeof(*sorted)) != 0) {
+            test_fail(__FILE__, __LINE__, "select %zu of %zu %s values", k, count, input_names[input]);
+        }
+    }
+}
+
+static void check_statistics(const float* values, size_t count, Input input) {
+    float copy[VALUES_MAX];
+    memcpy(copy, values, count * sizeof(*values));
+    if (order_statistics_median(copy, count) != reference_median(values, count)) {
+        test_fail(__FILE__, __LINE__, "median of %zu %s values", count, input_names[input]);
+    }
+    memcpy(copy, values, count * sizeof(*values));
+    if (order_statistics_mad(copy, count) != reference_mad(values, count)) {
+        test_fail(__FILE__, __LINE__, "MAD of %zu %s values", count, input_names[input]);
+    }
+    static const float trims[] = { 0.0f, 0.1f, 0.25f, 0.5f };
+    for (size_t i = 0; i < sizeof(trims) / sizeof(*trims); ++i) {
+        memcpy(copy, values, count * sizeof(*values));
+        if (order_statistics_trimmed_mean(copy, count, trims[i]) != reference_trimmed_mean(values, count, trims[i])) {
+            test_fail(__FILE__, __LINE__, "trimmed mean %g of %zu %s values", trims[i], count, input_names[input]);
+        }
+    }
+}
+
+static void test_order_statistics(void) {
+    static const size_t counts[] = { 1, 2, 3, 4, 15, 16, 17, 18, 33, 100, 101, 1000 };
+    for (size_t i = 0; i < sizeof(counts) / sizeof(*counts); ++i) {
+        for (int input = 0; input < INPUT_COUNT; ++input) {
+            float values[VALUES_MAX];
+            make_input(values, counts[i], (Input)input);
+            check_select(values, counts[i], (Input)input);
+            check_statistics(values, counts[i], (Input)input);
+        }
+    }
+}
+
+static void test_known_values(void) {
+    /* Small cases worked out by hand, independently of the reference. */
+    float one[] = { 3.0f };
+    TEST_CHECK(order_statistics_median(one, 1) == 3.0f);
+    float two[] = { 4.0f, 1.0f };
+    TEST_CHECK(order_statistics_median(two, 2) == 2.5f);
+    float four[] = { 1.0f, 9.0f, 2.0f, 4.0f };
+    TEST_CHECK(order_statistics_mad(four, 4) == 1.4826f * 1.5f);
+    float five[] = { 100.0f, 1.0f, 2.0f, 3.0f, -100.0f };
+    TEST_CHECK(order_statistics_trimmed_mean(five, 5, 0.2f) == 2.0f);
+}
+
+int main(void) {
+    test_known_values();
+    test_order_statistics();
+    return test_result("test_order_statistics");
+}
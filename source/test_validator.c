@@ -0,0 +1,998 @@
+/*
+Copyright 2019 Tobii Pro AB
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+/* Tests of the calibration validator, run with "make test". The validator is driven through its public API with
+ * gaze data from a stand-in for the eye tracker, delivered on the calling thread. Data collections are timed by
+ * the time stamps of the gaze data, so the results do not depend on how fast the tests run. */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "screen_based_calibration_validation.h"
+#include "gaze_recording.h"
+#include "point_index.h"
+#include "test.h"
+#include "tobii_research_eyetracker.h"
+#include "validation_stats.h"
+#include "vectormath.h"
+
+#define SAMPLE_COUNT (10)
+#define TIMEOUT (1000)
+#define GAZE_DATA_RATE (1200)
+#define RECORDING_PATH "test_validator.rec"
+
+/* Stand-in for the Tobii Pro SDK. Gaze data is delivered by calling the subscribed callback directly. */
+
+static int eyetracker;
+static tobii_research_gaze_data_callback subscribed_callback;
+static void* subscribed_user_data;
+static int64_t current_time_stamp = 1000000;
+
+TobiiResearchStatus tobii_research_get_eyetracker(const char* address, TobiiResearchEyeTracker** instance) {
+    (void)address;
+    *instance = (TobiiResearchEyeTracker*)&eyetracker;
+    return TOBII_RESEARCH_STATUS_OK;
+}
+
+TobiiResearchStatus tobii_research_subscribe_to_gaze_data(TobiiResearchEyeTracker* instance,
+    tobii_research_gaze_data_callback callback, void* user_data) {
+    (void)instance;
+    subscribed_callback = callback;
+    subscribed_user_data = user_data;
+    return TOBII_RESEARCH_STATUS_OK;
+}
+
+TobiiResearchStatus tobii_research_unsubscribe_from_gaze_data(TobiiResearchEyeTracker* instance,
+    tobii_research_gaze_data_callback callback) {
+    (void)instance;
+    (void)callback;
+    subscribed_callback = NULL;
+    return TOBII_RESEARCH_STATUS_OK;
+}
+
+TobiiResearchStatus tobii_research_get_display_area(TobiiResearchEyeTracker* instance,
+    TobiiResearchDisplayArea* display_area) {
+    (void)instance;
+    display_area->width = 500.0f;
+    display_area->height = 300.0f;
+    display_area->top_left.x = -250.0f;
+    display_area->top_left.y = 320.0f;
+    display_area->top_left.z = 20.0f;
+    display_area->top_right = display_area->top_left;
+    display_area->top_right.x = 250.0f;
+    display_area->bottom_left = display_area->top_left;
+    display_area->bottom_left.y = 20.0f;
+    display_area->bottom_right = display_area->bottom_left;
+    display_area->bottom_right.x = 250.0f;
+    return TOBII_RESEARCH_STATUS_OK;
+}
+
+TobiiResearchStatus tobii_research_subscribe_to_display_area(TobiiResearchEyeTracker* instance,
+    tobii_research_display_area_callback callback, void* user_data) {
+    (void)instance;
+    (void)callback;
+    (void)user_data;
+    return TOBII_RESEARCH_STATUS_OK;
+}
+
+TobiiResearchStatus tobii_research_unsubscribe_from_display_area(TobiiResearchEyeTracker* instance,
+    tobii_research_display_area_callback callback) {
+    (void)instance;
+    (void)callback;
+    return TOBII_RESEARCH_STATUS_OK;
+}
+
+TobiiResearchStatus tobii_research_get_system_time_stamp(int64_t* time_stamp) {
+    *time_stamp = current_time_stamp;
+    return TOBII_RESEARCH_STATUS_OK;
+}
+
+/* Delivers count valid samples looking at the screen point, without the application thread doing anything in
+ * between. */
+static void deliver_gaze_data(const TobiiResearchNormalizedPoint2D* screen_point, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        TobiiResearchGazeData gaze_data;
+        memset(&gaze_data, 0, sizeof(gaze_data));
+        TobiiResearchEyeData* eyes[] = { &gaze_data.left_eye, &gaze_data.right_eye };
+        for (size_t eye = 0; eye < 2; ++eye) {
+            eyes[eye]->gaze_origin.position_in_user_coordinates.x = eye ? 30.0f : -30.0f;
+            eyes[eye]->gaze_origin.position_in_user_coordinates.y = 170.0f;
+            eyes[eye]->gaze_origin.position_in_user_coordinates.z = 600.0f;
+            eyes[eye]->gaze_point.position_in_user_coordinates.x = -250.0f + 500.0f * screen_point->x + (i % 3);
+            eyes[eye]->gaze_point.position_in_user_coordinates.y = 320.0f - 300.0f * screen_point->y;
+            eyes[eye]->gaze_point.position_in_user_coordinates.z = 20.0f;
+            eyes[eye]->gaze_origin.validity = TOBII_RESEARCH_VALIDITY_VALID;
+            eyes[eye]->gaze_point.validity = TOBII_RESEARCH_VALIDITY_VALID;
+        }
+        current_time_stamp += 1000000 / GAZE_DATA_RATE;
+        gaze_data.device_time_stamp = current_time_stamp;
+        gaze_data.system_time_stamp = current_time_stamp;
+        subscribed_callback(&gaze_data, subscribed_user_data);
+    }
+}
+
+/* Options can only be set before entering validation mode. */
+static CalibrationValidator* init_validator(size_t sample_count, int timeout) {
+    CalibrationValidator* validator = NULL;
+    TEST_CHECK(tobii_research_screen_based_calibration_validation_init("stand-in", sample_count, timeout,
+        &validator) == CALIBRATION_VALIDATION_STATUS_OK);
+    TEST_CHECK(tobii_research_screen_based_calibration_validation_set_option(validator,
+        CALIBRATION_VALIDATION_OPTION_TIMING, CALIBRATION_VALIDATION_TIMING_TIME_STAMPS) ==
+        CALIBRATION_VALIDATION_STATUS_OK);
+    /* So that the result tells how many samples each point has. */
+    TEST_CHECK(tobii_research_screen_based_calibration_validation_set_option(validator,
+        CALIBRATION_VALIDATION_OPTION_RETAIN_GAZE_DATA, 1) == CALIBRATION_VALIDATION_STATUS_OK);
+    return validator;
+}
+
+static void enter_validation_mode(CalibrationValidator* validator) {
+    TEST_CHECK(tobii_research_screen_based_calibration_validation_enter_validation_mode(validator) ==
+        CALIBRATION_VALIDATION_STATUS_OK);
+}
+
+static CalibrationValidator* create_validator(size_t sample_count, int timeout) {
+    CalibrationValidator* validator = init_validator(sample_count, timeout);
+    enter_validation_mode(validator);
+    return validator;
+}
+
+static void destroy_validator(CalibrationValidator* validator) {
+    TEST_CHECK(tobii_research_screen_based_calibration_validation_leave_validation_mode(validator) ==
+        CALIBRATION_VALIDATION_STATUS_OK);
+    TEST_CHECK(tobii_research_screen_based_calibration_validation_destroy(validator) ==
+        CALIBRATION_VALIDATION_STATUS_OK);
+}
+
+/* Collects a single point, delivering count samples for it. */
+static void collect_point(CalibrationValidator* validator, const TobiiResearchNormalizedPoint2D* screen_point,
+    size_t count) {
+    TEST_CHECK(tobii_research_screen_based_calibration_validation_start_collecting_data(validator, screen_point) ==
+        CALIBRATION_VALIDATION_STATUS_OK);
+    deliver_gaze_data(screen_point, count);
+    TEST_CHECK(!tobii_research_screen_based_calibration_validation_is_collecting_data(validator));
+}
+
+/* Bitwise comparison, so that results computed differently are only equal if every bit of them is. */
+static int same_float(float first, float second) {
+    return memcmp(&first, &second, sizeof(first)) == 0;
+}
+
+static void check_same_point(const CalibrationValidationPoint* point, const CalibrationValidationPoint* expected) {
+    TEST_CHECK(same_float(point->accuracy_left_eye, expected->accuracy_left_eye));
+    TEST_CHECK(same_float(point->accuracy_right_eye, expected->accuracy_right_eye));
+    TEST_CHECK(same_float(point->precision_left_eye, expected->precision_left_eye));
+    TEST_CHECK(same_float(point->precision_right_eye, expected->precision_right_eye));
+    TEST_CHECK(same_float(point->precision_rms_left_eye, expected->precision_rms_left_eye));
+    TEST_CHECK(same_float(point->precision_rms_right_eye, expected->precision_rms_right_eye));
+    TEST_CHECK(point->timed_out == expected->timed_out);
+    TEST_CHECK(point2_equal(&point->screen_point, &expected->screen_point));
+    TEST_CHECK(point->gaze_data_count == expected->gaze_data_count);
+    TEST_CHECK(same_float(point->accuracy_median_left_eye, expected->accuracy_median_left_eye));
+    TEST_CHECK(same_float(point->accuracy_median_right_eye, expected->accuracy_median_right_eye));
+    TEST_CHECK(same_float(point->accuracy_trimmed_left_eye, expected->accuracy_trimmed_left_eye));
+    TEST_CHECK(same_float(point->accuracy_trimmed_right_eye, expected->accuracy_trimmed_right_eye));
+    TEST_CHECK(same_float(point->precision_mad_left_eye, expected->precision_mad_left_eye));
+    TEST_CHECK(same_float(point->precision_mad_right_eye, expected->precision_mad_right_eye));
+    TEST_CHECK(same_float(point->precision_rms_trimmed_left_eye, expected->precision_rms_trimmed_left_eye));
+    TEST_CHECK(same_float(point->precision_rms_trimmed_right_eye, expected->precision_rms_trimmed_right_eye));
+}
+
+/* Checks that both results hold bitwise the same points and averages. */
+static void check_same_result(const CalibrationValidationResult* result, const CalibrationValidationResult* expected) {
+    TEST_CHECK(same_float(result->average_accuracy_left, expected->average_accuracy_left));
+    TEST_CHECK(same_float(result->average_accuracy_right, expected->average_accuracy_right));
+    TEST_CHECK(same_float(result->average_precision_left, expected->average_precision_left));
+    TEST_CHECK(same_float(result->average_precision_right, expected->average_precision_right));
+    TEST_CHECK(same_float(result->average_precision_rms_left, expected->average_precision_rms_left));
+    TEST_CHECK(same_float(result->average_precision_rms_right, expected->average_precision_rms_right));
+    if (result->points_count != expected->points_count) {
+        test_fail(__FILE__, __LINE__, "result has %zu points, expected %zu", result->points_count,
+            expected->points_count);
+        return;
+    }
+    for (size_t i = 0; i < result->points_count; ++i) {
+        check_same_point(&result->points[i], &expected->points[i]);
+    }
+}
+
+static void init_plan(CalibrationValidationPlanPoint* points, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        points[i].screen_point.x = 0.1f + 0.4f * i;
+        points[i].screen_point.y = 0.5f;
+        points[i].settle_time = 0;
+    }
+}
+
+/* Checks that the result holds exactly the given points of the plan, in order, each with sample_count samples. */
+static void check_result(CalibrationValidator* validator, const CalibrationValidationPlanPoint* points,
+    const size_t* indices, size_t count, size_t sample_count) {
+    TEST_CHECK(!tobii_research_screen_based_calibration_validation_is_collecting_data(validator));
+    CalibrationValidationResult* result = NULL;
+    if (tobii_research_screen_based_calibration_validation_compute(validator, &result) !=
+        CALIBRATION_VALIDATION_STATUS_OK) {
+        test_fail(__FILE__, __LINE__, "no result");
+        return;
+    }
+    if (result->points_count != count) {
+        test_fail(__FILE__, __LINE__, "result has %zu points, expected %zu", result->points_count, count);
+    } else {
+        for (size_t i = 0; i < count; ++i) {
+            const CalibrationValidationPoint* point = &result->points[i];
+            TEST_CHECK(point->screen_point.x == points[indices[i]].screen_point.x);
+            TEST_CHECK(point->gaze_data_count == sample_count);
+            TEST_CHECK(!point->timed_out);
+        }
+    }
+    tobii_research_screen_based_calibration_validation_destroy_result(result);
+}
+
+static void test_point_index_probe_chains(void) {
+    /* A cluster wrapping around the end of the table: three points with the last slot but one as their home slot,
+     * two with the last slot and two with the first one. Whichever two of them are removed, the others are still
+     * found where linear probing from their home slot leads. */
+    static const size_t home_slots[] = { 14, 14, 14, 15, 15, 0, 0 };
+    TobiiResearchNormalizedPoint2D points[7];
+    size_t count = 0;
+    for (int i = 0; i <= 1000 && count < 7; ++i) {
+        TobiiResearchNormalizedPoint2D point = { i / 1000.0f, 0.5f };
+        if ((point2_hash(&point) & 15) == home_slots[count]) {
+            points[count++] = point;
+        }
+    }
+    TEST_CHECK(count == 7);
+
+    for (size_t first = 0; count == 7 && first < 7; ++first) {
+        for (size_t second = 0; second < 7; ++second) {
+            if (second == first) {
+                continue;
+            }
+            /* Sixteen slots, so that all seven points fit without the table growing. */
+            PointIndex* index = point_index_init(8);
+            for (size_t i = 0; i < 7; ++i) {
+                point_index_insert(index, &points[i], i);
+            }
+            point_index_remove(index, &points[first]);
+            point_index_remove(index, &points[second]);
+            for (size_t i = 0; i < 7; ++i) {
+                size_t expected = i == first || i == second ? POINT_INDEX_NOT_FOUND : i;
+                TEST_CHECK(point_index_find(index, &points[i]) == expected);
+            }
+            point_index_insert(index, &points[first], first);
+            for (size_t i = 0; i < 7; ++i) {
+                TEST_CHECK(point_index_find(index, &points[i]) == (i == second ? POINT_INDEX_NOT_FOUND : i));
+            }
+            point_index_destroy(index);
+        }
+    }
+}
+
+static void test_discard_points(void) {
+    /* Discarding the first, the last and points in between leaves every other point to be found: collecting one
+     * of them again adds the samples to it rather than storing another point. */
+    CalibrationValidator* validator = create_validator(SAMPLE_COUNT, TIMEOUT);
+    TobiiResearchNormalizedPoint2D points[12];
+    for (size_t i = 0; i < 12; ++i) {
+        points[i].x = 0.05f + 0.075f * i;
+        points[i].y = 0.2f + 0.2f * (i % 4);
+        collect_point(validator, &points[i], SAMPLE_COUNT);
+    }
+    static const size_t discarded[] = { 0, 5, 6, 11 };
+    for (size_t i = 0; i < 4; ++i) {
+        TEST_CHECK(tobii_research_screen_based_calibration_validation_discard_collected_data(validator,
+            &points[discarded[i]]) == CALIBRATION_VALIDATION_STATUS_OK);
+    }
+    static const size_t kept[] = { 1, 2, 3, 4, 7, 8, 9, 10 };
+    for (size_t i = 0; i < 8; ++i) {
+        collect_point(validator, &points[kept[i]], SAMPLE_COUNT);
+    }
+
+    CalibrationValidationResult* result = NULL;
+    TEST_CHECK(tobii_research_screen_based_calibration_validation_compute(validator, &result) ==
+        CALIBRATION_VALIDATION_STATUS_OK);
+    if (result) {
+        TEST_CHECK(result->points_count == 8);
+        for (size_t i = 0; i < 8 && i < result->points_count; ++i) {
+            TEST_CHECK(point2_equal(&result->points[i].screen_point, &points[kept[i]]));
+            TEST_CHECK(result->points[i].gaze_data_count == 2 * SAMPLE_COUNT);
+        }
+    }
+    tobii_research_screen_based_calibration_validation_destroy_result(result);
+    destroy_validator(validator);
+}
+
+static void test_compute_threads(void) {
+    /* The same data computed on any number of threads gives bitwise the same result. The points are not a
+     * multiple of the threads, so the threads get different numbers of them. */
+    static const int threads[] = { 1, 3, 7 };
+    CalibrationValidationResult* results[3];
+    for (size_t i = 0; i < 3; ++i) {
+        CalibrationValidator* validator = init_validator(37, TIMEOUT);
+        TEST_CHECK(tobii_research_screen_based_calibration_validation_set_option(validator,
+            CALIBRATION_VALIDATION_OPTION_COMPUTE_THREADS, threads[i]) == CALIBRATION_VALIDATION_STATUS_OK);
+        TEST_CHECK(tobii_research_screen_based_calibration_validation_set_option(validator,
+            CALIBRATION_VALIDATION_OPTION_RESULT_GAZE_DATA, CALIBRATION_VALIDATION_RESULT_GAZE_DATA_NONE) ==
+            CALIBRATION_VALIDATION_STATUS_OK);
+        TEST_CHECK(tobii_research_screen_based_calibration_validation_set_option(validator,
+            CALIBRATION_VALIDATION_OPTION_ROBUST_STATISTICS, 1) == CALIBRATION_VALIDATION_STATUS_OK);
+        enter_validation_mode(validator);
+        for (size_t j = 0; j < 20; ++j) {
+            TobiiResearchNormalizedPoint2D screen_point = { 0.05f + 0.045f * j, 0.2f + 0.15f * (j % 5) };
+            collect_point(validator, &screen_point, 37);
+        }
+        results[i] = NULL;
+        TEST_CHECK(tobii_research_screen_based_calibration_validation_compute(validator, &results[i]) ==
+            CALIBRATION_VALIDATION_STATUS_OK);
+        destroy_validator(validator);
+    }
+    if (results[0] && results[1] && results[2]) {
+        TEST_CHECK(results[0]->points_count == 20);
+        check_same_result(results[1], results[0]);
+        check_same_result(results[2], results[0]);
+    }
+    for (size_t i = 0; i < 3; ++i) {
+        tobii_research_screen_based_calibration_validation_destroy_result(results[i]);
+    }
+}
+
+static size_t histogram_count(const size_t* histogram) {
+    size_t count = 0;
+    for (size_t i = 0; i < CALIBRATION_VALIDATION_STATS_BUCKET_COUNT; ++i) {
+        count += histogram[i];
+    }
+    return count;
+}
+
+static void test_stats(void) {
+    /* Bucket i > 0 counts durations from 2^(i-1) microseconds, the last one everything longer. */
+    ValidationStats* validation_stats = validation_stats_init();
+    static const int64_t durations[] = { 0, 999, 1000, 1999, 2000, 3999, 4000, (int64_t)1 << 40 };
+    static const size_t buckets[] = { 0, 0, 1, 1, 2, 2, 3, CALIBRATION_VALIDATION_STATS_BUCKET_COUNT - 1 };
+    for (size_t i = 0; i < sizeof(durations) / sizeof(*durations); ++i) {
+        validation_stats_add_duration(validation_stats, VALIDATION_STATS_COMPUTE_DURATION, durations[i]);
+    }
+    CalibrationValidationStats stats;
+    validation_stats_get(validation_stats, &stats);
+    for (size_t i = 0; i < CALIBRATION_VALIDATION_STATS_BUCKET_COUNT; ++i) {
+        size_t expected = 0;
+        for (size_t j = 0; j < sizeof(buckets) / sizeof(*buckets); ++j) {
+            expected += buckets[j] == i;
+        }
+        TEST_CHECK(stats.compute_durations[i] == expected);
+        TEST_CHECK(stats.gaze_data_callback_durations[i] == 0);
+    }
+    validation_stats_destroy(validation_stats);
+
+    /* The counters are always updated, the histograms only when enabled. */
+    for (int histograms = 0; histograms < 2; ++histograms) {
+        CalibrationValidator* validator = init_validator(SAMPLE_COUNT, TIMEOUT);
+        TEST_CHECK(tobii_research_screen_based_calibration_validation_set_option(validator,
+            CALIBRATION_VALIDATION_OPTION_DURATION_HISTOGRAMS, histograms) == CALIBRATION_VALIDATION_STATUS_OK);
+        enter_validation_mode(validator);
+        TobiiResearchNormalizedPoint2D screen_point = { 0.5f, 0.5f };
+        deliver_gaze_data(&screen_point, 3);
+        collect_point(validator, &screen_point, SAMPLE_COUNT);
+        CalibrationValidationResult* result = NULL;
+        TEST_CHECK(tobii_research_screen_based_calibration_validation_compute(validator, &result) ==
+            CALIBRATION_VALIDATION_STATUS_OK);
+        tobii_research_screen_based_calibration_validation_destroy_result(result);
+
+        TEST_CHECK(tobii_research_screen_based_calibration_validation_get_stats(validator, &stats) ==
+            CALIBRATION_VALIDATION_STATUS_OK);
+        TEST_CHECK(stats.gaze_data_count == 3 + SAMPLE_COUNT);
+        TEST_CHECK(stats.idle_gaze_data_count == 3);
+        TEST_CHECK(stats.invalid_gaze_data_count == 0);
+        TEST_CHECK(stats.dropped_gaze_data_count == 0);
+        TEST_CHECK(stats.completed_collection_count == 1);
+        TEST_CHECK(stats.timed_out_collection_count == 0);
+        TEST_CHECK(stats.compute_count == 1);
+        TEST_CHECK(histogram_count(stats.gaze_data_callback_durations) == (histograms ? 3 + SAMPLE_COUNT : 0));
+        TEST_CHECK(histogram_count(stats.compute_durations) == (histograms ? 1 : 0));
+
+        TEST_CHECK(tobii_research_screen_based_calibration_validation_reset_stats(validator) ==
+            CALIBRATION_VALIDATION_STATUS_OK);
+        TEST_CHECK(tobii_research_screen_based_calibration_validation_get_stats(validator, &stats) ==
+            CALIBRATION_VALIDATION_STATUS_OK);
+        TEST_CHECK(stats.gaze_data_count == 0 && stats.completed_collection_count == 0 && stats.compute_count == 0);
+        TEST_CHECK(histogram_count(stats.gaze_data_callback_durations) == 0);
+        destroy_validator(validator);
+    }
+}
+
+static void test_incremental_compute(void) {
+    /* Computing only the points changed since the last compute gives bitwise the same result as computing every
+     * point of the same data at once. */
+    TobiiResearchNormalizedPoint2D points[5];
+    for (size_t i = 0; i < 5; ++i) {
+        points[i].x = 0.1f + 0.2f * i;
+        points[i].y = 0.3f + 0.1f * i;
+    }
+    CalibrationValidator* validator = init_validator(SAMPLE_COUNT, TIMEOUT);
+    TEST_CHECK(tobii_research_screen_based_calibration_validation_set_option(validator,
+        CALIBRATION_VALIDATION_OPTION_ROBUST_STATISTICS, 1) == CALIBRATION_VALIDATION_STATUS_OK);
+    enter_validation_mode(validator);
+    for (size_t i = 0; i < 5; ++i) {
+        collect_point(validator, &points[i], SAMPLE_COUNT);
+    }
+    CalibrationValidationResult* result = NULL;
+    TEST_CHECK(tobii_research_screen_based_calibration_validation_compute(validator, &result) ==
+        CALIBRATION_VALIDATION_STATUS_OK);
+    tobii_research_screen_based_calibration_validation_destroy_result(result);
+    collect_point(validator, &points[2], SAMPLE_COUNT);
+    TEST_CHECK(tobii_research_screen_based_calibration_validation_discard_collected_data(validator,
+        &points[3]) == CALIBRATION_VALIDATION_STATUS_OK);
+    result = NULL;
+    TEST_CHECK(tobii_research_screen_based_calibration_validation_compute(validator, &result) ==
+        CALIBRATION_VALIDATION_STATUS_OK);
+    destroy_validator(validator);
+
+    /* The same samples in the same order, computed once. */
+    CalibrationValidator* expected_validator = init_validator(SAMPLE_COUNT, TIMEOUT);
+    TEST_CHECK(tobii_research_screen_based_calibration_validation_set_option(expected_validator,
+        CALIBRATION_VALIDATION_OPTION_ROBUST_STATISTICS, 1) == CALIBRATION_VALIDATION_STATUS_OK);
+    enter_validation_mode(expected_validator);
+    static const size_t collected[] = { 0, 1, 2, 4, 2 };
+    for (size_t i = 0; i < 5; ++i) {
+        collect_point(expected_validator, &points[collected[i]], SAMPLE_COUNT);
+    }
+    CalibrationValidationResult* expected = NULL;
+    TEST_CHECK(tobii_research_screen_based_calibration_validation_compute(expected_validator, &expected) ==
+        CALIBRATION_VALIDATION_STATUS_OK);
+    destroy_validator(expected_validator);
+
+    if (result && expected) {
+        TEST_CHECK(result->points_count == 4);
+        TEST_CHECK(result->points_count == 4 && result->points[2].gaze_data_count == 2 * SAMPLE_COUNT);
+        check_same_result(result, expected);
+    }
+    tobii_research_screen_based_calibration_validation_destroy_result(result);
+    tobii_research_screen_based_calibration_validation_destroy_result(expected);
+}
+
+/* Keeps everything an export writes. The sink fails on the call with index fail_at. */
+typedef struct {
+    unsigned char* data;
+    size_t size;
+    size_t calls;
+    size_t fail_at;
+} ExportBuffer;
+
+static int export_buffer_write(const void* data, size_t size, void* user_data) {
+    ExportBuffer* buffer = (ExportBuffer*)user_data;
+    if (buffer->calls++ == buffer->fail_at || size > 65536) {
+        return 1;
+    }
+    buffer->data = realloc(buffer->data, buffer->size + size);
+    memcpy(buffer->data + buffer->size, data, size);
+    buffer->size += size;
+    return 0;
+}
+
+static CalibrationValidationStatus export_to_buffer(CalibrationValidator* validator,
+    CalibrationValidationExportFormat format, int include_samples, ExportBuffer* buffer, size_t fail_at) {
+    memset(buffer, 0, sizeof(*buffer));
+    buffer->fail_at = fail_at;
+    return tobii_research_screen_based_calibration_validation_export(validator, format, include_samples,
+        export_buffer_write, buffer);
+}
+
+/* Collects two points that complete and one that times out with a single sample, whose precision RMS is NaN. */
+static CalibrationValidator* create_export_validator(void) {
+    CalibrationValidator* validator = init_validator(SAMPLE_COUNT, TIMEOUT);
+    TEST_CHECK(tobii_research_screen_based_calibration_validation_set_option(validator,
+        CALIBRATION_VALIDATION_OPTION_ROBUST_STATISTICS, 1) == CALIBRATION_VALIDATION_STATUS_OK);
+    enter_validation_mode(validator);
+    TobiiResearchNormalizedPoint2D points[] = { { 0.1f, 0.2f }, { 0.9f, 0.8f }, { 0.5f, 0.5f } };
+    collect_point(validator, &points[0], SAMPLE_COUNT);
+    collect_point(validator, &points[1], SAMPLE_COUNT + 5);
+    TEST_CHECK(tobii_research_screen_based_calibration_validation_start_collecting_data(validator, &points[2]) ==
+        CALIBRATION_VALIDATION_STATUS_OK);
+    deliver_gaze_data(&points[2], 1);
+    current_time_stamp += (TIMEOUT + 1) * (int64_t)1000;
+    deliver_gaze_data(&points[2], 1);
+    TEST_CHECK(!tobii_research_screen_based_calibration_validation_is_collecting_data(validator));
+    return validator;
+}
+
+/* Reads the binary export in order, little-endian. Past the end, reads zeros and marks the reader overrun. */
+typedef struct {
+    const unsigned char* data;
+    size_t size;
+    size_t position;
+    int overrun;
+} ExportReader;
+
+static uint64_t read_little_endian(ExportReader* reader, size_t size) {
+    uint64_t value = 0;
+    if (reader->position + size > reader->size) {
+        reader->overrun = 1;
+        return 0;
+    }
+    for (size_t i = 0; i < size; ++i) {
+        value |= (uint64_t)reader->data[reader->position++] << (8 * i);
+    }
+    return value;
+}
+
+static uint32_t read_u32(ExportReader* reader) {
+    return (uint32_t)read_little_endian(reader, 4);
+}
+
+static int64_t read_i64(ExportReader* reader) {
+    return (int64_t)read_little_endian(reader, 8);
+}
+
+static float read_f32(ExportReader* reader) {
+    uint32_t bits = read_u32(reader);
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+static int read_same_point3(ExportReader* reader, const TobiiResearchPoint3D* point) {
+    float x = read_f32(reader);
+    float y = read_f32(reader);
+    float z = read_f32(reader);
+    return same_float(x, point->x) && same_float(y, point->y) && same_float(z, point->z);
+}
+
+static void test_export_binary(void) {
+    /* Reads back the header, the points with the metrics compute gives and the samples compute retains. */
+    CalibrationValidator* validator = create_export_validator();
+    CalibrationValidationResult* result = NULL;
+    TEST_CHECK(tobii_research_screen_based_calibration_validation_compute(validator, &result) ==
+        CALIBRATION_VALIDATION_STATUS_OK);
+    ExportBuffer buffer;
+    TEST_CHECK(export_to_buffer(validator, CALIBRATION_VALIDATION_EXPORT_FORMAT_BINARY, 1, &buffer, (size_t)-1) ==
+        CALIBRATION_VALIDATION_STATUS_OK);
+    if (result && buffer.size >= 4) {
+        ExportReader reader = { buffer.data, buffer.size, 4, 0 };
+        TEST_CHECK(memcmp(buffer.data, "TVEX", 4) == 0);
+        TEST_CHECK(read_u32(&reader) == 1);
+        TEST_CHECK(read_u32(&reader) == 1);
+        TEST_CHECK(read_u32(&reader) == result->points_count);
+        size_t sample_count = 0;
+        for (size_t i = 0; i < result->points_count; ++i) {
+            sample_count += result->points[i].gaze_data_count;
+        }
+        TEST_CHECK(read_u32(&reader) == sample_count);
+        TEST_CHECK(read_u32(&reader) == 0);
+        TEST_CHECK(same_float(read_f32(&reader), result->average_accuracy_left));
+        TEST_CHECK(same_float(read_f32(&reader), result->average_accuracy_right));
+        TEST_CHECK(same_float(read_f32(&reader), result->average_precision_left));
+        TEST_CHECK(same_float(read_f32(&reader), result->average_precision_right));
+        TEST_CHECK(same_float(read_f32(&reader), result->average_precision_rms_left));
+        TEST_CHECK(same_float(read_f32(&reader), result->average_precision_rms_right));
+        for (size_t i = 0; i < result->points_count && !reader.overrun; ++i) {
+            const CalibrationValidationPoint* point = &result->points[i];
+            TEST_CHECK(same_float(read_f32(&reader), point->screen_point.x));
+            TEST_CHECK(same_float(read_f32(&reader), point->screen_point.y));
+            TEST_CHECK(read_u32(&reader) == (uint32_t)point->timed_out);
+            TEST_CHECK(read_u32(&reader) == point->gaze_data_count);
+            const float metrics[] = {
+                point->accuracy_left_eye, point->accuracy_right_eye,
+                point->precision_left_eye, point->precision_right_eye,
+                point->precision_rms_left_eye, point->precision_rms_right_eye,
+                point->accuracy_median_left_eye, point->accuracy_median_right_eye,
+                point->accuracy_trimmed_left_eye, point->accuracy_trimmed_right_eye,
+                point->precision_mad_left_eye, point->precision_mad_right_eye,
+                point->precision_rms_trimmed_left_eye, point->precision_rms_trimmed_right_eye,
+            };
+            for (size_t j = 0; j < sizeof(metrics) / sizeof(*metrics); ++j) {
+                TEST_CHECK(same_float(read_f32(&reader), metrics[j]));
+            }
+            for (size_t j = 0; j < point->gaze_data_count; ++j) {
+                const TobiiResearchGazeData* gaze_data = &point->gaze_data[j];
+                TEST_CHECK(read_i64(&reader) == gaze_data->device_time_stamp);
+                TEST_CHECK(read_i64(&reader) == gaze_data->system_time_stamp);
+                TEST_CHECK(read_same_point3(&reader, &gaze_data->left_eye.gaze_origin.position_in_user_coordinates));
+                TEST_CHECK(read_same_point3(&reader, &gaze_data->left_eye.gaze_point.position_in_user_coordinates));
+                TEST_CHECK(read_same_point3(&reader, &gaze_data->right_eye.gaze_origin.position_in_user_coordinates));
+                TEST_CHECK(read_same_point3(&reader, &gaze_data->right_eye.gaze_point.position_in_user_coordinates));
+            }
+        }
+        TEST_CHECK(result->points_count == 3 && result->points[2].timed_out);
+        TEST_CHECK(!reader.overrun && reader.position == buffer.size);
+    } else {
+        test_fail(__FILE__, __LINE__, "nothing to compare");
+    }
+    free(buffer.data);
+
+    /* Without samples, only the flags and the sample count of the header change. */
+    TEST_CHECK(export_to_buffer(validator, CALIBRATION_VALIDATION_EXPORT_FORMAT_BINARY, 0, &buffer, (size_t)-1) ==
+        CALIBRATION_VALIDATION_STATUS_OK);
+    TEST_CHECK(buffer.size == 4 + 5 * 4 + 6 * 4 + 3 * (2 * 4 + 2 * 4 + 14 * 4));
+    free(buffer.data);
+    tobii_research_screen_based_calibration_validation_destroy_result(result);
+    destroy_validator(validator);
+}
+
+static int starts_with(const char* text, const char* prefix) {
+    return strncmp(text, prefix, strlen(prefix)) == 0;
+}
+
+/* Skips a JSON value starting at text, returns what follows it or NULL if it is not well-formed. */
+static const char* skip_json_value(const char* text) {
+    if (*text == '{' || *text == '[') {
+        char close = *text == '{' ? '}' : ']';
+        ++text;
+        if (*text == close) {
+            return text + 1;
+        }
+        for (;;) {
+            if (close == '}') {
+                if (*text != '"' || (text = skip_json_value(text)) == NULL || *text++ != ':') {
+                    return NULL;
+                }
+            }
+            if ((text = skip_json_value(text)) == NULL) {
+                return NULL;
+            }
+            if (*text == close) {
+                return text + 1;
+            }
+            if (*text++ != ',') {
+                return NULL;
+            }
+        }
+    }
+    if (*text == '"') {
+        for (++text; *text != '"'; ++text) {
+            if (*text == '\0' || *text == '\\' || (unsigned char)*text < 0x20) {
+                return NULL;
+            }
+        }
+        return text + 1;
+    }
+    static const char* const literals[] = { "true", "false", "null" };
+    for (size_t i = 0; i < 3; ++i) {
+        if (starts_with(text, literals[i])) {
+            return text + strlen(literals[i]);
+        }
+    }
+    /* A number as JSON allows it: no leading plus, no leading zeros, digits on both sides of the point. */
+    const char* start = text;
+    if (*text == '-') {
+        ++text;
+    }
+    if (*text == '0') {
+        ++text;
+    } else if (*text >= '1' && *text <= '9') {
+        while (*text >= '0' && *text <= '9') {
+            ++text;
+        }
+    } else {
+        return NULL;
+    }
+    if (*text == '.') {
+        if (!(*++text >= '0' && *text <= '9')) {
+            return NULL;
+        }
+        while (*text >= '0' && *text <= '9') {
+            ++text;
+        }
+    }
+    if (*text == 'e' || *text == 'E') {
+        ++text;
+        if (*text == '+' || *text == '-') {
+            ++text;
+        }
+        if (!(*text >= '0' && *text <= '9')) {
+            return NULL;
+        }
+        while (*text >= '0' && *text <= '9') {
+            ++text;
+        }
+    }
+    return text > start ? text : NULL;
+}
+
+static void test_export_json(void) {
+    /* Every line is a single well-formed JSON object: the validation, then each point followed by its samples. */
+    CalibrationValidator* validator = create_export_validator();
+    ExportBuffer buffer;
+    TEST_CHECK(export_to_buffer(validator, CALIBRATION_VALIDATION_EXPORT_FORMAT_JSON, 1, &buffer, (size_t)-1) ==
+        CALIBRATION_VALIDATION_STATUS_OK);
+    buffer.data = realloc(buffer.data, buffer.size + 1);
+    buffer.data[buffer.size] = '\0';
+    static const size_t sample_counts[] = { SAMPLE_COUNT, SAMPLE_COUNT, 1 };
+    size_t line_count = 0;
+    size_t point = 0;
+    size_t point_samples = 0;
+    int nulls = 0;
+    for (char* line = (char*)buffer.data; *line; ++line_count) {
+        char* end = strchr(line, '\n');
+        if (!end) {
+            test_fail(__FILE__, __LINE__, "line %zu is not terminated", line_count);
+            break;
+        }
+        *end = '\0';
+        if (*line != '{' || skip_json_value(line) != end) {
+            test_fail(__FILE__, __LINE__, "line %zu is not a JSON object: %s", line_count, line);
+        }
+        nulls += strstr(line, ":null") != NULL;
+        if (line_count == 0) {
+            TEST_CHECK(starts_with(line, "{\"type\":\"validation\",\"version\":1,\"points_count\":3,"));
+        } else if (starts_with(line, "{\"type\":\"point\",")) {
+            TEST_CHECK(point_samples == (point ? sample_counts[point - 1] : 0));
+            ++point;
+            point_samples = 0;
+        } else {
+            TEST_CHECK(point > 0 && starts_with(line, "{\"type\":\"sample\","));
+            ++point_samples;
+        }
+        line = end + 1;
+    }
+    TEST_CHECK(point == 3 && point_samples == 1);
+    TEST_CHECK(line_count == 1 + 3 + 2 * SAMPLE_COUNT + 1);
+    /* The precision RMS of the point with a single sample. */
+    TEST_CHECK(nulls == 1);
+    free(buffer.data);
+    destroy_validator(validator);
+}
+
+static void test_export_failure(void) {
+    /* An export larger than a few chunks stops at the sink failing and reports it. */
+    CalibrationValidator* validator = create_validator(3000, 3000);
+    for (size_t i = 0; i < 3; ++i) {
+        TobiiResearchNormalizedPoint2D screen_point = { 0.2f + 0.3f * i, 0.5f };
+        collect_point(validator, &screen_point, 3000);
+    }
+    static const CalibrationValidationExportFormat formats[] = {
+        CALIBRATION_VALIDATION_EXPORT_FORMAT_BINARY,
+        CALIBRATION_VALIDATION_EXPORT_FORMAT_JSON,
+    };
+    for (size_t i = 0; i < 2; ++i) {
+        ExportBuffer buffer;
+        TEST_CHECK(export_to_buffer(validator, formats[i], 1, &buffer, (size_t)-1) ==
+            CALIBRATION_VALIDATION_STATUS_OK);
+        TEST_CHECK(buffer.calls > 3);
+        free(buffer.data);
+        TEST_CHECK(export_to_buffer(validator, formats[i], 1, &buffer, 2) ==
+            CALIBRATION_VALIDATION_STATUS_INVALID_EXPORT);
+        TEST_CHECK(buffer.calls == 3);
+        free(buffer.data);
+    }
+    TEST_CHECK(tobii_research_screen_based_calibration_validation_export(validator,
+        CALIBRATION_VALIDATION_EXPORT_FORMAT_JSON, 1, NULL, NULL) == CALIBRATION_VALIDATION_STATUS_INVALID_EXPORT);
+    destroy_validator(validator);
+}
+
+static int in_block(const void* pointer, const void* block, size_t size) {
+    uintptr_t address = (uintptr_t)pointer;
+    return address >= (uintptr_t)block && address < (uintptr_t)block + size;
+}
+
+static void test_relocate_result(void) {
+    /* A copy of the result made with memcpy refers to its own points once relocated, and to its own samples or to
+     * those of the validator, even after the original is destroyed. */
+    static const CalibrationValidationResultGazeData modes[] = {
+        CALIBRATION_VALIDATION_RESULT_GAZE_DATA_COPY,
+        CALIBRATION_VALIDATION_RESULT_GAZE_DATA_VIEW,
+    };
+    for (size_t mode = 0; mode < 2; ++mode) {
+        CalibrationValidator* validator = init_validator(SAMPLE_COUNT, TIMEOUT);
+        TEST_CHECK(tobii_research_screen_based_calibration_validation_set_option(validator,
+            CALIBRATION_VALIDATION_OPTION_RESULT_GAZE_DATA, modes[mode]) == CALIBRATION_VALIDATION_STATUS_OK);
+        enter_validation_mode(validator);
+        for (size_t i = 0; i < 3; ++i) {
+            TobiiResearchNormalizedPoint2D screen_point = { 0.2f + 0.3f * i, 0.5f };
+            collect_point(validator, &screen_point, SAMPLE_COUNT);
+        }
+        CalibrationValidationResult* result = NULL;
+        TEST_CHECK(tobii_research_screen_based_calibration_validation_compute(validator, &result) ==
+            CALIBRATION_VALIDATION_STATUS_OK);
+        if (!result || result->points_count != 3) {
+            test_fail(__FILE__, __LINE__, "no result to relocate");
+            tobii_research_screen_based_calibration_validation_destroy_result(result);
+            destroy_validator(validator);
+            continue;
+        }
+
+        /* What the result holds, kept apart from it. */
+        CalibrationValidationResult expected = *result;
+        CalibrationValidationPoint expected_points[3];
+        memcpy(expected_points, result->points, sizeof(expected_points));
+        expected.points = expected_points;
+        TobiiResearchGazeData expected_samples[3][SAMPLE_COUNT];
+        for (size_t i = 0; i < 3; ++i) {
+            TEST_CHECK(result->points[i].gaze_data_count == SAMPLE_COUNT);
+            memcpy(expected_samples[i], result->points[i].gaze_data, sizeof(expected_samples[i]));
+        }
+
+        CalibrationValidationResult* copy = malloc(result->size);
+        memcpy(copy, result, result->size);
+        size_t size = result->size;
+        tobii_research_screen_based_calibration_validation_relocate_result(copy);
+        tobii_research_screen_based_calibration_validation_destroy_result(result);
+
+        check_same_result(copy, &expected);
+        TEST_CHECK(copy->size == size && in_block(copy->points, copy, size));
+        for (size_t i = 0; i < 3; ++i) {
+            const CalibrationValidationPoint* point = &copy->points[i];
+            if (modes[mode] == CALIBRATION_VALIDATION_RESULT_GAZE_DATA_COPY) {
+                TEST_CHECK(in_block(point->gaze_data, copy, size));
+            } else {
+                TEST_CHECK(point->gaze_data == expected_points[i].gaze_data);
+            }
+            TEST_CHECK(memcmp(point->gaze_data, expected_samples[i], sizeof(expected_samples[i])) == 0);
+        }
+        /* Allocated with malloc, so destroyed like any other result. */
+        tobii_research_screen_based_calibration_validation_destroy_result(copy);
+        destroy_validator(validator);
+    }
+}
+
+static void test_plan_waits_for_processing(void) {
+    /* Five points of 1000 samples do not fit in the queue. While the application thread does nothing, the plan waits
+     * at the point whose samples no longer fit and drops the samples received meanwhile. */
+    CalibrationValidator* validator = create_validator(1000, 3000);
+    CalibrationValidationPlanPoint points[5];
+    init_plan(points, 5);
+    for (size_t i = 0; i < 5; ++i) {
+        points[i].screen_point.x = 0.1f + 0.2f * i;
+    }
+    TEST_CHECK(tobii_research_screen_based_calibration_validation_start_plan(validator, points, 5) ==
+        CALIBRATION_VALIDATION_STATUS_OK);
+    for (size_t i = 0; i < 5; ++i) {
+        deliver_gaze_data(&points[i].screen_point, 1000);
+    }
+    CalibrationValidationStats stats;
+    TEST_CHECK(tobii_research_screen_based_calibration_validation_get_stats(validator, &stats) ==
+        CALIBRATION_VALIDATION_STATUS_OK);
+    size_t dropped = stats.dropped_gaze_data_count;
+    TEST_CHECK(dropped > 0 && dropped < 1000);
+    TEST_CHECK(tobii_research_screen_based_calibration_validation_is_collecting_data(validator));
+    /* Once processed, the last point gets the samples it is missing. */
+    deliver_gaze_data(&points[4].screen_point, dropped);
+    static const size_t indices[] = { 0, 1, 2, 3, 4 };
+    check_result(validator, points, indices, 5, 1000);
+    TEST_CHECK(tobii_research_screen_based_calibration_validation_get_stats(validator, &stats) ==
+        CALIBRATION_VALIDATION_STATUS_OK);
+    TEST_CHECK(stats.dropped_gaze_data_count == dropped);
+    destroy_validator(validator);
+}
+
+static void test_clear_after_point_ended(void) {
+    /* The first point ended before the clear, even though no sample of the second one is queued yet. */
+    CalibrationValidator* validator = create_validator(SAMPLE_COUNT, TIMEOUT);
+    CalibrationValidationPlanPoint points[3];
+    init_plan(points, 3);
+    TEST_CHECK(tobii_research_screen_based_calibration_validation_start_plan(validator, points, 3) ==
+        CALIBRATION_VALIDATION_STATUS_OK);
+    deliver_gaze_data(&points[0].screen_point, SAMPLE_COUNT);
+    TEST_CHECK(tobii_research_screen_based_calibration_validation_clear_collected_data(validator) ==
+        CALIBRATION_VALIDATION_STATUS_OK);
+    deliver_gaze_data(&points[1].screen_point, SAMPLE_COUNT);
+    deliver_gaze_data(&points[2].screen_point, SAMPLE_COUNT);
+    static const size_t indices[] = { 1, 2 };
+    check_result(validator, points, indices, 2, SAMPLE_COUNT);
+    destroy_validator(validator);
+}
+
+static void test_clear_during_point(void) {
+    /* The point being collected goes on and is stored with all of its samples. */
+    CalibrationValidator* validator = create_validator(SAMPLE_COUNT, TIMEOUT);
+    CalibrationValidationPlanPoint points[2];
+    init_plan(points, 2);
+    TEST_CHECK(tobii_research_screen_based_calibration_validation_start_plan(validator, points, 2) ==
+        CALIBRATION_VALIDATION_STATUS_OK);
+    deliver_gaze_data(&points[0].screen_point, SAMPLE_COUNT / 2);
+    TEST_CHECK(tobii_research_screen_based_calibration_validation_clear_collected_data(validator) ==
+        CALIBRATION_VALIDATION_STATUS_OK);
+    deliver_gaze_data(&points[0].screen_point, SAMPLE_COUNT - SAMPLE_COUNT / 2);
+    deliver_gaze_data(&points[1].screen_point, SAMPLE_COUNT);
+    static const size_t indices[] = { 0, 1 };
+    check_result(validator, points, indices, 2, SAMPLE_COUNT);
+    destroy_validator(validator);
+}
+
+static void test_discard_after_point_ended(void) {
+    CalibrationValidator* validator = create_validator(SAMPLE_COUNT, TIMEOUT);
+    CalibrationValidationPlanPoint points[3];
+    init_plan(points, 3);
+    TEST_CHECK(tobii_research_screen_based_calibration_validation_start_plan(validator, points, 3) ==
+        CALIBRATION_VALIDATION_STATUS_OK);
+    deliver_gaze_data(&points[0].screen_point, SAMPLE_COUNT);
+    TEST_CHECK(tobii_research_screen_based_calibration_validation_discard_collected_data(validator,
+        &points[0].screen_point) == CALIBRATION_VALIDATION_STATUS_OK);
+    deliver_gaze_data(&points[1].screen_point, SAMPLE_COUNT);
+    deliver_gaze_data(&points[2].screen_point, SAMPLE_COUNT);
+    static const size_t indices[] = { 1, 2 };
+    check_result(validator, points, indices, 2, SAMPLE_COUNT);
+    destroy_validator(validator);
+}
+
+static void test_next_plan(void) {
+    /* Samples of an earlier plan still queued when the next one starts are not stored with it. */
+    CalibrationValidator* validator = create_validator(SAMPLE_COUNT, TIMEOUT);
+    CalibrationValidationPlanPoint points[2];
+    init_plan(points, 2);
+    TEST_CHECK(tobii_research_screen_based_calibration_validation_start_plan(validator, points, 1) ==
+        CALIBRATION_VALIDATION_STATUS_OK);
+    deliver_gaze_data(&points[0].screen_point, SAMPLE_COUNT);
+    TEST_CHECK(tobii_research_screen_based_calibration_validation_clear_collected_data(validator) ==
+        CALIBRATION_VALIDATION_STATUS_OK);
+    TEST_CHECK(tobii_research_screen_based_calibration_validation_start_plan(validator, &points[1], 1) ==
+        CALIBRATION_VALIDATION_STATUS_OK);
+    deliver_gaze_data(&points[1].screen_point, SAMPLE_COUNT);
+    static const size_t indices[] = { 1 };
+    check_result(validator, points, indices, 1, SAMPLE_COUNT);
+    destroy_validator(validator);
+}
+
+/* Records a single point to path and returns the status of stopping the recording. */
+static CalibrationValidationStatus record_point(const char* path, const TobiiResearchNormalizedPoint2D* screen_point) {
+    CalibrationValidator* validator = init_validator(SAMPLE_COUNT, TIMEOUT);
+    TEST_CHECK(tobii_research_screen_based_calibration_validation_start_recording(validator, path) ==
+        CALIBRATION_VALIDATION_STATUS_OK);
+    enter_validation_mode(validator);
+    collect_point(validator, screen_point, SAMPLE_COUNT);
+    TEST_CHECK(tobii_research_screen_based_calibration_validation_leave_validation_mode(validator) ==
+        CALIBRATION_VALIDATION_STATUS_OK);
+    CalibrationValidationStatus status = tobii_research_screen_based_calibration_validation_stop_recording(validator);
+    TEST_CHECK(tobii_research_screen_based_calibration_validation_destroy(validator) ==
+        CALIBRATION_VALIDATION_STATUS_OK);
+    return status;
+}
+
+static void test_recording(void) {
+    /* The stimulus is written before the samples collected for it, which all are written. */
+    TobiiResearchNormalizedPoint2D screen_point = { 0.3f, 0.6f };
+    TEST_CHECK(record_point(RECORDING_PATH, &screen_point) == CALIBRATION_VALIDATION_STATUS_OK);
+    GazeRecording* recording = gaze_recording_open(RECORDING_PATH);
+    if (!recording) {
+        test_fail(__FILE__, __LINE__, "recording cannot be read");
+    } else {
+        const GazeRecord* records = gaze_recording_records(recording);
+        TEST_CHECK(gaze_recording_count(recording) == 1 + SAMPLE_COUNT);
+        TEST_CHECK(records[0].type == GAZE_RECORD_STIMULUS);
+        TEST_CHECK(records[0].data.stimulus.screen_point.x == screen_point.x);
+        for (size_t i = 1; i < gaze_recording_count(recording); ++i) {
+            TEST_CHECK(records[i].type == GAZE_RECORD_GAZE_DATA);
+            TEST_CHECK(i == 1 ||
+                records[i].data.gaze_data.system_time_stamp > records[i - 1].data.gaze_data.system_time_stamp);
+        }
+        gaze_recording_close(recording);
+    }
+    remove(RECORDING_PATH);
+
+#if defined(__linux__)
+    /* Every write to /dev/full fails, which is reported when the recording is stopped. */
+    TEST_CHECK(record_point("/dev/full", &screen_point) == CALIBRATION_VALIDATION_STATUS_INVALID_RECORDING);
+#endif
+}
+
+int main(void) {
+    test_point_index_probe_chains();
+    test_discard_points();
+    test_compute_threads();
+    test_stats();
+    test_incremental_compute();
+    test_export_binary();
+    test_export_json();
+    test_export_failure();
+    test_relocate_result();
+    test_plan_waits_for_processing();
+    test_clear_after_point_ended();
+    test_clear_during_point();
+    test_discard_after_point_ended();
+    test_next_plan();
+    test_recording();
+    return test_result("test_validator");
+}
@@ -0,0 +1,311 @@
+/*
+Copyright 2019 Tobii Pro AB
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+/* Tests of the vector operations, run with "make test". Every batch implementation the CPU supports is compared
+ * with the scalar one, which all of them must match bit for bit, and the scalar one with vector3_angle. Every angle
+ * kernel is checked against its documented error bound, see Vector3AngleKernel. */
+
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "test.h"
+#include "vectormath.h"
+
+/* Enough vectors for every SIMD width, followed by a tail that does not fill one. */
+#define VECTORS_COUNT (1027)
+/* vector3_angle_batch agrees with vector3_angle within this many degrees, see vectormath.h. */
+#define BATCH_ANGLE_MAX_ERROR (1e-4)
+/* Error bounds of the angle kernels in degrees, see Vector3AngleKernel. */
+#define REFERENCE_ANGLE_MAX_ERROR (1e-5)
+#define NORMALIZED_ANGLE_MAX_ERROR (0.05)
+#define NORMALIZED_ANGLE_MAX_ERROR_INSIDE (1e-3)
+#define ATAN2_ANGLE_MAX_ERROR (1e-5)
+#define KERNEL_PAIRS_COUNT (20000)
+
+static const char* const implementations[] = { "sse2", "avx2" };
+
+typedef struct {
+    float data[2][3 * VECTORS_COUNT];
+    Point3Arrays first;
+    Point3Arrays second;
+} Vectors;
+
+static uint32_t random_state = 12345;
+
+static float random_float(float low, float high) {
+    random_state = random_state * 1664525u + 1013904223u;
+    return low + (high - low) * (float)(random_state >> 8) / (float)(1 << 24);
+}
+
+static void set_vector(Point3Arrays* arrays, size_t index, float x, float y, float z) {
+    TobiiResearchVector3D vector = { x, y, z };
+    point3_arrays_set(arrays, index, &vector);
+}
+
+static void init_vectors(Vectors* vectors) {
+    point3_arrays_init(&vectors->first, vectors->data[0], VECTORS_COUNT);
+    point3_arrays_init(&vectors->second, vectors->data[1], VECTORS_COUNT);
+
+    size_t i = 0;
+    /* Zero vectors. */
+    set_vector(&vectors->first, i, 0.0f, 0.0f, 0.0f);
+    set_vector(&vectors->second, i++, 1.0f, 2.0f, 3.0f);
+    set_vector(&vectors->first, i, 1.0f, 2.0f, 3.0f);
+    set_vector(&vectors->second, i++, 0.0f, 0.0f, 0.0f);
+    set_vector(&vectors->first, i, 0.0f, 0.0f, 0.0f);
+    set_vector(&vectors->second, i++, 0.0f, 0.0f, 0.0f);
+    /* Parallel, antiparallel and orthogonal vectors. */
+    set_vector(&vectors->first, i, 1.0f, 0.0f, 0.0f);
+    set_vector(&vectors->second, i++, 1.0f, 0.0f, 0.0f);
+    set_vector(&vectors->first, i, 3.0f, -4.0f, 12.0f);
+    set_vector(&vectors->second, i++, 6.0f, -8.0f, 24.0f);
+    set_vector(&vectors->first, i, 1.0f, 0.0f, 0.0f);
+    set_vector(&vectors->second, i++, -1.0f, 0.0f, 0.0f);
+    set_vector(&vectors->first, i, 3.0f, -4.0f, 12.0f);
+    set_vector(&vectors->second, i++, -0.75f, 1.0f, -3.0f);
+    set_vector(&vectors->first, i, 0.0f, 1.0f, 0.0f);
+    set_vector(&vectors->second, i++, 0.0f, 0.0f, 1.0f);
+    /* Gaze vectors of typical length, a few degrees apart. */
+    while (i < VECTORS_COUNT / 2) {
+        float x = random_float(-300.0f, 300.0f);
+        float y = random_float(-200.0f, 200.0f);
+        float z = random_float(-650.0f, -550.0f);
+        set_vector(&vectors->first, i, x, y, z);
+        set_vector(&vectors->second, i++, x + random_float(-30.0f, 30.0f), y + random_float(-30.0f, 30.0f), z);
+    }
+    /* Vectors of any direction and length. */
+    while (i < VECTORS_COUNT) {
+        float scale = random_float(0.0f, 1.0f) < 0.5f ? 1e-3f : 1e3f;
+        set_vector(&vectors->first, i, scale * random_float(-1.0f, 1.0f), scale * random_float(-1.0f, 1.0f),
+            scale * random_float(-1.0f, 1.0f));
+        set_vector(&vectors->second, i++, random_float(-1.0f, 1.0f), random_float(-1.0f, 1.0f),
+            random_float(-1.0f, 1.0f));
+    }
+}
+
+static int is_zero_vector(const Point3Arrays* arrays, size_t index) {
+    return arrays->x[index] == 0.0f && arrays->y[index] == 0.0f && arrays->z[index] == 0.0f;
+}
+
+static int same_float(float first, float second) {
+    /* Bit for bit, or both NaN as for zero vectors. */
+    return memcmp(&first, &second, sizeof(first)) == 0 || (isnan(first) && isnan(second));
+}
+
+static void test_scalar_angles(const Vectors* vectors) {
+    static float angles[VECTORS_COUNT];
+    vector3_angle_batch(angles, &vectors->first, &vectors->second, VECTORS_COUNT);
+    for (size_t i = 0; i < VECTORS_COUNT; ++i) {
+        if (is_zero_vector(&vectors->first, i) || is_zero_vector(&vectors->second, i)) {
+            TEST_CHECK(angles[i] == 0.0f);
+            continue;
+        }
+        TobiiResearchVector3D first;
+        TobiiResearchVector3D second;
+        point3_arrays_get(&first, &vectors->first, i);
+        point3_arrays_get(&second, &vectors->second, i);
+        float expected = vector3_angle(&first, &second);
+        if (!(fabs(angles[i] - expected) <= BATCH_ANGLE_MAX_ERROR)) {
+            test_fail(__FILE__, __LINE__, "angle %zu is %.9g degrees, expected %.9g", i, angles[i], expected);
+        }
+    }
+    TEST_CHECK(angles[3] == 0.0f);
+    TEST_CHECK(angles[5] == 180.0f);
+    TEST_CHECK(fabsf(angles[7] - 90.0f) <= BATCH_ANGLE_MAX_ERROR);
+}
+
+static void test_scalar_normalize(const Vectors* vectors) {
+    static float data[3 * VECTORS_COUNT];
+    Point3Arrays normalized;
+    point3_arrays_init(&normalized, data, VECTORS_COUNT);
+    memcpy(data, vectors->data[0], sizeof(data));
+    vector3_normalize_batch(&normalized, VECTORS_COUNT);
+    for (size_t i = 0; i < VECTORS_COUNT; ++i) {
+        if (is_zero_vector(&vectors->first, i)) {
+            continue;
+        }
+        TobiiResearchVector3D vector;
+        point3_arrays_get(&vector, &normalized, i);
+        double magnitude = vector3_magnitude(&vector);
+        if (!(fabs(magnitude - 1.0) <= 1e-6)) {
+            test_fail(__FILE__, __LINE__, "normalized vector %zu has magnitude %.9g", i, magnitude);
+        }
+    }
+}
+
+static double exact_angle(const TobiiResearchVector3D* first, const TobiiResearchVector3D* second) {
+    /* Between the single precision vectors, in long double. */
+    long double cross_x = (long double)first->y * second->z - (long double)first->z * second->y;
+    long double cross_y = (long double)first->z * second->x - (long double)first->x * second->z;
+    long double cross_z = (long double)first->x * second->y - (long double)first->y * second->x;
+    long double dot = (long double)first->x * second->x + (long double)first->y * second->y +
+        (long double)first->z * second->z;
+    long double sine = sqrtl(cross_x * cross_x + cross_y * cross_y + cross_z * cross_z);
+    return (double)(atan2l(sine, dot) * 180.0L / 3.14159265358979323846264338327950288L);
+}
+
+static void random_unit_vector(TobiiResearchVector3D* vector) {
+    do {
+        vector->x = random_float(-1.0f, 1.0f);
+        vector->y = random_float(-1.0f, 1.0f);
+        vector->z = random_float(-1.0f, 1.0f);
+    } while (vector3_magnitude(vector) < 0.1);
+    vector3_normalize(vector);
+}
+
+static void random_pair(TobiiResearchVector3D* first, TobiiResearchVector3D* second) {
+    /* Any length, at an angle between 1e-4 and 180 degrees, evenly spread on a logarithmic scale, half of them
+     * mirrored to cover angles close to 180 degrees as well. */
+    TobiiResearchVector3D axis;
+    TobiiResearchVector3D perpendicular;
+    random_unit_vector(&axis);
+    do {
+        random_unit_vector(&perpendicular);
+        double along = vector3_dot_product(&perpendicular, &axis);
+        perpendicular.x -= (float)along * axis.x;
+        perpendicular.y -= (float)along * axis.y;
+        perpendicular.z -= (float)along * axis.z;
+    } while (vector3_magnitude(&perpendicular) < 0.1);
+    vector3_normalize(&perpendicular);
+
+    double angle = pow(10.0, random_float(-4.0f, log10f(180.0f))) * 3.14159265358979323846 / 180.0;
+    if (random_float(0.0f, 1.0f) < 0.5f) {
+        angle = 3.14159265358979323846 - angle;
+    }
+    float length = powf(10.0f, random_float(-2.0f, 3.0f));
+    *first = axis;
+    vector3_mul(first, length);
+    second->x = (float)(cos(angle) * axis.x + sin(angle) * perpendicular.x);
+    second->y = (float)(cos(angle) * axis.y + sin(angle) * perpendicular.y);
+    second->z = (float)(cos(angle) * axis.z + sin(angle) * perpendicular.z);
+    vector3_mul(second, powf(10.0f, random_float(-2.0f, 3.0f)));
+}
+
+static void check_angle(const char* kernel, size_t index, float angle, double expected, double max_error) {
+    if (!(fabs(angle - expected) <= max_error)) {
+        test_fail(__FILE__, __LINE__, "%s angle of pair %zu is %.9g degrees, exactly %.9g, more than %g off",
+            kernel, index, angle, expected, max_error);
+    }
+}
+
+static void test_angle_kernels(void) {
+    static float first_data[3 * KERNEL_PAIRS_COUNT];
+    static float second_data[3 * KERNEL_PAIRS_COUNT];
+    static double expected[KERNEL_PAIRS_COUNT];
+    static float angles[KERNEL_PAIRS_COUNT];
+    Point3Arrays first_arrays;
+    Point3Arrays second_arrays;
+    point3_arrays_init(&first_arrays, first_data, KERNEL_PAIRS_COUNT);
+    point3_arrays_init(&second_arrays, second_data, KERNEL_PAIRS_COUNT);
+
+    for (size_t i = 0; i < KERNEL_PAIRS_COUNT; ++i) {
+        TobiiResearchVector3D first;
+        TobiiResearchVector3D second;
+        random_pair(&first, &second);
+        point3_arrays_set(&first_arrays, i, &first);
+        point3_arrays_set(&second_arrays, i, &second);
+        expected[i] = exact_angle(&first, &second);
+
+        check_angle("reference", i, vector3_angle_with(VECTOR3_ANGLE_KERNEL_REFERENCE, &first, &second), expected[i],
+            REFERENCE_ANGLE_MAX_ERROR);
+        check_angle("atan2", i, vector3_angle_with(VECTOR3_ANGLE_KERNEL_ATAN2, &first, &second), expected[i],
+            ATAN2_ANGLE_MAX_ERROR);
+        check_angle("fast", i, vector3_angle_with(VECTOR3_ANGLE_KERNEL_FAST, &first, &second), expected[i],
+            VECTOR3_ANGLE_FAST_MAX_ERROR);
+
+        /* Only for directions normalized in single precision, the error is relative to their exact angle. */
+        vector3_normalize(&first);
+        vector3_normalize(&second);
+        double normalized_expected = exact_angle(&first, &second);
+        int inside = normalized_expected >= 1.0 && normalized_expected <= 179.0;
+        check_angle("normalized", i, vector3_angle_with(VECTOR3_ANGLE_KERNEL_NORMALIZED, &first, &second),
+            normalized_expected, inside ? NORMALIZED_ANGLE_MAX_ERROR_INSIDE : NORMALIZED_ANGLE_MAX_ERROR);
+    }
+
+    vector3_angle_batch_with(VECTOR3_ANGLE_KERNEL_ATAN2, angles, &first_arrays, &second_arrays, KERNEL_PAIRS_COUNT);
+    for (size_t i = 0; i < KERNEL_PAIRS_COUNT; ++i) {
+        check_angle("atan2 batch", i, angles[i], expected[i], BATCH_ANGLE_MAX_ERROR);
+    }
+    vector3_angle_batch_with(VECTOR3_ANGLE_KERNEL_FAST, angles, &first_arrays, &second_arrays, KERNEL_PAIRS_COUNT);
+    for (size_t i = 0; i < KERNEL_PAIRS_COUNT; ++i) {
+        check_angle("fast batch", i, angles[i], expected[i], VECTOR3_ANGLE_FAST_MAX_ERROR);
+    }
+}
+
+static void test_implementation(const char* implementation, const Vectors* vectors) {
+    /* Counts around the SIMD widths, so that every tail length is covered, and all vectors. */
+    static const size_t counts[] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 11, 12, 13, 15, 16, 17, VECTORS_COUNT };
+    static float expected[VECTORS_COUNT];
+    static float angles[VECTORS_COUNT];
+    for (size_t count_index = 0; count_index < sizeof(counts) / sizeof(counts[0]); ++count_index) {
+        size_t checked_count = counts[count_index];
+        for (int fast = 0; fast <= 1; ++fast) {
+            Vector3AngleKernel kernel = fast ? VECTOR3_ANGLE_KERNEL_FAST : VECTOR3_ANGLE_KERNEL_ATAN2;
+            vectormath_batch_use("scalar");
+            vector3_angle_batch_with(kernel, expected, &vectors->first, &vectors->second, checked_count);
+            vectormath_batch_use(implementation);
+            vector3_angle_batch_with(kernel, angles, &vectors->first, &vectors->second, checked_count);
+            for (size_t i = 0; i < checked_count; ++i) {
+                if (!same_float(angles[i], expected[i])) {
+                    test_fail(__FILE__, __LINE__, "%s %s angle %zu of %zu is %.9g degrees, scalar gives %.9g",
+                        implementation, fast ? "fast" : "atan2", i, checked_count, angles[i], expected[i]);
+                }
+            }
+        }
+    }
+
+    static float expected_data[3 * VECTORS_COUNT];
+    static float data[3 * VECTORS_COUNT];
+    Point3Arrays expected_normalized;
+    Point3Arrays normalized;
+    point3_arrays_init(&expected_normalized, expected_data, VECTORS_COUNT);
+    point3_arrays_init(&normalized, data, VECTORS_COUNT);
+    memcpy(expected_data, vectors->data[1], sizeof(expected_data));
+    memcpy(data, vectors->data[1], sizeof(data));
+    vectormath_batch_use("scalar");
+    vector3_normalize_batch(&expected_normalized, VECTORS_COUNT);
+    vectormath_batch_use(implementation);
+    vector3_normalize_batch(&normalized, VECTORS_COUNT);
+    for (size_t i = 0; i < 3 * VECTORS_COUNT; ++i) {
+        if (!same_float(data[i], expected_data[i])) {
+            test_fail(__FILE__, __LINE__, "%s normalized coordinate %zu is %.9g, scalar gives %.9g",
+                implementation, i, data[i], expected_data[i]);
+        }
+    }
+}
+
+int main(void) {
+    static Vectors vectors;
+    init_vectors(&vectors);
+
+    TEST_CHECK(vectormath_batch_use("scalar"));
+    TEST_CHECK(!vectormath_batch_use("none"));
+    test_scalar_angles(&vectors);
+    test_scalar_normalize(&vectors);
+    test_angle_kernels();
+
+    for (size_t i = 0; i < sizeof(implementations) / sizeof(implementations[0]); ++i) {
+        if (!vectormath_batch_use(implementations[i])) {
+            printf("test_vectormath: %s is not supported by the CPU, skipped\n", implementations[i]);
+            continue;
+        }
+        test_implementation(implementations[i], &vectors);
+    }
+
+    return test_result("test_vectormath");
+}
@@ -0,0 +1,137 @@
+/*
+Copyright 2019 Tobii Pro AB
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "trace.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#if defined(CALIBRATION_VALIDATION_TRACE)
+
+#include "atomics.h"
+#include "stopwatch.h"
+
+#if defined(_WIN32) || defined(_WIN64)
+#define THREAD_LOCAL __declspec(thread)
+#else
+#define THREAD_LOCAL __thread
+#endif
+
+#define TRACE_BUFFER_CAPACITY (16384)
+
+typedef struct {
+    const char* name;
+    int64_t start;
+    int64_t duration;
+} TraceSpan;
+
+/* Only the owning thread appends spans. Publishing the count with release semantics lets trace_write read the
+ * spans below it while the thread goes on recording. */
+typedef struct TraceBuffer TraceBuffer;
+struct TraceBuffer {
+    TraceBuffer* next;
+    size_t thread_id;
+    volatile size_t count;
+    TraceSpan spans[TRACE_BUFFER_CAPACITY];
+};
+
+/* Buffers are never freed, so that the spans of threads that have ended are still written. Both are pointers
+ * stored as size_t for the atomic operations. */
+static volatile size_t trace_buffers = 0;
+static volatile size_t trace_stopwatch = 0;
+
+static THREAD_LOCAL TraceBuffer* thread_buffer = NULL;
+
+static Stopwatch* get_stopwatch() {
+    size_t stopwatch = atomic_load_acquire(&trace_stopwatch);
+    if (!stopwatch) {
+        Stopwatch* new_stopwatch = stopwatch_init();
+        stopwatch_start(new_stopwatch);
+        if (atomic_compare_exchange(&trace_stopwatch, 0, (size_t)new_stopwatch)) {
+            stopwatch = (size_t)new_stopwatch;
+        } else {
+            /* Another thread was first. */
+            free(new_stopwatch);
+            stopwatch = atomic_load_acquire(&trace_stopwatch);
+        }
+    }
+    return (Stopwatch*)stopwatch;
+}
+
+static TraceBuffer* get_thread_buffer() {
+    if (!thread_buffer) {
+        TraceBuffer* buffer = malloc(sizeof(*buffer));
+        buffer->count = 0;
+        size_t head;
+        do {
+            head = atomic_load_acquire(&trace_buffers);
+            buffer->next = (TraceBuffer*)head;
+            buffer->thread_id = head ? buffer->next->thread_id + 1 : 1;
+        } while (!atomic_compare_exchange(&trace_buffers, head, (size_t)buffer));
+        thread_buffer = buffer;
+    }
+    return thread_buffer;
+}
+
+int64_t trace_now() {
+    return stopwatch_elapsed_ns(get_stopwatch());
+}
+
+void trace_span(const char* name, int64_t start) {
+    int64_t end = trace_now();
+    TraceBuffer* buffer = get_thread_buffer();
+    size_t count = buffer->count;
+    if (count == TRACE_BUFFER_CAPACITY) {
+        return;
+    }
+    buffer->spans[count].name = name;
+    buffer->spans[count].start = start;
+    buffer->spans[count].duration = end - start;
+    atomic_store_release(&buffer->count, count + 1);
+}
+
+static void write_spans(FILE* file) {
+    const char* separator = "";
+    for (TraceBuffer* buffer = (TraceBuffer*)atomic_load_acquire(&trace_buffers); buffer; buffer = buffer->next) {
+        size_t count = atomic_load_acquire(&buffer->count);
+        for (size_t i = 0; i < count; ++i) {
+            const TraceSpan* span = &buffer->spans[i];
+            /* Complete events, with time stamps and durations in microseconds. */
+            fprintf(file, "%s\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%zu,\"ts\":%.3f,\"dur\":%.3f}",
+                separator, span->name, buffer->thread_id, span->start / 1000.0, span->duration / 1000.0);
+            separator = ",";
+        }
+    }
+}
+
+#else
+
+static void write_spans(FILE* file) {
+    (void)file;
+}
+
+#endif
+
+int trace_write(const char* path) {
+    FILE* file = fopen(path, "w");
+    if (!file) {
+        return 0;
+    }
+    fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+    write_spans(file);
+    fprintf(file, "\n]}\n");
+    return fclose(file) == 0;
+}
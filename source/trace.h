@@ -0,0 +1,59 @@
+/*
+Copyright 2019 Tobii Pro AB
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef TRACE_H_
+#define TRACE_H_
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Records named spans of wall-clock time for a Chrome/Perfetto trace. Each thread appends to a buffer of its own
+ * without locking, so spans can be recorded from the gaze data callback and the worker threads as well. A full
+ * buffer drops further spans.
+ *
+ * Tracing is compiled out unless CALIBRATION_VALIDATION_TRACE is defined, e.g. by building with make TRACE=1.
+ * Only use the macros below, span names must be string literals. */
+
+#if defined(CALIBRATION_VALIDATION_TRACE)
+
+/* Nanoseconds since tracing was first used. */
+extern int64_t trace_now();
+
+/* Records a span from start, as returned by trace_now, until now. */
+extern void trace_span(const char* name, int64_t start);
+
+#define TRACE_NOW() trace_now()
+#define TRACE_SPAN(name, start) trace_span(name, start)
+
+#else
+
+#define TRACE_NOW() ((int64_t)0)
+#define TRACE_SPAN(name, start) ((void)(start))
+
+#endif
+
+/* Writes all spans recorded so far, by any thread, as trace event JSON. An empty trace if tracing is compiled out.
+ * Returns nonzero on success. */
+extern int trace_write(const char* path);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* TRACE_H_ */
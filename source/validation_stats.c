@@ -0,0 +1,85 @@
+/*
+Copyright 2019 Tobii Pro AB
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "validation_stats.h"
+
+#include <stdlib.h>
+
+#include "atomics.h"
+
+struct ValidationStats {
+    volatile size_t counters[VALIDATION_STATS_COUNTER_COUNT];
+    volatile size_t histograms[VALIDATION_STATS_HISTOGRAM_COUNT][CALIBRATION_VALIDATION_STATS_BUCKET_COUNT];
+};
+
+static size_t bucket_of(int64_t duration) {
+    /* Bucket i > 0 starts at 2^(i-1) microseconds. */
+    int64_t microseconds = duration / 1000;
+    size_t bucket = 0;
+    while (microseconds > 0 && bucket < CALIBRATION_VALIDATION_STATS_BUCKET_COUNT - 1) {
+        microseconds >>= 1;
+        bucket++;
+    }
+    return bucket;
+}
+
+ValidationStats* validation_stats_init() {
+    ValidationStats* instance = malloc(sizeof(*instance));
+    validation_stats_reset(instance);
+    return instance;
+}
+
+void validation_stats_destroy(ValidationStats* instance) {
+    free(instance);
+}
+
+void validation_stats_count(ValidationStats* instance, ValidationStatsCounter counter) {
+    atomic_add_relaxed(&instance->counters[counter], 1);
+}
+
+void validation_stats_add_duration(ValidationStats* instance, ValidationStatsHistogram histogram,
+    int64_t duration) {
+    atomic_add_relaxed(&instance->histograms[histogram][bucket_of(duration)], 1);
+}
+
+void validation_stats_get(ValidationStats* instance, CalibrationValidationStats* stats) {
+    stats->gaze_data_count = atomic_load_relaxed(&instance->counters[VALIDATION_STATS_GAZE_DATA]);
+    stats->idle_gaze_data_count = atomic_load_relaxed(&instance->counters[VALIDATION_STATS_IDLE_GAZE_DATA]);
+    stats->invalid_gaze_data_count = atomic_load_relaxed(&instance->counters[VALIDATION_STATS_INVALID_GAZE_DATA]);
+    stats->dropped_gaze_data_count = atomic_load_relaxed(&instance->counters[VALIDATION_STATS_DROPPED_GAZE_DATA]);
+    stats->completed_collection_count =
+        atomic_load_relaxed(&instance->counters[VALIDATION_STATS_COMPLETED_COLLECTIONS]);
+    stats->timed_out_collection_count =
+        atomic_load_relaxed(&instance->counters[VALIDATION_STATS_TIMED_OUT_COLLECTIONS]);
+    stats->compute_count = atomic_load_relaxed(&instance->counters[VALIDATION_STATS_COMPUTES]);
+    for (size_t i = 0; i < CALIBRATION_VALIDATION_STATS_BUCKET_COUNT; ++i) {
+        stats->gaze_data_callback_durations[i] =
+            atomic_load_relaxed(&instance->histograms[VALIDATION_STATS_GAZE_DATA_CALLBACK_DURATION][i]);
+        stats->compute_durations[i] =
+            atomic_load_relaxed(&instance->histograms[VALIDATION_STATS_COMPUTE_DURATION][i]);
+    }
+}
+
+void validation_stats_reset(ValidationStats* instance) {
+    for (size_t i = 0; i < VALIDATION_STATS_COUNTER_COUNT; ++i) {
+        atomic_store_relaxed(&instance->counters[i], 0);
+    }
+    for (size_t i = 0; i < VALIDATION_STATS_HISTOGRAM_COUNT; ++i) {
+        for (size_t j = 0; j < CALIBRATION_VALIDATION_STATS_BUCKET_COUNT; ++j) {
+            atomic_store_relaxed(&instance->histograms[i][j], 0);
+        }
+    }
+}
@@ -0,0 +1,67 @@
+/*
+Copyright 2019 Tobii Pro AB
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef VALIDATION_STATS_H_
+#define VALIDATION_STATS_H_
+
+#include <stdint.h>
+
+#include "screen_based_calibration_validation.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Counters behind CalibrationValidationStats. They are updated with relaxed atomic operations, so that the gaze
+ * data callback and the application thread can both count without locking and the application thread can read or
+ * reset them at any time. */
+
+typedef enum {
+    VALIDATION_STATS_GAZE_DATA,
+    VALIDATION_STATS_IDLE_GAZE_DATA,
+    VALIDATION_STATS_INVALID_GAZE_DATA,
+    VALIDATION_STATS_DROPPED_GAZE_DATA,
+    VALIDATION_STATS_COMPLETED_COLLECTIONS,
+    VALIDATION_STATS_TIMED_OUT_COLLECTIONS,
+    VALIDATION_STATS_COMPUTES,
+    VALIDATION_STATS_COUNTER_COUNT,
+} ValidationStatsCounter;
+
+typedef enum {
+    VALIDATION_STATS_GAZE_DATA_CALLBACK_DURATION,
+    VALIDATION_STATS_COMPUTE_DURATION,
+    VALIDATION_STATS_HISTOGRAM_COUNT,
+} ValidationStatsHistogram;
+
+typedef struct ValidationStats ValidationStats;
+
+extern ValidationStats* validation_stats_init();
+extern void validation_stats_destroy(ValidationStats* instance);
+
+extern void validation_stats_count(ValidationStats* instance, ValidationStatsCounter counter);
+
+/* Adds a duration in nanoseconds to the histogram. */
+extern void validation_stats_add_duration(ValidationStats* instance, ValidationStatsHistogram histogram,
+    int64_t duration);
+
+extern void validation_stats_get(ValidationStats* instance, CalibrationValidationStats* stats);
+extern void validation_stats_reset(ValidationStats* instance);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* VALIDATION_STATS_H_ */
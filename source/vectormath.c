@@ -15,6 +15,7 @@ limitations under the License.
 */
 
 #include <math.h>
+#include <string.h>
 
 #include  "vectormath.h"
 
@@ -28,6 +29,23 @@ int point2_equal(const TobiiResearchNormalizedPoint2D* first, const TobiiResearc
     return IS_CLOSE(first->x, second->x) && IS_CLOSE(first->y, second->y);
 }
 
+uint32_t point2_hash(const TobiiResearchNormalizedPoint2D* point) {
+    /* REL_TOL is far below the float resolution, so IS_CLOSE only holds for equal values and quantizing to the
+     * float bit pattern is consistent with point2_equal. Adding zero maps -0 to +0, which compare equal. */
+    float coordinates[2] = { point->x + 0.0f, point->y + 0.0f };
+    uint32_t bits[2];
+    memcpy(bits, coordinates, sizeof(bits));
+
+    /* 64-bit finalizer of MurmurHash3. */
+    uint64_t key = ((uint64_t)bits[0] << 32) | bits[1];
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdULL;
+    key ^= key >> 33;
+    key *= 0xc4ceb9fe1a85ec53ULL;
+    key ^= key >> 33;
+    return (uint32_t)key;
+}
+
 void point3_set_zero(TobiiResearchPoint3D* point) {
     point->x = 0.0f;
     point->y = 0.0f;
@@ -96,6 +114,62 @@ float vector3_angle(const TobiiResearchVector3D* first, const TobiiResearchVecto
     return (float)(angle * 180 / M_PI);
 }
 
+float vector3_angle_with(Vector3AngleKernel kernel,
+    const TobiiResearchVector3D* first, const TobiiResearchVector3D* second) {
+    switch (kernel) {
+        case VECTOR3_ANGLE_KERNEL_NORMALIZED: {
+            double angle = acos(CLAMP(vector3_dot_product(first, second), -1.0, 1.0));
+            return (float)(angle * 180 / M_PI);
+        }
+
+        case VECTOR3_ANGLE_KERNEL_ATAN2: {
+            double cross_x = (double)first->y * second->z - (double)first->z * second->y;
+            double cross_y = (double)first->z * second->x - (double)first->x * second->z;
+            double cross_z = (double)first->x * second->y - (double)first->y * second->x;
+            double sine = sqrt(cross_x * cross_x + cross_y * cross_y + cross_z * cross_z);
+            double angle = atan2(sine, vector3_dot_product(first, second));
+            return (float)(angle * 180 / M_PI);
+        }
+
+        case VECTOR3_ANGLE_KERNEL_FAST: {
+            /* A batch of one, the arrays only ever being read at index zero. */
+            Point3Arrays first_arrays = { (float*)&first->x, (float*)&first->y, (float*)&first->z };
+            Point3Arrays second_arrays = { (float*)&second->x, (float*)&second->y, (float*)&second->z };
+            float angle;
+            vector3_angle_batch_with(VECTOR3_ANGLE_KERNEL_FAST, &angle, &first_arrays, &second_arrays, 1);
+            return angle;
+        }
+
+        case VECTOR3_ANGLE_KERNEL_REFERENCE:
+        default:
+            return vector3_angle(first, second);
+    }
+}
+
+void point3_arrays_init(Point3Arrays* arrays, float* data, size_t stride) {
+    arrays->x = data;
+    arrays->y = data + stride;
+    arrays->z = data + 2 * stride;
+}
+
+void point3_arrays_offset(Point3Arrays* result, const Point3Arrays* arrays, size_t offset) {
+    result->x = arrays->x + offset;
+    result->y = arrays->y + offset;
+    result->z = arrays->z + offset;
+}
+
+void point3_arrays_get(TobiiResearchPoint3D* point, const Point3Arrays* arrays, size_t index) {
+    point->x = arrays->x[index];
+    point->y = arrays->y[index];
+    point->z = arrays->z[index];
+}
+
+void point3_arrays_set(Point3Arrays* arrays, size_t index, const TobiiResearchPoint3D* point) {
+    arrays->x[index] = point->x;
+    arrays->y[index] = point->y;
+    arrays->z[index] = point->z;
+}
+
 void calculate_normalized_point2_to_point3(TobiiResearchPoint3D* result,
     const TobiiResearchDisplayArea* display_area, const TobiiResearchNormalizedPoint2D* target_point) {
     TobiiResearchPoint3D dx, dy;
@@ -17,6 +17,8 @@ limitations under the License.
 #ifndef VECTORMATH_H_
 #define VECTORMATH_H_
 
+#include <stdint.h>
+
 #include "tobii_research.h"
 #include "tobii_research_eyetracker.h"
 
@@ -25,6 +27,8 @@ extern "C" {
 #endif
 
 extern int point2_equal(const TobiiResearchNormalizedPoint2D* first, const TobiiResearchNormalizedPoint2D* second);
+/* Points that are point2_equal have the same hash. */
+extern uint32_t point2_hash(const TobiiResearchNormalizedPoint2D* point);
 
 extern void point3_set_zero(TobiiResearchPoint3D* point);
 extern void point3_add(TobiiResearchPoint3D* to, const TobiiResearchPoint3D* from);
@@ -43,6 +47,55 @@ extern double vector3_magnitude(const TobiiResearchVector3D* vector);
 extern void vector3_normalize(TobiiResearchVector3D* vector);
 extern float vector3_angle(const TobiiResearchVector3D* first, const TobiiResearchVector3D* second);
 
+/* Ways of computing the angle between two vectors in degrees, from slowest to fastest. Errors are relative to
+ * the exact angle between the single precision vectors, and include the rounding of the result to single
+ * precision of up to 7.6e-6 degrees. */
+typedef enum {
+    /* acos(a . b / (|a| |b|)) in double precision, as vector3_angle. Within 1e-5 degrees. */
+    VECTOR3_ANGLE_KERNEL_REFERENCE,
+    /* acos(a . b) in double precision, skipping the magnitudes. For unit vectors only. Single precision unit
+     * vectors are not exactly of unit length, which the cosine is sensitive to close to 0 and 180 degrees. Within
+     * 0.05 degrees, and within 1e-3 degrees between 1 and 179 degrees. */
+    VECTOR3_ANGLE_KERNEL_NORMALIZED,
+    /* atan2(|a x b|, a . b), well conditioned for any angle and vector lengths. Double precision for single
+     * vectors, within 1e-5 degrees. Single precision in batches, see vector3_angle_batch. */
+    VECTOR3_ANGLE_KERNEL_ATAN2,
+    /* atan2(|a x b|, a . b) in single precision with a shorter polynomial and no range reduction, within
+     * VECTOR3_ANGLE_FAST_MAX_ERROR degrees. */
+    VECTOR3_ANGLE_KERNEL_FAST,
+} Vector3AngleKernel;
+
+#define VECTOR3_ANGLE_FAST_MAX_ERROR (1e-3f)
+
+extern float vector3_angle_with(Vector3AngleKernel kernel,
+    const TobiiResearchVector3D* first, const TobiiResearchVector3D* second);
+
+/* Structure of arrays representation of a sequence of 3D points or vectors. */
+typedef struct {
+    float* x;
+    float* y;
+    float* z;
+} Point3Arrays;
+
+extern void point3_arrays_init(Point3Arrays* arrays, float* data, size_t stride);
+extern void point3_arrays_offset(Point3Arrays* result, const Point3Arrays* arrays, size_t offset);
+extern void point3_arrays_get(TobiiResearchPoint3D* point, const Point3Arrays* arrays, size_t index);
+extern void point3_arrays_set(Point3Arrays* arrays, size_t index, const TobiiResearchPoint3D* point);
+
+/* Batch operations over count vectors, see vectormath_batch.c. The implementation (AVX2, SSE2 or scalar) is
+ * picked at runtime from the CPU features and all of them give identical results. Angles are computed as
+ * atan2(|a x b|, a . b) in single precision and agree with vector3_angle within 1e-4 degrees. */
+extern void vector3_normalize_batch(Point3Arrays* vectors, size_t count);
+extern void vector3_angle_batch(float* angles, const Point3Arrays* first, const Point3Arrays* second, size_t count);
+/* vector3_angle_batch for VECTOR3_ANGLE_KERNEL_ATAN2, vector3_angle_with for each vector otherwise, except that
+ * VECTOR3_ANGLE_KERNEL_FAST is vectorized as well. */
+extern void vector3_angle_batch_with(Vector3AngleKernel kernel, float* angles, const Point3Arrays* first,
+    const Point3Arrays* second, size_t count);
+extern const char* vectormath_batch_implementation(void);
+/* Makes the batch operations use the named implementation instead of the one picked from the CPU features, for
+ * tests. Returns zero if the CPU does not support it. Must not be called while batch operations are running. */
+extern int vectormath_batch_use(const char* implementation);
+
 extern void calculate_normalized_point2_to_point3(TobiiResearchPoint3D* result,
     const TobiiResearchDisplayArea* display_area, const TobiiResearchNormalizedPoint2D* target_point);
 
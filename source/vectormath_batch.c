@@ -0,0 +1,376 @@
+/*
+Copyright 2019 Tobii Pro AB
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <math.h>
+#include <string.h>
+
+#include "vectormath.h"
+
+/* All implementations perform the same single precision operations in the same order, so the SIMD versions
+ * give bit identical results to the scalar fallback. The arctangent is the Cephes atanf polynomial with range
+ * reduction to [0, tan(pi/8)], accurate to about 2e-7 radians.
+ *
+ * The fast variant of VECTOR3_ANGLE_KERNEL_FAST saves the division of the range reduction with a minimax
+ * polynomial over all of [0, 1]. Its error, 1.2e-5 radians or 6.8e-4 degrees including single precision
+ * rounding, was found by evaluating it for every float in [0, 1]. */
+
+#define ATAN_P0 (8.05374449538e-2f)
+#define ATAN_P1 (-1.38776856032e-1f)
+#define ATAN_P2 (1.99777106478e-1f)
+#define ATAN_P3 (-3.33329491539e-1f)
+#define ATAN_FAST_C1 (0.999866542f)
+#define ATAN_FAST_C3 (-0.330308348f)
+#define ATAN_FAST_C5 (0.180174758f)
+#define ATAN_FAST_C7 (-0.0851804816f)
+#define ATAN_FAST_C9 (0.0208573996f)
+#define TAN_PI_8 (0.414213562373f)
+#define PI_F (3.14159265358979f)
+#define PI_2_F (1.57079632679490f)
+#define PI_4_F (0.78539816339745f)
+#define DEGREES_PER_RADIAN_F (57.2957795130823f)
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define VECTORMATH_X86
+#endif
+
+typedef void (*normalize_batch_function)(Point3Arrays* vectors, size_t begin, size_t end);
+typedef void (*angle_batch_function)(float* angles, const Point3Arrays* first, const Point3Arrays* second,
+    size_t begin, size_t end, int fast);
+
+/* atan2(y, x) in degrees for y >= 0. */
+static float atan2_degrees_scalar(float y, float x, int fast) {
+    float abs_x = fabsf(x);
+    float high = y > abs_x ? y : abs_x;
+    float low = y > abs_x ? abs_x : y;
+    float t = high > 0.0f ? low / high : 0.0f;
+    float angle;
+    if (fast) {
+        float z = t * t;
+        float p = ATAN_FAST_C9;
+        p = p * z + ATAN_FAST_C7;
+        p = p * z + ATAN_FAST_C5;
+        p = p * z + ATAN_FAST_C3;
+        p = p * z + ATAN_FAST_C1;
+        angle = p * t;
+    } else {
+        int reduce = t > TAN_PI_8;
+        if (reduce) {
+            t = (t - 1.0f) / (t + 1.0f);
+        }
+        float z = t * t;
+        float p = ATAN_P0;
+        p = p * z + ATAN_P1;
+        p = p * z + ATAN_P2;
+        p = p * z + ATAN_P3;
+        angle = p * z * t + t;
+        if (reduce) {
+            angle = angle + PI_4_F;
+        }
+    }
+    if (y > abs_x) {
+        angle = PI_2_F - angle;
+    }
+    if (x < 0.0f) {
+        angle = PI_F - angle;
+    }
+    return angle * DEGREES_PER_RADIAN_F;
+}
+
+static void normalize_batch_scalar(Point3Arrays* vectors, size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+        float x = vectors->x[i];
+        float y = vectors->y[i];
+        float z = vectors->z[i];
+        float factor = 1.0f / sqrtf(x * x + y * y + z * z);
+        vectors->x[i] = x * factor;
+        vectors->y[i] = y * factor;
+        vectors->z[i] = z * factor;
+    }
+}
+
+static void angle_batch_scalar(float* angles, const Point3Arrays* first, const Point3Arrays* second,
+    size_t begin, size_t end, int fast) {
+    for (size_t i = begin; i < end; ++i) {
+        float ax = first->x[i], ay = first->y[i], az = first->z[i];
+        float bx = second->x[i], by = second->y[i], bz = second->z[i];
+        float cx = ay * bz - az * by;
+        float cy = az * bx - ax * bz;
+        float cz = ax * by - ay * bx;
+        float sine = sqrtf(cx * cx + cy * cy + cz * cz);
+        float cosine = ax * bx + ay * by + az * bz;
+        angles[i] = atan2_degrees_scalar(sine, cosine, fast);
+    }
+}
+
+#ifdef VECTORMATH_X86
+
+#include <immintrin.h>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define TARGET_SSE2
+#define TARGET_AVX2
+#else
+#define TARGET_SSE2 __attribute__((target("sse2")))
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+TARGET_SSE2 static __m128 atan2_degrees_sse2(__m128 y, __m128 x, int fast) {
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.0f);
+    __m128 abs_x = _mm_andnot_ps(_mm_set1_ps(-0.0f), x);
+    __m128 y_greater = _mm_cmpgt_ps(y, abs_x);
+    __m128 high = _mm_or_ps(_mm_and_ps(y_greater, y), _mm_andnot_ps(y_greater, abs_x));
+    __m128 low = _mm_or_ps(_mm_and_ps(y_greater, abs_x), _mm_andnot_ps(y_greater, y));
+    __m128 t = _mm_and_ps(_mm_cmpgt_ps(high, zero), _mm_div_ps(low, high));
+    __m128 angle;
+    if (fast) {
+        __m128 z = _mm_mul_ps(t, t);
+        __m128 p = _mm_set1_ps(ATAN_FAST_C9);
+        p = _mm_add_ps(_mm_mul_ps(p, z), _mm_set1_ps(ATAN_FAST_C7));
+        p = _mm_add_ps(_mm_mul_ps(p, z), _mm_set1_ps(ATAN_FAST_C5));
+        p = _mm_add_ps(_mm_mul_ps(p, z), _mm_set1_ps(ATAN_FAST_C3));
+        p = _mm_add_ps(_mm_mul_ps(p, z), _mm_set1_ps(ATAN_FAST_C1));
+        angle = _mm_mul_ps(p, t);
+    } else {
+        __m128 reduce = _mm_cmpgt_ps(t, _mm_set1_ps(TAN_PI_8));
+        __m128 reduced = _mm_div_ps(_mm_sub_ps(t, one), _mm_add_ps(t, one));
+        t = _mm_or_ps(_mm_and_ps(reduce, reduced), _mm_andnot_ps(reduce, t));
+        __m128 z = _mm_mul_ps(t, t);
+        __m128 p = _mm_set1_ps(ATAN_P0);
+        p = _mm_add_ps(_mm_mul_ps(p, z), _mm_set1_ps(ATAN_P1));
+        p = _mm_add_ps(_mm_mul_ps(p, z), _mm_set1_ps(ATAN_P2));
+        p = _mm_add_ps(_mm_mul_ps(p, z), _mm_set1_ps(ATAN_P3));
+        angle = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(p, z), t), t);
+        angle = _mm_or_ps(_mm_and_ps(reduce, _mm_add_ps(angle, _mm_set1_ps(PI_4_F))),
+            _mm_andnot_ps(reduce, angle));
+    }
+    angle = _mm_or_ps(_mm_and_ps(y_greater, _mm_sub_ps(_mm_set1_ps(PI_2_F), angle)),
+        _mm_andnot_ps(y_greater, angle));
+    __m128 negative = _mm_cmplt_ps(x, zero);
+    angle = _mm_or_ps(_mm_and_ps(negative, _mm_sub_ps(_mm_set1_ps(PI_F), angle)), _mm_andnot_ps(negative, angle));
+    return _mm_mul_ps(angle, _mm_set1_ps(DEGREES_PER_RADIAN_F));
+}
+
+TARGET_SSE2 static void normalize_batch_sse2(Point3Arrays* vectors, size_t begin, size_t end) {
+    const __m128 one = _mm_set1_ps(1.0f);
+    size_t i = begin;
+    for (; i + 4 <= end; i += 4) {
+        __m128 x = _mm_loadu_ps(vectors->x + i);
+        __m128 y = _mm_loadu_ps(vectors->y + i);
+        __m128 z = _mm_loadu_ps(vectors->z + i);
+        __m128 squared = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_mul_ps(z, z));
+        __m128 factor = _mm_div_ps(one, _mm_sqrt_ps(squared));
+        _mm_storeu_ps(vectors->x + i, _mm_mul_ps(x, factor));
+        _mm_storeu_ps(vectors->y + i, _mm_mul_ps(y, factor));
+        _mm_storeu_ps(vectors->z + i, _mm_mul_ps(z, factor));
+    }
+    normalize_batch_scalar(vectors, i, end);
+}
+
+TARGET_SSE2 static void angle_batch_sse2(float* angles, const Point3Arrays* first, const Point3Arrays* second,
+    size_t begin, size_t end, int fast) {
+    size_t i = begin;
+    for (; i + 4 <= end; i += 4) {
+        __m128 ax = _mm_loadu_ps(first->x + i), ay = _mm_loadu_ps(first->y + i), az = _mm_loadu_ps(first->z + i);
+        __m128 bx = _mm_loadu_ps(second->x + i), by = _mm_loadu_ps(second->y + i), bz = _mm_loadu_ps(second->z + i);
+        __m128 cx = _mm_sub_ps(_mm_mul_ps(ay, bz), _mm_mul_ps(az, by));
+        __m128 cy = _mm_sub_ps(_mm_mul_ps(az, bx), _mm_mul_ps(ax, bz));
+        __m128 cz = _mm_sub_ps(_mm_mul_ps(ax, by), _mm_mul_ps(ay, bx));
+        __m128 sine = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(cx, cx), _mm_mul_ps(cy, cy)), _mm_mul_ps(cz, cz)));
+        __m128 cosine = _mm_add_ps(_mm_add_ps(_mm_mul_ps(ax, bx), _mm_mul_ps(ay, by)), _mm_mul_ps(az, bz));
+        _mm_storeu_ps(angles + i, atan2_degrees_sse2(sine, cosine, fast));
+    }
+    angle_batch_scalar(angles, first, second, i, end, fast);
+}
+
+TARGET_AVX2 static __m256 atan2_degrees_avx2(__m256 y, __m256 x, int fast) {
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 one = _mm256_set1_ps(1.0f);
+    __m256 abs_x = _mm256_andnot_ps(_mm256_set1_ps(-0.0f), x);
+    __m256 y_greater = _mm256_cmp_ps(y, abs_x, _CMP_GT_OQ);
+    __m256 high = _mm256_blendv_ps(abs_x, y, y_greater);
+    __m256 low = _mm256_blendv_ps(y, abs_x, y_greater);
+    __m256 t = _mm256_and_ps(_mm256_cmp_ps(high, zero, _CMP_GT_OQ), _mm256_div_ps(low, high));
+    __m256 angle;
+    if (fast) {
+        __m256 z = _mm256_mul_ps(t, t);
+        __m256 p = _mm256_set1_ps(ATAN_FAST_C9);
+        p = _mm256_add_ps(_mm256_mul_ps(p, z), _mm256_set1_ps(ATAN_FAST_C7));
+        p = _mm256_add_ps(_mm256_mul_ps(p, z), _mm256_set1_ps(ATAN_FAST_C5));
+        p = _mm256_add_ps(_mm256_mul_ps(p, z), _mm256_set1_ps(ATAN_FAST_C3));
+        p = _mm256_add_ps(_mm256_mul_ps(p, z), _mm256_set1_ps(ATAN_FAST_C1));
+        angle = _mm256_mul_ps(p, t);
+    } else {
+        __m256 reduce = _mm256_cmp_ps(t, _mm256_set1_ps(TAN_PI_8), _CMP_GT_OQ);
+        __m256 reduced = _mm256_div_ps(_mm256_sub_ps(t, one), _mm256_add_ps(t, one));
+        t = _mm256_blendv_ps(t, reduced, reduce);
+        __m256 z = _mm256_mul_ps(t, t);
+        __m256 p = _mm256_set1_ps(ATAN_P0);
+        p = _mm256_add_ps(_mm256_mul_ps(p, z), _mm256_set1_ps(ATAN_P1));
+        p = _mm256_add_ps(_mm256_mul_ps(p, z), _mm256_set1_ps(ATAN_P2));
+        p = _mm256_add_ps(_mm256_mul_ps(p, z), _mm256_set1_ps(ATAN_P3));
+        angle = _mm256_add_ps(_mm256_mul_ps(_mm256_mul_ps(p, z), t), t);
+        angle = _mm256_blendv_ps(angle, _mm256_add_ps(angle, _mm256_set1_ps(PI_4_F)), reduce);
+    }
+    angle = _mm256_blendv_ps(angle, _mm256_sub_ps(_mm256_set1_ps(PI_2_F), angle), y_greater);
+    angle = _mm256_blendv_ps(angle, _mm256_sub_ps(_mm256_set1_ps(PI_F), angle), _mm256_cmp_ps(x, zero, _CMP_LT_OQ));
+    return _mm256_mul_ps(angle, _mm256_set1_ps(DEGREES_PER_RADIAN_F));
+}
+
+TARGET_AVX2 static void normalize_batch_avx2(Point3Arrays* vectors, size_t begin, size_t end) {
+    const __m256 one = _mm256_set1_ps(1.0f);
+    size_t i = begin;
+    for (; i + 8 <= end; i += 8) {
+        __m256 x = _mm256_loadu_ps(vectors->x + i);
+        __m256 y = _mm256_loadu_ps(vectors->y + i);
+        __m256 z = _mm256_loadu_ps(vectors->z + i);
+        __m256 squared = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(x, x), _mm256_mul_ps(y, y)), _mm256_mul_ps(z, z));
+        __m256 factor = _mm256_div_ps(one, _mm256_sqrt_ps(squared));
+        _mm256_storeu_ps(vectors->x + i, _mm256_mul_ps(x, factor));
+        _mm256_storeu_ps(vectors->y + i, _mm256_mul_ps(y, factor));
+        _mm256_storeu_ps(vectors->z + i, _mm256_mul_ps(z, factor));
+    }
+    normalize_batch_sse2(vectors, i, end);
+}
+
+TARGET_AVX2 static void angle_batch_avx2(float* angles, const Point3Arrays* first, const Point3Arrays* second,
+    size_t begin, size_t end, int fast) {
+    size_t i = begin;
+    for (; i + 8 <= end; i += 8) {
+        __m256 ax = _mm256_loadu_ps(first->x + i);
+        __m256 ay = _mm256_loadu_ps(first->y + i);
+        __m256 az = _mm256_loadu_ps(first->z + i);
+        __m256 bx = _mm256_loadu_ps(second->x + i);
+        __m256 by = _mm256_loadu_ps(second->y + i);
+        __m256 bz = _mm256_loadu_ps(second->z + i);
+        __m256 cx = _mm256_sub_ps(_mm256_mul_ps(ay, bz), _mm256_mul_ps(az, by));
+        __m256 cy = _mm256_sub_ps(_mm256_mul_ps(az, bx), _mm256_mul_ps(ax, bz));
+        __m256 cz = _mm256_sub_ps(_mm256_mul_ps(ax, by), _mm256_mul_ps(ay, bx));
+        __m256 sine = _mm256_sqrt_ps(
+            _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(cx, cx), _mm256_mul_ps(cy, cy)), _mm256_mul_ps(cz, cz)));
+        __m256 cosine = _mm256_add_ps(
+            _mm256_add_ps(_mm256_mul_ps(ax, bx), _mm256_mul_ps(ay, by)), _mm256_mul_ps(az, bz));
+        _mm256_storeu_ps(angles + i, atan2_degrees_avx2(sine, cosine, fast));
+    }
+    angle_batch_sse2(angles, first, second, i, end, fast);
+}
+
+static int cpu_supports_sse2(void) {
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 1);
+    return (info[3] & (1 << 26)) != 0;
+#else
+    return __builtin_cpu_supports("sse2");
+#endif
+}
+
+static int cpu_supports_avx2(void) {
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) {
+        return 0;
+    }
+    __cpuid(info, 1);
+    /* The OS must save the AVX registers (OSXSAVE and XCR0 bits 1 and 2). */
+    if (!(info[2] & (1 << 27)) || (_xgetbv(0) & 6) != 6) {
+        return 0;
+    }
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+#endif  /* VECTORMATH_X86 */
+
+static normalize_batch_function normalize_batch = NULL;
+static angle_batch_function angle_batch = NULL;
+static const char* batch_implementation = NULL;
+
+/* Selecting the same functions from several threads at once is harmless. */
+static void select_batch_functions(void) {
+    if (!vectormath_batch_use("avx2") && !vectormath_batch_use("sse2")) {
+        vectormath_batch_use("scalar");
+    }
+}
+
+int vectormath_batch_use(const char* implementation) {
+    if (strcmp(implementation, "scalar") == 0) {
+        normalize_batch = normalize_batch_scalar;
+        angle_batch = angle_batch_scalar;
+        batch_implementation = "scalar";
+        return 1;
+    }
+#ifdef VECTORMATH_X86
+    if (strcmp(implementation, "avx2") == 0 && cpu_supports_avx2()) {
+        normalize_batch = normalize_batch_avx2;
+        angle_batch = angle_batch_avx2;
+        batch_implementation = "avx2";
+        return 1;
+    }
+    if (strcmp(implementation, "sse2") == 0 && cpu_supports_sse2()) {
+        normalize_batch = normalize_batch_sse2;
+        angle_batch = angle_batch_sse2;
+        batch_implementation = "sse2";
+        return 1;
+    }
+#endif
+    return 0;
+}
+
+void vector3_normalize_batch(Point3Arrays* vectors, size_t count) {
+    if (!normalize_batch) {
+        select_batch_functions();
+    }
+    normalize_batch(vectors, 0, count);
+}
+
+void vector3_angle_batch(float* angles, const Point3Arrays* first, const Point3Arrays* second, size_t count) {
+    if (!angle_batch) {
+        select_batch_functions();
+    }
+    angle_batch(angles, first, second, 0, count, 0);
+}
+
+void vector3_angle_batch_with(Vector3AngleKernel kernel, float* angles, const Point3Arrays* first,
+    const Point3Arrays* second, size_t count) {
+    if (kernel == VECTOR3_ANGLE_KERNEL_ATAN2 || kernel == VECTOR3_ANGLE_KERNEL_FAST) {
+        if (!angle_batch) {
+            select_batch_functions();
+        }
+        angle_batch(angles, first, second, 0, count, kernel == VECTOR3_ANGLE_KERNEL_FAST);
+        return;
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        TobiiResearchVector3D first_vector;
+        TobiiResearchVector3D second_vector;
+        point3_arrays_get(&first_vector, first, i);
+        point3_arrays_get(&second_vector, second, i);
+        angles[i] = vector3_angle_with(kernel, &first_vector, &second_vector);
+    }
+}
+
+const char* vectormath_batch_implementation(void) {
+    if (!batch_implementation) {
+        select_batch_functions();
+    }
+    return batch_implementation;
+}
@@ -0,0 +1,205 @@
+/*
+Copyright 2019 Tobii Pro AB
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "worker_pool.h"
+
+#include <stdlib.h>
+
+#if defined(_WIN32) || defined(_WIN64)
+
+#include <windows.h>
+
+typedef HANDLE Thread;
+typedef CRITICAL_SECTION Mutex;
+typedef CONDITION_VARIABLE Condition;
+
+#define mutex_init(mutex) InitializeCriticalSection(mutex)
+#define mutex_destroy(mutex) DeleteCriticalSection(mutex)
+#define mutex_lock(mutex) EnterCriticalSection(mutex)
+#define mutex_unlock(mutex) LeaveCriticalSection(mutex)
+#define condition_init(condition) InitializeConditionVariable(condition)
+#define condition_destroy(condition)
+#define condition_wait(condition, mutex) SleepConditionVariableCS(condition, mutex, INFINITE)
+#define condition_broadcast(condition) WakeAllConditionVariable(condition)
+
+#else
+
+#include <pthread.h>
+#include <unistd.h>
+
+typedef pthread_t Thread;
+typedef pthread_mutex_t Mutex;
+typedef pthread_cond_t Condition;
+
+#define mutex_init(mutex) pthread_mutex_init(mutex, NULL)
+#define mutex_destroy(mutex) pthread_mutex_destroy(mutex)
+#define mutex_lock(mutex) pthread_mutex_lock(mutex)
+#define mutex_unlock(mutex) pthread_mutex_unlock(mutex)
+#define condition_init(condition) pthread_cond_init(condition, NULL)
+#define condition_destroy(condition) pthread_cond_destroy(condition)
+#define condition_wait(condition, mutex) pthread_cond_wait(condition, mutex)
+#define condition_broadcast(condition) pthread_cond_broadcast(condition)
+
+#endif
+
+struct WorkerPool {
+    Thread* threads;
+    size_t worker_count;
+
+    Mutex mutex;
+    /* Signaled when a batch is started or the pool is destroyed. */
+    Condition work_condition;
+    /* Signaled when the last job of a batch has returned. */
+    Condition done_condition;
+
+    /* The current batch. Indices are handed out in order, one at a time. */
+    WorkerPoolJob job;
+    void* context;
+    size_t count;
+    size_t next_index;
+    size_t remaining_count;
+    int stopping;
+};
+
+static void run_worker(WorkerPool* instance) {
+    mutex_lock(&instance->mutex);
+    for (;;) {
+        while (!instance->stopping && instance->next_index >= instance->count) {
+            condition_wait(&instance->work_condition, &instance->mutex);
+        }
+        if (instance->stopping) {
+            break;
+        }
+
+        size_t index = instance->next_index++;
+        WorkerPoolJob job = instance->job;
+        void* context = instance->context;
+        mutex_unlock(&instance->mutex);
+        job(context, index);
+        mutex_lock(&instance->mutex);
+
+        if (--instance->remaining_count == 0) {
+            condition_broadcast(&instance->done_condition);
+        }
+    }
+    mutex_unlock(&instance->mutex);
+}
+
+#if defined(_WIN32) || defined(_WIN64)
+
+static DWORD WINAPI worker_thread(LPVOID argument) {
+    run_worker((WorkerPool*)argument);
+    return 0;
+}
+
+static void start_thread(Thread* thread, WorkerPool* instance) {
+    *thread = CreateThread(NULL, 0, worker_thread, instance, 0, NULL);
+}
+
+static void join_thread(Thread thread) {
+    WaitForSingleObject(thread, INFINITE);
+    CloseHandle(thread);
+}
+
+size_t worker_pool_processor_count() {
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors > 0 ? info.dwNumberOfProcessors : 1;
+}
+
+#else
+
+static void* worker_thread(void* argument) {
+    run_worker((WorkerPool*)argument);
+    return NULL;
+}
+
+static void start_thread(Thread* thread, WorkerPool* instance) {
+    pthread_create(thread, NULL, worker_thread, instance);
+}
+
+static void join_thread(Thread thread) {
+    pthread_join(thread, NULL);
+}
+
+size_t worker_pool_processor_count() {
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? (size_t)count : 1;
+}
+
+#endif
+
+WorkerPool* worker_pool_init(size_t worker_count) {
+    WorkerPool* instance = malloc(sizeof(*instance));
+    instance->worker_count = worker_count;
+    mutex_init(&instance->mutex);
+    condition_init(&instance->work_condition);
+    condition_init(&instance->done_condition);
+    instance->job = NULL;
+    instance->context = NULL;
+    instance->count = 0;
+    instance->next_index = 0;
+    instance->remaining_count = 0;
+    instance->stopping = 0;
+
+    instance->threads = malloc(worker_count * sizeof(*instance->threads));
+    for (size_t i = 0; i < worker_count; ++i) {
+        start_thread(&instance->threads[i], instance);
+    }
+    return instance;
+}
+
+void worker_pool_destroy(WorkerPool* instance) {
+    if (instance) {
+        mutex_lock(&instance->mutex);
+        instance->stopping = 1;
+        condition_broadcast(&instance->work_condition);
+        mutex_unlock(&instance->mutex);
+
+        for (size_t i = 0; i < instance->worker_count; ++i) {
+            join_thread(instance->threads[i]);
+        }
+        free(instance->threads);
+        condition_destroy(&instance->done_condition);
+        condition_destroy(&instance->work_condition);
+        mutex_destroy(&instance->mutex);
+        free(instance);
+    }
+}
+
+size_t worker_pool_worker_count(const WorkerPool* instance) {
+    return instance->worker_count;
+}
+
+void worker_pool_run(WorkerPool* instance, WorkerPoolJob job, void* context, size_t count) {
+    if (count == 0) {
+        return;
+    }
+
+    mutex_lock(&instance->mutex);
+    instance->job = job;
+    instance->context = context;
+    instance->count = count;
+    instance->next_index = 0;
+    instance->remaining_count = count;
+    condition_broadcast(&instance->work_condition);
+    while (instance->remaining_count > 0) {
+        condition_wait(&instance->done_condition, &instance->mutex);
+    }
+    instance->count = 0;
+    instance->next_index = 0;
+    mutex_unlock(&instance->mutex);
+}
@@ -0,0 +1,47 @@
+/*
+Copyright 2019 Tobii Pro AB
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef WORKER_POOL_H_
+#define WORKER_POOL_H_
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Fixed set of worker threads running batches of jobs. A batch calls the job once for every index, spread over
+ * the workers, and is run by one thread at a time. */
+
+typedef struct WorkerPool WorkerPool;
+
+typedef void (*WorkerPoolJob)(void* context, size_t index);
+
+extern WorkerPool* worker_pool_init(size_t worker_count);
+extern void worker_pool_destroy(WorkerPool* instance);
+extern size_t worker_pool_worker_count(const WorkerPool* instance);
+
+/* Calls job(context, index) for every index below count and returns when all calls have returned. */
+extern void worker_pool_run(WorkerPool* instance, WorkerPoolJob job, void* context, size_t count);
+
+/* Number of processors available to the process, at least one. */
+extern size_t worker_pool_processor_count();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* WORKER_POOL_H_ */